@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include <unistd.h>
+
+#include "benchmark.hpp"
+
+namespace zmqpp
+{
+namespace bench
+{
+
+std::string endpoint(std::string const& transport, std::string const& name, uint16_t const& port)
+{
+	std::stringstream stream;
+
+	if ("inproc" == transport)
+	{
+		stream << "inproc://zmqpp-bench-" << name;
+	}
+	else if ("ipc" == transport)
+	{
+		stream << "ipc:///tmp/zmqpp-bench-" << getpid() << "-" << name;
+	}
+	else if ("tcp" == transport)
+	{
+		stream << "tcp://127.0.0.1:" << port;
+	}
+	else
+	{
+		throw zmqpp::exception("unknown benchmark transport " + transport);
+	}
+
+	return stream.str();
+}
+
+size_t part_size(parameters const& params)
+{
+	return std::max(params.message_size, sizeof(uint64_t));
+}
+
+void fill(zmqpp::message& message, parameters const& params, std::vector<char> const& payload)
+{
+	size_t size = part_size(params);
+	for(size_t i = 0; i < params.parts; ++i)
+	{
+		message.add(payload.data(), size);
+	}
+
+	uint64_t timestamp = now();
+	memcpy(message.raw_data(0), &timestamp, sizeof(uint64_t));
+}
+
+uint64_t sent_at(zmqpp::message& message)
+{
+	uint64_t timestamp = 0;
+	memcpy(&timestamp, message.raw_data(0), sizeof(uint64_t));
+	return timestamp;
+}
+
+uint64_t percentile(std::vector<uint64_t>& samples, double const& percentile)
+{
+	if (samples.empty())
+	{
+		return 0;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	size_t rank = static_cast<size_t>((percentile / 100.0) * (samples.size() - 1) + 0.5);
+	return samples[std::min(rank, samples.size() - 1)];
+}
+
+void write_json(std::ostream& stream, std::vector<result>& results)
+{
+	uint8_t major, minor, revision;
+	zmqpp::zmq_version(major, minor, revision);
+
+	stream << "{" << std::endl;
+	stream << "  \"zmqpp_version\": \"" << zmqpp::version() << "\"," << std::endl;
+	stream << "  \"zmq_version\": \"" << static_cast<int>(major) << "." << static_cast<int>(minor) << "." << static_cast<int>(revision) << "\"," << std::endl;
+	stream << "  \"results\": [";
+
+	for(size_t i = 0; i < results.size(); ++i)
+	{
+		result& run = results[i];
+		double bytes = static_cast<double>(run.messages) * part_size(run.params) * run.params.parts;
+		double rate = (run.seconds > 0) ? run.messages / run.seconds : 0;
+		double megabytes = (run.seconds > 0) ? (bytes / run.seconds) / (1024 * 1024) : 0;
+
+		stream << ((i > 0) ? "," : "") << std::endl;
+		stream << "    {" << std::endl;
+		stream << "      \"pattern\": \"" << run.params.pattern << "\"," << std::endl;
+		stream << "      \"transport\": \"" << run.params.transport << "\"," << std::endl;
+		stream << "      \"message_size\": " << part_size(run.params) << "," << std::endl;
+		stream << "      \"parts\": " << run.params.parts << "," << std::endl;
+		stream << "      \"messages\": " << run.messages << "," << std::endl;
+		stream << "      \"seconds\": " << run.seconds << "," << std::endl;
+		stream << "      \"messages_per_second\": " << rate << "," << std::endl;
+		stream << "      \"megabytes_per_second\": " << megabytes << "," << std::endl;
+
+		for(auto it = run.extra.begin(); it != run.extra.end(); ++it)
+		{
+			stream << "      \"" << (*it).first << "\": " << (*it).second << "," << std::endl;
+		}
+
+		stream << "      \"latency_ns\": {";
+		stream << " \"p50\": " << percentile(run.latencies, 50);
+		stream << ", \"p90\": " << percentile(run.latencies, 90);
+		stream << ", \"p99\": " << percentile(run.latencies, 99);
+		stream << ", \"p99.9\": " << percentile(run.latencies, 99.9);
+		stream << ", \"max\": " << percentile(run.latencies, 100);
+		stream << " }" << std::endl;
+		stream << "    }";
+	}
+
+	stream << std::endl << "  ]" << std::endl;
+	stream << "}" << std::endl;
+}
+
+}
+}
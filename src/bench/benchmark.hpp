@@ -0,0 +1,182 @@
+/**
+ * \file
+ *
+ * Shared pieces of the zmqpp-bench harness.
+ *
+ * Each benchmark case runs a single pattern over a single transport with a
+ * fixed message shape and fills in a result. The harness takes care of
+ * timing, latency percentiles and writing the results out as JSON.
+ */
+
+#ifndef ZMQPP_BENCH_BENCHMARK_HPP_
+#define ZMQPP_BENCH_BENCHMARK_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <zmqpp/zmqpp.hpp>
+
+namespace zmqpp
+{
+namespace bench
+{
+
+typedef std::chrono::steady_clock clock_type;
+
+/*!
+ * Description of a single benchmark run.
+ */
+struct parameters
+{
+	std::string pattern;   /*!< name of the benchmark pattern, ie push_pull */
+	std::string transport; /*!< one of inproc, ipc or tcp */
+	size_t message_size;   /*!< bytes per message part */
+	size_t parts;          /*!< parts per message */
+	uint64_t messages;     /*!< messages (or round trips) to time */
+	uint16_t port;         /*!< port used for the tcp transport, unique per run */
+	size_t workers;        /*!< workers behind a broker, zero for patterns without one */
+};
+
+/*!
+ * Outcome of a single benchmark run.
+ */
+struct result
+{
+	parameters params;
+	uint64_t messages;                  /*!< messages actually received */
+	double seconds;                     /*!< wall clock time of the timed section */
+	std::vector<uint64_t> latencies;    /*!< per message latency samples in nanoseconds */
+	std::map<std::string, double> extra; /*!< any pattern specific figures worth reporting */
+};
+
+/*!
+ * Signature all benchmark patterns implement.
+ *
+ * The context is shared between runs so inproc endpoints are usable.
+ */
+typedef std::function<void (zmqpp::context&, parameters const&, result&)> benchmark_function;
+
+/*!
+ * Current time in nanoseconds on the monotonic clock.
+ *
+ * Only meaningful when compared against another value from the same host.
+ */
+inline uint64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+}
+
+/*!
+ * Build the endpoint string for a transport.
+ *
+ * \param transport one of inproc, ipc or tcp.
+ * \param name unique name for the run, used for inproc and ipc.
+ * \param port port to use for tcp.
+ * \return endpoint string usable for both bind and connect.
+ */
+std::string endpoint(std::string const& transport, std::string const& name, uint16_t const& port);
+
+/*!
+ * Fill a message with the requested shape.
+ *
+ * The first 8 bytes of the first part hold the send time so the receiver can
+ * calculate the one way latency, parts are padded to this size if needed.
+ *
+ * \param message empty message to fill.
+ * \param params the size and number of parts to use.
+ * \param payload scratch buffer of at least the padded part size.
+ */
+void fill(zmqpp::message& message, parameters const& params, std::vector<char> const& payload);
+
+/*!
+ * Size in bytes of each part once padded to fit the send time.
+ *
+ * \param params the run parameters.
+ * \return padded part size.
+ */
+size_t part_size(parameters const& params);
+
+/*!
+ * Read back the send time written by fill.
+ *
+ * \param message message built by fill.
+ * \return send time in nanoseconds.
+ */
+uint64_t sent_at(zmqpp::message& message);
+
+/*!
+ * Get the value at a given percentile of the samples.
+ *
+ * The samples are sorted in place.
+ *
+ * \param samples latency samples.
+ * \param percentile value between 0 and 100.
+ * \return the sample value, or zero if there are no samples.
+ */
+uint64_t percentile(std::vector<uint64_t>& samples, double const& percentile);
+
+/*!
+ * Write all the results as a single JSON document.
+ *
+ * \param stream output stream to write to.
+ * \param results completed benchmark results.
+ */
+void write_json(std::ostream& stream, std::vector<result>& results);
+
+/*!
+ * Stream messages from a push socket to a pull socket.
+ */
+void push_pull(zmqpp::context& context, parameters const& params, result& outcome);
+
+/*!
+ * Stream messages between a pair of pair sockets.
+ */
+void pair(zmqpp::context& context, parameters const& params, result& outcome);
+
+/*!
+ * Stream messages from a publisher to a single subscriber.
+ *
+ * Messages dropped by the publisher are reported as the extra dropped value.
+ */
+void pub_sub(zmqpp::context& context, parameters const& params, result& outcome);
+
+/*!
+ * Lock step round trips between a request and a reply socket.
+ *
+ * The latencies reported are for the full round trip.
+ */
+void req_rep(zmqpp::context& context, parameters const& params, result& outcome);
+
+/*!
+ * Pipelined requests from a zmqpp::rpc_client to the same reply socket
+ * server as req_rep.
+ *
+ * The latencies reported are for the full round trip, including time spent
+ * queued at the server behind the rest of the window.
+ */
+void pipelined_rpc(zmqpp::context& context, parameters const& params, result& outcome);
+
+/*!
+ * Stream messages through a zmqpp::channel rather than a socket.
+ *
+ * Only run for the inproc transport, to compare against the pair pattern.
+ */
+void in_process_channel(zmqpp::context& context, parameters const& params, result& outcome);
+
+/*!
+ * Pipelined requests from a dealer through a zmqpp::broker to echo workers.
+ *
+ * The client reaches the broker over the transport being tested, the
+ * workers are always connected over inproc. Latencies are round trips.
+ */
+void brokered(zmqpp::context& context, parameters const& params, result& outcome);
+
+}
+}
+
+#endif /* ZMQPP_BENCH_BENCHMARK_HPP_ */
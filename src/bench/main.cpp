@@ -0,0 +1,226 @@
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include <defines.hpp>
+
+#include "benchmark.hpp"
+
+#ifndef BUILD_BENCH_NAME
+#define BUILD_BENCH_NAME "zmqpp-bench"
+#endif
+
+boost::program_options::options_description sweep_options()
+{
+	boost::program_options::options_description options("Sweep Options");
+	options.add_options()
+		("pattern,p", boost::program_options::value<std::vector<std::string>>()->multitoken(), "patterns to run, defaults to all")
+		("transport,t", boost::program_options::value<std::vector<std::string>>()->multitoken(), "transports to use, defaults to inproc ipc tcp")
+		("size,s", boost::program_options::value<std::vector<size_t>>()->multitoken(), "message part sizes in bytes, defaults to 16 256 4096 65536")
+		("parts,m", boost::program_options::value<std::vector<size_t>>()->multitoken(), "parts per message, defaults to 1 4")
+		("workers,w", boost::program_options::value<std::vector<size_t>>()->multitoken(), "workers behind the broker pattern, defaults to 1 4 16 64")
+		("messages,n", boost::program_options::value<uint64_t>()->default_value(10000), "messages or round trips per run")
+		("port", boost::program_options::value<uint16_t>()->default_value(5555), "first port to use for the tcp transport, each run uses the next one")
+		;
+
+	return options;
+}
+
+boost::program_options::options_description miscellaneous_options()
+{
+	boost::program_options::options_description options("Miscellaneous Options");
+	options.add_options()
+		("output,o", boost::program_options::value<std::string>(), "write the JSON results to a file rather than standard out")
+		("version", "display version")
+		("help", "show this help page")
+		;
+
+	return options;
+}
+
+template<typename Type>
+std::vector<Type> option_or(boost::program_options::variables_map& vm, std::string const& name, std::vector<Type> const& fallback)
+{
+	if (vm.count(name))
+	{
+		return vm[name].as<std::vector<Type>>();
+	}
+
+	return fallback;
+}
+
+int main(int argc, char const* argv[])
+{
+	std::map<std::string, zmqpp::bench::benchmark_function> benchmarks;
+	benchmarks["push_pull"] = &zmqpp::bench::push_pull;
+	benchmarks["pair"] = &zmqpp::bench::pair;
+	benchmarks["pub_sub"] = &zmqpp::bench::pub_sub;
+	benchmarks["req_rep"] = &zmqpp::bench::req_rep;
+	benchmarks["rpc"] = &zmqpp::bench::pipelined_rpc;
+	benchmarks["channel"] = &zmqpp::bench::in_process_channel;
+	benchmarks["broker"] = &zmqpp::bench::brokered;
+
+	// patterns that do not use sockets, only compared against inproc
+	std::set<std::string> socketless { "channel" };
+
+	// patterns that are also swept over the number of workers
+	std::set<std::string> brokered { "broker" };
+
+	boost::program_options::options_description all;
+	all.add(sweep_options());
+	all.add(miscellaneous_options());
+
+	boost::program_options::variables_map vm;
+	bool usage = false;
+
+	try {
+		boost::program_options::store(boost::program_options::command_line_parser(argc, argv).options(all).run(), vm);
+		boost::program_options::notify(vm);
+	}
+	catch(boost::program_options::error& e)
+	{
+		std::cerr << e.what() << std::endl;
+		usage = true;
+	}
+
+	if (vm.count("version"))
+	{
+		std::cout << BUILD_BENCH_NAME << " version " << BUILD_VERSION << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	std::vector<std::string> all_patterns;
+	for(auto it = benchmarks.begin(); it != benchmarks.end(); ++it)
+	{
+		all_patterns.push_back((*it).first);
+	}
+
+	std::vector<std::string> patterns = option_or(vm, "pattern", all_patterns);
+	for(size_t i = 0; i < patterns.size(); ++i)
+	{
+		if (benchmarks.end() == benchmarks.find(patterns[i]))
+		{
+			std::cerr << "Unknown pattern '" << patterns[i] << "'." << std::endl;
+			usage = true;
+		}
+	}
+
+	if (usage || vm.count("help"))
+	{
+		std::cout << "Usage: " BUILD_BENCH_NAME " [options]" << std::endl;
+		std::cout << "0mq throughput and latency benchmarks for zmqpp." << std::endl;
+		std::cout << "Runs every combination of the sweep options and writes the results as JSON." << std::endl;
+
+		auto it = all_patterns.begin();
+		std::cout << "PATTERN is one of " << *it;
+		for(++it; it != all_patterns.end(); ++it)
+		{
+			std::cout << ", " << *it;
+		}
+		std::cout << std::endl << std::endl;
+
+		std::cout << sweep_options() << std::endl;
+		std::cout << miscellaneous_options() << std::endl;
+		return (usage) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	std::vector<std::string> transports = option_or(vm, "transport", std::vector<std::string>{ "inproc", "ipc", "tcp" });
+	std::vector<size_t> sizes = option_or(vm, "size", std::vector<size_t>{ 16, 256, 4096, 65536 });
+	std::vector<size_t> parts = option_or(vm, "parts", std::vector<size_t>{ 1, 4 });
+	std::vector<size_t> workers = option_or(vm, "workers", std::vector<size_t>{ 1, 4, 16, 64 });
+
+	// Every run gets the next port so the whole sweep has to fit below 65536
+	size_t runs = 0;
+	for(size_t p = 0; p < patterns.size(); ++p)
+	{
+		for(size_t t = 0; t < transports.size(); ++t)
+		{
+			if ((socketless.count(patterns[p]) > 0) && ("inproc" != transports[t]))
+			{
+				continue;
+			}
+
+			runs += sizes.size() * parts.size() * ((brokered.count(patterns[p]) > 0) ? workers.size() : 1);
+		}
+	}
+
+	uint16_t first_port = vm["port"].as<uint16_t>();
+	if ((runs > 0) && (static_cast<size_t>(first_port) + runs - 1 > std::numeric_limits<uint16_t>::max()))
+	{
+		std::cerr << "The sweep needs " << runs << " ports, too many to start from port " << first_port << "." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	zmqpp::context context;
+	std::vector<zmqpp::bench::result> results;
+
+	for(size_t p = 0; p < patterns.size(); ++p)
+	{
+		for(size_t t = 0; t < transports.size(); ++t)
+		{
+			if ((socketless.count(patterns[p]) > 0) && ("inproc" != transports[t]))
+			{
+				continue;
+			}
+
+			for(size_t s = 0; s < sizes.size(); ++s)
+			{
+				for(size_t m = 0; m < parts.size(); ++m)
+				{
+					std::vector<size_t> counts = (brokered.count(patterns[p]) > 0) ? workers : std::vector<size_t>{ 0 };
+					for(size_t w = 0; w < counts.size(); ++w)
+					{
+						zmqpp::bench::result outcome;
+						outcome.params.pattern = patterns[p];
+						outcome.params.transport = transports[t];
+						outcome.params.message_size = sizes[s];
+						outcome.params.parts = parts[m];
+						outcome.params.messages = vm["messages"].as<uint64_t>();
+						outcome.params.port = static_cast<uint16_t>(first_port + results.size());
+						outcome.params.workers = counts[w];
+
+						std::cerr << outcome.params.pattern << " over " << outcome.params.transport << ", "
+								<< outcome.params.parts << " x " << outcome.params.message_size << " bytes";
+						if (outcome.params.workers > 0)
+						{
+							std::cerr << ", " << outcome.params.workers << " workers";
+						}
+						std::cerr << std::endl;
+
+						try
+						{
+							benchmarks[patterns[p]](context, outcome.params, outcome);
+						}
+						catch(zmqpp::exception& e)
+						{
+							std::cerr << "!!: " << e.what() << std::endl;
+							return EXIT_FAILURE;
+						}
+
+						results.push_back(std::move(outcome));
+					}
+				}
+			}
+		}
+	}
+
+	if (vm.count("output"))
+	{
+		std::ofstream file(vm["output"].as<std::string>());
+		zmqpp::bench::write_json(file, results);
+	}
+	else
+	{
+		zmqpp::bench::write_json(std::cout, results);
+	}
+
+	return EXIT_SUCCESS;
+}
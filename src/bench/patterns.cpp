@@ -0,0 +1,372 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "benchmark.hpp"
+
+namespace zmqpp
+{
+namespace bench
+{
+
+namespace
+{
+
+// How long the receiving side waits for a message before deciding the rest were dropped
+const long idle_timeout = 1000;
+
+// Requests a pipelining client keeps in flight
+const uint64_t request_window = 256;
+
+std::string unique_name(parameters const& params)
+{
+	static int runs = 0;
+	return params.pattern + "-" + std::to_string(++runs);
+}
+
+/*
+ * One way stream of messages from sender to receiver.
+ *
+ * The sender repeats empty sync messages until the receiver has seen one, this
+ * stops connection setup (and the pub/sub slow joiner) being timed.
+ */
+void stream(zmqpp::socket_type const& sender_type, zmqpp::socket_type const& receiver_type,
+		zmqpp::context& context, parameters const& params, result& outcome)
+{
+	std::string endpoint = bench::endpoint(params.transport, unique_name(params), params.port);
+
+	zmqpp::socket receiver(context, receiver_type);
+	receiver.set(zmqpp::socket_option::linger, 0);
+	if (zmqpp::socket_type::subscribe == receiver_type)
+	{
+		receiver.subscribe("");
+	}
+	receiver.bind(endpoint);
+
+	zmqpp::socket sender(context, sender_type);
+	sender.set(zmqpp::socket_option::linger, 0);
+	sender.connect(endpoint);
+
+	std::atomic<bool> ready(false);
+	std::thread thread([&sender, &ready, &params]() {
+		while(!ready)
+		{
+			sender.send(std::string(), zmqpp::socket::DONT_WAIT);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		std::vector<char> payload(part_size(params), 'x');
+		for(uint64_t i = 0; i < params.messages; ++i)
+		{
+			zmqpp::message message;
+			fill(message, params, payload);
+			sender.send(message);
+		}
+	});
+
+	zmqpp::poller poller;
+	poller.add(receiver);
+
+	{
+		zmqpp::message sync;
+		receiver.receive(sync);
+		ready = true;
+	}
+
+	outcome.latencies.reserve(params.messages);
+	clock_type::time_point start = clock_type::now();
+	clock_type::time_point last = start;
+
+	uint64_t received = 0;
+	while((received < params.messages) && poller.poll(idle_timeout))
+	{
+		zmqpp::message message;
+		receiver.receive(message);
+
+		// late sync messages
+		if (0 == message.size(0))
+		{
+			continue;
+		}
+
+		last = clock_type::now();
+		outcome.latencies.push_back(now() - sent_at(message));
+		++received;
+	}
+
+	thread.join();
+
+	outcome.messages = received;
+	outcome.seconds = std::chrono::duration<double>(last - start).count();
+	outcome.extra["dropped"] = static_cast<double>(params.messages - received);
+}
+
+}
+
+void push_pull(zmqpp::context& context, parameters const& params, result& outcome)
+{
+	stream(zmqpp::socket_type::push, zmqpp::socket_type::pull, context, params, outcome);
+}
+
+void pair(zmqpp::context& context, parameters const& params, result& outcome)
+{
+	stream(zmqpp::socket_type::pair, zmqpp::socket_type::pair, context, params, outcome);
+}
+
+void pub_sub(zmqpp::context& context, parameters const& params, result& outcome)
+{
+	stream(zmqpp::socket_type::publish, zmqpp::socket_type::subscribe, context, params, outcome);
+}
+
+void req_rep(zmqpp::context& context, parameters const& params, result& outcome)
+{
+	std::string endpoint = bench::endpoint(params.transport, unique_name(params), params.port);
+
+	zmqpp::socket replier(context, zmqpp::socket_type::reply);
+	replier.set(zmqpp::socket_option::linger, 0);
+	replier.bind(endpoint);
+
+	zmqpp::socket requester(context, zmqpp::socket_type::request);
+	requester.set(zmqpp::socket_option::linger, 0);
+	requester.connect(endpoint);
+
+	std::thread thread([&replier, &params]() {
+		for(uint64_t i = 0; i < params.messages; ++i)
+		{
+			zmqpp::message message;
+			replier.receive(message);
+			replier.send(message);
+		}
+	});
+
+	std::vector<char> payload(part_size(params), 'x');
+	outcome.latencies.reserve(params.messages);
+	clock_type::time_point start = clock_type::now();
+
+	for(uint64_t i = 0; i < params.messages; ++i)
+	{
+		zmqpp::message request;
+		fill(request, params, payload);
+		requester.send(request);
+
+		zmqpp::message reply;
+		requester.receive(reply);
+		outcome.latencies.push_back(now() - sent_at(reply));
+	}
+
+	outcome.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+	outcome.messages = params.messages;
+
+	thread.join();
+}
+
+void pipelined_rpc(zmqpp::context& context, parameters const& params, result& outcome)
+{
+	std::string endpoint = bench::endpoint(params.transport, unique_name(params), params.port);
+
+	zmqpp::socket replier(context, zmqpp::socket_type::reply);
+	replier.set(zmqpp::socket_option::linger, 0);
+	replier.bind(endpoint);
+
+	zmqpp::socket dealer(context, zmqpp::socket_type::dealer);
+	dealer.set(zmqpp::socket_option::linger, 0);
+	dealer.connect(endpoint);
+
+	// the same lock step echo server as req_rep, only the client differs
+	std::thread thread([&replier, &params]() {
+		for(uint64_t i = 0; i < params.messages; ++i)
+		{
+			zmqpp::message message;
+			replier.receive(message);
+			replier.send(message);
+		}
+	});
+
+	zmqpp::rpc_client client(dealer, request_window, std::chrono::milliseconds(idle_timeout));
+
+	uint64_t received = 0;
+	zmqpp::rpc_client::callback record = [&outcome, &received](zmqpp::rpc_client::status const& status, zmqpp::message& reply) {
+		if (zmqpp::rpc_client::status::replied == status)
+		{
+			outcome.latencies.push_back(now() - sent_at(reply));
+			++received;
+		}
+	};
+
+	std::vector<char> payload(part_size(params), 'x');
+	outcome.latencies.reserve(params.messages);
+	clock_type::time_point start = clock_type::now();
+
+	// timed out requests still finish so this ends even if replies are lost
+	uint64_t sent = 0;
+	uint64_t finished = 0;
+	while(finished < params.messages)
+	{
+		while((sent < params.messages) && (client.in_flight() < request_window))
+		{
+			zmqpp::message request;
+			fill(request, params, payload);
+			client.call(request, record);
+			++sent;
+		}
+
+		finished += client.poll(idle_timeout);
+	}
+
+	outcome.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+	outcome.messages = received;
+
+	thread.join();
+
+	outcome.extra["window"] = static_cast<double>(request_window);
+	outcome.extra["timeouts"] = static_cast<double>(client.stats().timeouts);
+}
+
+void in_process_channel(zmqpp::context&, parameters const& params, result& outcome)
+{
+	zmqpp::channel pipe;
+
+	std::thread thread([&pipe, &params]() {
+		std::vector<char> payload(part_size(params), 'x');
+		for(uint64_t i = 0; i < params.messages; ++i)
+		{
+			zmqpp::message message;
+			fill(message, params, payload);
+			pipe.send(message);
+		}
+	});
+
+	outcome.latencies.reserve(params.messages);
+	clock_type::time_point start = clock_type::now();
+
+	for(uint64_t i = 0; i < params.messages; ++i)
+	{
+		zmqpp::message message;
+		pipe.receive(message);
+		outcome.latencies.push_back(now() - sent_at(message));
+	}
+
+	outcome.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+	outcome.messages = params.messages;
+
+	thread.join();
+}
+
+void brokered(zmqpp::context& context, parameters const& params, result& outcome)
+{
+	std::string name = unique_name(params);
+
+	zmqpp::socket frontend(context, zmqpp::socket_type::router);
+	frontend.set(zmqpp::socket_option::linger, 0);
+	frontend.bind(bench::endpoint(params.transport, name, params.port));
+
+	zmqpp::socket backend(context, zmqpp::socket_type::router);
+	backend.set(zmqpp::socket_option::linger, 0);
+	backend.bind("inproc://" + name + "-workers");
+
+	zmqpp::broker broker(frontend, backend);
+	std::thread broker_thread(&zmqpp::broker::run, &broker);
+
+	std::atomic<bool> done(false);
+	std::vector<std::thread> workers;
+	for(size_t i = 0; i < params.workers; ++i)
+	{
+		workers.push_back(std::thread([&context, &done, &name]() {
+			zmqpp::socket worker(context, zmqpp::socket_type::dealer);
+			worker.set(zmqpp::socket_option::linger, 0);
+			worker.connect("inproc://" + name + "-workers");
+			worker.send(zmqpp::broker::ready_signal);
+
+			zmqpp::poller poller;
+			poller.add(worker);
+
+			while(!done)
+			{
+				if (!poller.poll(10))
+				{
+					continue;
+				}
+
+				zmqpp::message message;
+				while(worker.receive(message, true))
+				{
+					// a single part can only be a heartbeat from the broker
+					if (1 == message.parts())
+					{
+						worker.send(zmqpp::broker::heartbeat_signal);
+					}
+					else
+					{
+						worker.send(message);
+					}
+
+					message = zmqpp::message();
+				}
+			}
+		}));
+	}
+
+	zmqpp::socket client(context, zmqpp::socket_type::dealer);
+	client.set(zmqpp::socket_option::linger, 0);
+	client.connect(bench::endpoint(params.transport, name, params.port));
+
+	zmqpp::poller poller;
+	poller.add(client);
+
+	std::vector<char> payload(part_size(params), 'x');
+
+	// one untimed round trip so connection setup is not measured
+	{
+		zmqpp::message sync;
+		fill(sync, params, payload);
+		client.send(sync);
+		client.receive(sync);
+	}
+
+	outcome.latencies.reserve(params.messages);
+	clock_type::time_point start = clock_type::now();
+
+	uint64_t sent = 0;
+	uint64_t received = 0;
+	while(received < params.messages)
+	{
+		while((sent < params.messages) && (sent - received < request_window))
+		{
+			zmqpp::message request;
+			fill(request, params, payload);
+			client.send(request);
+			++sent;
+		}
+
+		if (!poller.poll(idle_timeout))
+		{
+			break;
+		}
+
+		zmqpp::message reply;
+		while(client.receive(reply, true))
+		{
+			outcome.latencies.push_back(now() - sent_at(reply));
+			++received;
+			reply = zmqpp::message();
+		}
+	}
+
+	outcome.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+	outcome.messages = received;
+
+	done = true;
+	for(size_t i = 0; i < workers.size(); ++i)
+	{
+		workers[i].join();
+	}
+
+	broker.stop();
+	broker_thread.join();
+
+	outcome.extra["workers"] = static_cast<double>(params.workers);
+	outcome.extra["backlogged"] = static_cast<double>(broker.stats().backlogged);
+}
+
+}
+}
@@ -0,0 +1,225 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "benchmark.hpp"
+#include "histogram.hpp"
+
+namespace
+{
+
+typedef std::chrono::steady_clock clock_type;
+
+// How often the clock is checked when running for a duration
+const uint64_t clock_check_interval = 1024;
+
+// How long a receiver waits for more messages before giving up
+const long idle_timeout = 1000;
+
+double cpu_seconds()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+			+ (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double seconds_since(clock_type::time_point const& start)
+{
+	return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+bool running(uint64_t const& messages, clock_type::time_point const& start, benchmark_settings const& settings)
+{
+	if (settings.duration > 0)
+	{
+		return (0 != messages % clock_check_interval) || (seconds_since(start) < settings.duration);
+	}
+
+	return messages < settings.messages;
+}
+
+size_t message_bytes(zmqpp::message& message)
+{
+	size_t bytes = 0;
+	for(size_t i = 0; i < message.parts(); ++i)
+	{
+		bytes += message.size(i);
+	}
+
+	return bytes;
+}
+
+void report(std::string const& direction, uint64_t const& messages, uint64_t const& bytes, double const& seconds, double const& cpu)
+{
+	double rate = (seconds > 0) ? messages / seconds : 0;
+	double megabytes = (seconds > 0) ? (bytes / seconds) / (1024 * 1024) : 0;
+	double usage = (seconds > 0) ? (cpu / seconds) * 100 : 0;
+
+	std::cout << "**: " << direction << " " << messages << " messages, " << bytes << " bytes in " << seconds << " seconds" << std::endl;
+	std::cout << "**: " << rate << " messages/sec" << std::endl;
+	std::cout << "**: " << megabytes << " MB/sec" << std::endl;
+	std::cout << "**: " << usage << "% cpu" << std::endl;
+}
+
+}
+
+int benchmark_send(zmqpp::socket& socket, benchmark_settings const& settings)
+{
+	std::vector<char> payload(settings.message_size, 'x');
+	zmqpp::message message;
+
+	uint64_t sent = 0;
+	double cpu_start = cpu_seconds();
+	clock_type::time_point start = clock_type::now();
+
+	while(running(sent, start, settings))
+	{
+		message.add(payload.data(), payload.size());
+		socket.send(message);
+		++sent;
+	}
+
+	double seconds = seconds_since(start);
+	report("sent", sent, sent * settings.message_size, seconds, cpu_seconds() - cpu_start);
+
+	return EXIT_SUCCESS;
+}
+
+int benchmark_receive(zmqpp::socket& socket, benchmark_settings const& settings)
+{
+	zmqpp::poller poller;
+	poller.add(socket);
+
+	zmqpp::message message;
+	socket.receive(message);
+	message.clear();
+
+	// The first message only starts the clock, so it is left out of the totals
+	uint64_t received = 0;
+	uint64_t bytes = 0;
+
+	double cpu_start = cpu_seconds();
+	clock_type::time_point start = clock_type::now();
+	clock_type::time_point last = start;
+
+	// The sender's count includes the first message
+	while(running(received + 1, start, settings))
+	{
+		if (!socket.receive(message, true))
+		{
+			if (!poller.poll(idle_timeout))
+			{
+				std::cout << "!!: No messages for " << idle_timeout << " milliseconds, stopping" << std::endl;
+				break;
+			}
+
+			continue;
+		}
+
+		bytes += message_bytes(message);
+		message.clear();
+
+		last = clock_type::now();
+		++received;
+	}
+
+	double seconds = std::chrono::duration<double>(last - start).count();
+	report("received", received, bytes, seconds, cpu_seconds() - cpu_start);
+
+	return EXIT_SUCCESS;
+}
+
+int benchmark_latency(zmqpp::socket& socket, benchmark_settings const& settings)
+{
+	std::vector<char> payload(settings.message_size, 'x');
+	zmqpp::message message;
+
+	histogram latencies;
+	std::vector<uint64_t> samples;
+	if (!settings.samples.empty())
+	{
+		samples.reserve(settings.messages);
+	}
+
+	clock_type::time_point start = clock_type::now();
+	while(running(latencies.count(), start, settings))
+	{
+		message.add(payload.data(), payload.size());
+
+		clock_type::time_point sent = clock_type::now();
+		socket.send(message);
+		socket.receive(message);
+		uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - sent).count();
+
+		message.clear();
+
+		latencies.record(elapsed);
+		if (!settings.samples.empty())
+		{
+			samples.push_back(elapsed);
+		}
+	}
+
+	std::cout << "**: " << latencies.count() << " round trips of " << settings.message_size << " bytes in " << seconds_since(start) << " seconds" << std::endl;
+	std::cout << "**: latency in microseconds" << std::endl;
+	std::cout << "**: min   " << latencies.min() / 1e3 << std::endl;
+	std::cout << "**: mean  " << latencies.mean() / 1e3 << std::endl;
+	std::cout << "**: p50   " << latencies.percentile(50) / 1e3 << std::endl;
+	std::cout << "**: p90   " << latencies.percentile(90) / 1e3 << std::endl;
+	std::cout << "**: p99   " << latencies.percentile(99) / 1e3 << std::endl;
+	std::cout << "**: p99.9 " << latencies.percentile(99.9) / 1e3 << std::endl;
+	std::cout << "**: max   " << latencies.max() / 1e3 << std::endl;
+
+	if (!settings.samples.empty())
+	{
+		std::ofstream file(settings.samples.c_str());
+		if (!file)
+		{
+			std::cout << "!!: Unable to write samples to " << settings.samples << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		for(size_t i = 0; i < samples.size(); ++i)
+		{
+			file << samples[i] << '\n';
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int benchmark_echo(zmqpp::socket& socket, benchmark_settings const& settings)
+{
+	zmqpp::poller poller;
+	poller.add(socket);
+
+	zmqpp::message message;
+
+	uint64_t echoed = 0;
+	clock_type::time_point start = clock_type::now();
+	while(running(echoed, start, settings))
+	{
+		if (!socket.receive(message, true))
+		{
+			if (!poller.poll(idle_timeout) && (echoed > 0))
+			{
+				std::cout << "!!: No messages for " << idle_timeout << " milliseconds, stopping" << std::endl;
+				break;
+			}
+
+			continue;
+		}
+
+		socket.send(message);
+		++echoed;
+	}
+
+	std::cout << "**: echoed " << echoed << " messages" << std::endl;
+
+	return EXIT_SUCCESS;
+}
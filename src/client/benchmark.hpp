@@ -0,0 +1,75 @@
+/**
+ * \file
+ *
+ * Benchmark modes for the zmqpp client tool.
+ *
+ * The throughput modes follow the zmq local_thr / remote_thr model where one
+ * side blasts messages and the other counts them, both sides report what they
+ * saw. The latency modes follow local_lat / remote_lat with one side timing
+ * round trips and the other echoing everything back.
+ */
+
+#ifndef ZMQPP_CLIENT_BENCHMARK_HPP_
+#define ZMQPP_CLIENT_BENCHMARK_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include <zmqpp/zmqpp.hpp>
+
+/*!
+ * Limits for a benchmark run.
+ *
+ * If duration is non-zero it takes precedence over the message count.
+ */
+struct benchmark_settings
+{
+	size_t message_size;  /*!< bytes in each message */
+	uint64_t messages;    /*!< number of messages to send or receive */
+	double duration;      /*!< seconds to run for, zero to use the message count */
+	std::string samples;  /*!< file to write raw latency samples to, empty for none */
+};
+
+/*!
+ * Send messages as fast as the socket allows and report the rate.
+ *
+ * \param socket connected or bound send capable socket.
+ * \param settings message size and run limits.
+ * \return process exit code.
+ */
+int benchmark_send(zmqpp::socket& socket, benchmark_settings const& settings);
+
+/*!
+ * Receive messages as fast as they arrive and report the rate.
+ *
+ * Timing starts with the first message received, the run also ends if
+ * nothing has been received for a second.
+ *
+ * \param socket connected or bound receive capable socket.
+ * \param settings run limits, the message size is ignored.
+ * \return process exit code.
+ */
+int benchmark_receive(zmqpp::socket& socket, benchmark_settings const& settings);
+
+/*!
+ * Time round trips of messages bounced off an echoing peer.
+ *
+ * Reports the latency percentiles of the round trips and optionally writes
+ * every sample, in nanoseconds, to the settings samples file.
+ *
+ * \param socket connected or bound request or pair socket.
+ * \param settings message size and run limits.
+ * \return process exit code.
+ */
+int benchmark_latency(zmqpp::socket& socket, benchmark_settings const& settings);
+
+/*!
+ * Echo messages back to the sender for a latency benchmark.
+ *
+ * \param socket connected or bound reply or pair socket.
+ * \param settings run limits, the message size is ignored.
+ * \return process exit code.
+ */
+int benchmark_echo(zmqpp::socket& socket, benchmark_settings const& settings);
+
+#endif /* ZMQPP_CLIENT_BENCHMARK_HPP_ */
@@ -0,0 +1,279 @@
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <zmqpp/inet.hpp>
+
+#include "capture.hpp"
+
+namespace
+{
+
+char const capture_marker[] = "ZMQPPCAP";
+const size_t capture_marker_size = 8;
+const uint32_t capture_version = 1;
+
+// Size of the stdio buffer used for capture files
+const size_t file_buffer_size = 1 << 20;
+
+// How long the socket can be quiet before the capture is flushed
+const long flush_timeout = 100;
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void interrupt(int)
+{
+	interrupted = 1;
+}
+
+uint64_t epoch_nanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool write_uint32(FILE* file, uint32_t const& value)
+{
+	uint32_t network_order = htonl(value);
+	return 1 == fwrite(&network_order, sizeof(uint32_t), 1, file);
+}
+
+bool write_uint64(FILE* file, uint64_t const& value)
+{
+	uint64_t network_order = htonll(value);
+	return 1 == fwrite(&network_order, sizeof(uint64_t), 1, file);
+}
+
+bool write_record(FILE* file, zmqpp::message& message)
+{
+	bool written = write_uint64(file, epoch_nanoseconds()) && write_uint32(file, message.parts());
+	for(size_t i = 0; written && (i < message.parts()); ++i)
+	{
+		written = write_uint32(file, message.size(i))
+				&& (message.size(i) == fwrite(message.raw_data(i), 1, message.size(i), file));
+	}
+
+	return written;
+}
+
+bool read_uint32(FILE* file, uint32_t& value)
+{
+	uint32_t network_order;
+	if (1 != fread(&network_order, sizeof(uint32_t), 1, file))
+	{
+		return false;
+	}
+
+	value = ntohl(network_order);
+	return true;
+}
+
+bool read_uint64(FILE* file, uint64_t& value)
+{
+	uint64_t network_order;
+	if (1 != fread(&network_order, sizeof(uint64_t), 1, file))
+	{
+		return false;
+	}
+
+	value = ntohll(network_order);
+	return true;
+}
+
+}
+
+int record(zmqpp::socket& socket, std::string const& filename)
+{
+	FILE* file = fopen(filename.c_str(), "ab");
+	if (nullptr == file)
+	{
+		std::cerr << "!!: Unable to open " << filename << " for recording: " << strerror(errno) << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<char> buffer(file_buffer_size);
+	setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+	fseek(file, 0, SEEK_END);
+	if ((0 == ftell(file)) && ((capture_marker_size != fwrite(capture_marker, 1, capture_marker_size, file)) || !write_uint32(file, capture_version)))
+	{
+		std::cerr << "!!: Unable to write to " << filename << ": " << strerror(errno) << std::endl;
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+
+	std::signal(SIGINT, &interrupt);
+	std::signal(SIGTERM, &interrupt);
+
+	zmqpp::poller poller;
+	poller.add(socket);
+
+	zmqpp::message message;
+	uint64_t recorded = 0;
+	bool unflushed = false;
+	bool failed = false;
+
+	try
+	{
+		while(!interrupted)
+		{
+			if (!socket.receive(message, true))
+			{
+				if (!poller.poll((unflushed) ? flush_timeout : zmqpp::poller::WAIT_FOREVER))
+				{
+					if (0 != fflush(file))
+					{
+						failed = true;
+						break;
+					}
+					unflushed = false;
+				}
+
+				continue;
+			}
+
+			// Sizes are stored in 32 bits, anything bigger cannot be recorded
+			bool fits = true;
+			for(size_t i = 0; i < message.parts(); ++i)
+			{
+				fits = fits && (message.size(i) <= std::numeric_limits<uint32_t>::max());
+			}
+
+			if (!fits)
+			{
+				std::cerr << "!!: Skipping a message with a part over 4 GiB" << std::endl;
+				message.clear();
+				continue;
+			}
+
+			if (!write_record(file, message))
+			{
+				failed = true;
+				break;
+			}
+
+			message.clear();
+			unflushed = true;
+			++recorded;
+		}
+	}
+	catch(zmqpp::zmq_internal_exception& e)
+	{
+		// interrupted system calls are how we expect to be stopped
+		if (EINTR != e.zmq_error())
+		{
+			fclose(file);
+			throw;
+		}
+	}
+
+	// A full disk may only show up when the buffer is written out
+	failed = (0 != fclose(file)) || failed;
+	if (failed)
+	{
+		std::cerr << "!!: Unable to write to " << filename << ": " << strerror(errno) << std::endl;
+	}
+
+	std::cerr << "**: recorded " << recorded << " messages to " << filename << std::endl;
+
+	return (failed) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int replay(zmqpp::socket& socket, std::string const& filename, double const& speed)
+{
+	FILE* file = fopen(filename.c_str(), "rb");
+	if (nullptr == file)
+	{
+		std::cerr << "!!: Unable to open " << filename << " for replay: " << strerror(errno) << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<char> buffer(file_buffer_size);
+	setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+	char marker[capture_marker_size];
+	uint32_t version = 0;
+	if ((capture_marker_size != fread(marker, 1, capture_marker_size, file))
+			|| (0 != memcmp(marker, capture_marker, capture_marker_size))
+			|| !read_uint32(file, version) || (capture_version != version))
+	{
+		std::cerr << "!!: " << filename << " is not a zmqpp capture file" << std::endl;
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+
+	// Part sizes are checked against what is left of the file before anything is allocated
+	long header_end = ftell(file);
+	fseek(file, 0, SEEK_END);
+	long file_size = ftell(file);
+	fseek(file, header_end, SEEK_SET);
+
+	zmqpp::message message;
+	std::vector<char> part;
+	uint64_t replayed = 0;
+	bool corrupt = false;
+	uint64_t first_timestamp = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	uint64_t timestamp;
+	while(read_uint64(file, timestamp))
+	{
+		uint32_t parts = 0;
+		bool complete = read_uint32(file, parts);
+		corrupt = complete && (0 == parts);
+		for(uint32_t i = 0; complete && !corrupt && (i < parts); ++i)
+		{
+			uint32_t size = 0;
+			complete = read_uint32(file, size);
+			if (!complete)
+			{
+				break;
+			}
+
+			if (static_cast<long>(size) > file_size - ftell(file))
+			{
+				corrupt = true;
+				break;
+			}
+
+			part.resize(size);
+			complete = (size == fread(part.data(), 1, size, file));
+
+			message.add(part.data(), part.size());
+		}
+
+		if (corrupt)
+		{
+			std::cerr << "!!: Capture has a corrupt record after " << replayed << " messages, stopping" << std::endl;
+			break;
+		}
+
+		if (!complete)
+		{
+			std::cerr << "!!: Capture ends with a truncated record, stopping" << std::endl;
+			break;
+		}
+
+		if (0 == replayed)
+		{
+			first_timestamp = timestamp;
+		}
+		else if ((speed > 0) && (timestamp > first_timestamp))
+		{
+			std::chrono::nanoseconds offset(static_cast<uint64_t>((timestamp - first_timestamp) / speed));
+			std::this_thread::sleep_until(start + offset);
+		}
+
+		socket.send(message);
+		++replayed;
+	}
+
+	fclose(file);
+	std::cerr << "**: replayed " << replayed << " messages from " << filename << std::endl;
+
+	return (corrupt) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,49 @@
+/**
+ * \file
+ *
+ * Traffic capture and replay for the zmqpp client tool.
+ *
+ * Capture files are append only and made up of an 8 byte "ZMQPPCAP" marker
+ * and 32 bit format version followed by one record per multipart message;
+ *
+ * \li 64 bit receive time in nanoseconds since the epoch.
+ * \li 32 bit number of parts.
+ * \li for each part a 32 bit size followed by the part data.
+ *
+ * All integers are in network byte order.
+ */
+
+#ifndef ZMQPP_CLIENT_CAPTURE_HPP_
+#define ZMQPP_CLIENT_CAPTURE_HPP_
+
+#include <string>
+
+#include <zmqpp/zmqpp.hpp>
+
+/*!
+ * Append every message received on the socket to a capture file.
+ *
+ * Runs until interrupted, the capture is flushed to disk whenever the socket
+ * goes quiet and on exit.
+ *
+ * \param socket connected or bound receive capable socket.
+ * \param filename capture file to create or append to.
+ * \return process exit code.
+ */
+int record(zmqpp::socket& socket, std::string const& filename);
+
+/*!
+ * Send every message in a capture file.
+ *
+ * The gaps between messages are kept as they were recorded divided by speed,
+ * so a speed of 2 replays twice as fast. A speed of zero sends everything as
+ * fast as the socket allows.
+ *
+ * \param socket connected or bound send capable socket.
+ * \param filename capture file to replay.
+ * \param speed multiple of the original pacing to replay at.
+ * \return process exit code.
+ */
+int replay(zmqpp::socket& socket, std::string const& filename, double const& speed);
+
+#endif /* ZMQPP_CLIENT_CAPTURE_HPP_ */
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <limits>
+
+#include "histogram.hpp"
+
+namespace
+{
+
+const int sub_bucket_bits = 10;
+const uint64_t sub_bucket_half = 1 << sub_bucket_bits;    // 1024
+const uint64_t exact_limit = sub_bucket_half << 1;         // 2048
+const int max_shift = 64 - (sub_bucket_bits + 1);
+
+int most_significant_bit(uint64_t const& value)
+{
+	return 63 - __builtin_clzll(value);
+}
+
+}
+
+histogram::histogram()
+	: _counts(exact_limit + max_shift * sub_bucket_half, 0)
+	, _count(0)
+	, _min(std::numeric_limits<uint64_t>::max())
+	, _max(0)
+	, _total(0)
+{
+}
+
+void histogram::record(uint64_t const& value)
+{
+	++_counts[index_for(value)];
+	++_count;
+	_min = std::min(_min, value);
+	_max = std::max(_max, value);
+	_total += value;
+}
+
+double histogram::mean() const
+{
+	return (_count > 0) ? _total / _count : 0;
+}
+
+uint64_t histogram::percentile(double const& percentile) const
+{
+	if (0 == _count)
+	{
+		return 0;
+	}
+
+	uint64_t target = static_cast<uint64_t>((std::min(percentile, 100.0) / 100.0) * _count + 0.5);
+	target = std::max<uint64_t>(target, 1);
+
+	uint64_t seen = 0;
+	for(size_t i = 0; i < _counts.size(); ++i)
+	{
+		seen += _counts[i];
+		if (seen >= target)
+		{
+			return std::min(highest_equivalent(i), _max);
+		}
+	}
+
+	return _max;
+}
+
+size_t histogram::index_for(uint64_t const& value)
+{
+	if (value < exact_limit)
+	{
+		return static_cast<size_t>(value);
+	}
+
+	int shift = most_significant_bit(value) - sub_bucket_bits;
+	uint64_t sub_bucket = value >> shift;
+
+	return exact_limit + (shift - 1) * sub_bucket_half + (sub_bucket - sub_bucket_half);
+}
+
+uint64_t histogram::highest_equivalent(size_t const& index)
+{
+	if (index < exact_limit)
+	{
+		return index;
+	}
+
+	size_t offset = index - exact_limit;
+	int shift = static_cast<int>(offset / sub_bucket_half) + 1;
+	uint64_t sub_bucket = (offset % sub_bucket_half) + sub_bucket_half;
+
+	return ((sub_bucket + 1) << shift) - 1;
+}
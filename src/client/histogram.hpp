@@ -0,0 +1,73 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_CLIENT_HISTOGRAM_HPP_
+#define ZMQPP_CLIENT_HISTOGRAM_HPP_
+
+#include <cstdint>
+#include <vector>
+
+/*!
+ * High dynamic range histogram of unsigned integer values.
+ *
+ * Values below 2048 are recorded exactly, larger values go into log-linear
+ * buckets of 1024 sub-buckets per power of two. This keeps the recorded value
+ * within 0.1% of the real one from nanoseconds up to hours with a fixed
+ * amount of memory and constant time recording.
+ */
+class histogram
+{
+public:
+	histogram();
+
+	/*!
+	 * Record a single value.
+	 *
+	 * \param value the value to add to the histogram.
+	 */
+	void record(uint64_t const& value);
+
+	/*!
+	 * \return number of values recorded.
+	 */
+	uint64_t count() const { return _count; }
+
+	/*!
+	 * \return smallest value recorded, exact.
+	 */
+	uint64_t min() const { return _min; }
+
+	/*!
+	 * \return largest value recorded, exact.
+	 */
+	uint64_t max() const { return _max; }
+
+	/*!
+	 * \return mean of all values recorded.
+	 */
+	double mean() const;
+
+	/*!
+	 * Get the value at or below which the given percentage of values fall.
+	 *
+	 * The highest value that is equivalent to the bucket is returned so
+	 * percentiles are never under reported.
+	 *
+	 * \param percentile value between 0 and 100.
+	 * \return the value at that percentile, zero if nothing has been recorded.
+	 */
+	uint64_t percentile(double const& percentile) const;
+
+private:
+	std::vector<uint64_t> _counts;
+	uint64_t _count;
+	uint64_t _min;
+	uint64_t _max;
+	double _total;
+
+	static size_t index_for(uint64_t const& value);
+	static uint64_t highest_equivalent(size_t const& index);
+};
+
+#endif /* ZMQPP_CLIENT_HISTOGRAM_HPP_ */
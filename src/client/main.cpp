@@ -16,6 +16,10 @@
 #include <defines.hpp>
 #include <zmqpp/zmqpp.hpp>
 
+#include "benchmark.hpp"
+#include "capture.hpp"
+#include "stream.hpp"
+
 #ifndef BUILD_CLIENT_NAME
 #define BUILD_CLIENT_NAME "zmqpp"
 #endif
@@ -32,6 +36,47 @@ boost::program_options::options_description connection_options()
 	return options;
 }
 
+boost::program_options::options_description benchmark_options()
+{
+	boost::program_options::options_description options("Benchmark Options");
+	options.add_options()
+		("bench-send", "send messages as fast as possible and report the rate")
+		("bench-recv", "receive messages as fast as possible and report the rate")
+		("bench-latency", "time round trips to an echoing peer and report the latency")
+		("bench-echo", "echo messages back for a peer running a latency benchmark")
+		("samples", boost::program_options::value<std::string>(), "write raw latency samples in nanoseconds to a file")
+		("size,s", boost::program_options::value<size_t>()->default_value(64), "benchmark message size in bytes")
+		("count,n", boost::program_options::value<uint64_t>()->default_value(100000), "benchmark message or round trip count")
+		("duration,d", boost::program_options::value<double>()->default_value(0), "benchmark for this many seconds rather than a message count")
+		;
+
+	return options;
+}
+
+boost::program_options::options_description stream_options()
+{
+	boost::program_options::options_description options("Streaming Options");
+	options.add_options()
+		("stream", "bulk stream delimited standard in to the socket and the socket to standard out")
+		("delimiter", boost::program_options::value<std::string>()->default_value("\\n"), "message delimiter for streaming, supports \\n \\r \\t and \\0")
+		("block-size", boost::program_options::value<size_t>()->default_value(65536), "bytes to read from standard in at a time when streaming")
+		;
+
+	return options;
+}
+
+boost::program_options::options_description capture_options()
+{
+	boost::program_options::options_description options("Capture Options");
+	options.add_options()
+		("record", boost::program_options::value<std::string>(), "append every received message to a capture file")
+		("replay", boost::program_options::value<std::string>(), "send every message in a capture file")
+		("speed", boost::program_options::value<double>()->default_value(1.0), "multiple of the recorded pacing to replay at, 0 for as fast as possible")
+		;
+
+	return options;
+}
+
 boost::program_options::options_description miscellaneous_options()
 {
 	boost::program_options::options_description options("Miscellaneous Options");
@@ -65,6 +110,9 @@ int main(int argc, char const* argv[])
 		;
 	all.add(miscellaneous_options());
 	all.add(connection_options());
+	all.add(benchmark_options());
+	all.add(stream_options());
+	all.add(capture_options());
 
 	boost::program_options::variables_map vm;
 	bool usage = false;
@@ -79,6 +127,8 @@ int main(int argc, char const* argv[])
 	socket_types["req"] = socket_type_data(zmqpp::socket_type::request, true, false, true);
 	socket_types["rep"] = socket_type_data(zmqpp::socket_type::reply, false, true, true);
 
+	socket_types["pair"] = socket_type_data(zmqpp::socket_type::pair, true, true, false);
+
 	try {
 		boost::program_options::store(boost::program_options::command_line_parser(argc, argv).options(all).positional(arguments).run(), vm);
 	}
@@ -129,6 +179,9 @@ int main(int argc, char const* argv[])
 		}
 
 		std::cout << connection_options() << std::endl;
+		std::cout << benchmark_options() << std::endl;
+		std::cout << stream_options() << std::endl;
+		std::cout << capture_options() << std::endl;
 		std::cout << miscellaneous_options() << std::endl;
 		return EXIT_SUCCESS;
 	}
@@ -146,6 +199,12 @@ int main(int argc, char const* argv[])
 	bool can_recv = std::get<2>(data);
 	bool toggles = std::get<3>(data);
 
+	// when streaming standard out is reserved for the received messages, status
+	// also goes to standard error when capturing to keep the two modes alike
+	bool streaming = (vm.count("stream") > 0);
+	bool capturing = (vm.count("record") > 0) || (vm.count("replay") > 0);
+	std::ostream& status = (streaming || capturing) ? std::cerr : std::cout;
+
 	zmqpp::context context;
 	zmqpp::socket socket(context, type);
 
@@ -159,14 +218,14 @@ int main(int argc, char const* argv[])
 		std::vector<std::string> endpoints = vm["bind"].as<std::vector<std::string>>();
 		for(size_t i = 0; i < endpoints.size(); ++i)
 		{
-			std::cout << "binding to " << endpoints[i] << std::endl;
+			status << "binding to " << endpoints[i] << std::endl;
 			try
 			{
 				socket.bind(endpoints[i]);
 			}
 			catch(zmqpp::zmq_internal_exception& e)
 			{
-				std::cout << "failed to bind to endpoint: " << e.what() << std::endl;
+				status << "failed to bind to endpoint: " << e.what() << std::endl;
 				return EXIT_FAILURE;
 			}
 		}
@@ -177,19 +236,87 @@ int main(int argc, char const* argv[])
 		std::vector<std::string> endpoints = vm["connect"].as<std::vector<std::string>>();
 		for(size_t i = 0; i < endpoints.size(); ++i)
 		{
-			std::cout << "connecting to " << endpoints[i] << std::endl;
+			status << "connecting to " << endpoints[i] << std::endl;
 			try
 			{
 				socket.connect(endpoints[i]);
 			}
 			catch(zmqpp::zmq_internal_exception& e)
 			{
-				std::cout << "failed to bind to endpoint: " << e.what() << std::endl;
+				status << "failed to bind to endpoint: " << e.what() << std::endl;
 				return EXIT_FAILURE;
 			}
 		}
 	}
 
+	if (capturing)
+	{
+		bool recording = (vm.count("record") > 0);
+		if ((recording && !can_recv) || (!recording && !can_send) || toggles)
+		{
+			std::cerr << "!!: Socket type " << vm["type"].as<std::string>() << " can not be used to " << ((recording) ? "record" : "replay") << " a capture" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (recording)
+		{
+			return record(socket, vm["record"].as<std::string>());
+		}
+
+		return replay(socket, vm["replay"].as<std::string>(), vm["speed"].as<double>());
+	}
+
+	if (streaming)
+	{
+		if (toggles)
+		{
+			std::cerr << "!!: Socket type " << vm["type"].as<std::string>() << " can not be used for streaming" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		stream_settings settings;
+		settings.delimiter = unescape_delimiter(vm["delimiter"].as<std::string>());
+		settings.block_size = vm["block-size"].as<size_t>();
+		settings.can_send = can_send;
+		settings.can_receive = can_recv;
+
+		return stream(socket, settings);
+	}
+
+	if (vm.count("bench-send") || vm.count("bench-recv") || vm.count("bench-latency") || vm.count("bench-echo"))
+	{
+		benchmark_settings settings;
+		settings.message_size = vm["size"].as<size_t>();
+		settings.messages = vm["count"].as<uint64_t>();
+		settings.duration = vm["duration"].as<double>();
+		if (vm.count("samples"))
+		{
+			settings.samples = vm["samples"].as<std::string>();
+		}
+
+		if (vm.count("bench-latency") || vm.count("bench-echo"))
+		{
+			bool pinging = (vm.count("bench-latency") > 0);
+			bool round_trip = (can_send && can_recv && !toggles) || (toggles && (pinging == can_send));
+			if (!round_trip)
+			{
+				std::cout << "!!: Socket type " << vm["type"].as<std::string>() << " can not be used to " << ((pinging) ? "time" : "echo") << " a latency benchmark" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			return (pinging) ? benchmark_latency(socket, settings) : benchmark_echo(socket, settings);
+		}
+
+		bool sending = (vm.count("bench-send") > 0);
+		if ((sending && !can_send) || (!sending && !can_recv) || toggles)
+		{
+			std::cout << "!!: Socket type " << vm["type"].as<std::string>() << " can not be used to " << ((sending) ? "send" : "receive") << " a benchmark" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		return (sending) ? benchmark_send(socket, settings) : benchmark_receive(socket, settings);
+	}
+
 	bool multipart = (vm.count("multipart") > 0);
 
 	zmqpp::poller poller;
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+#include "stream.hpp"
+
+namespace
+{
+
+// Size of the buffer between received messages and standard out
+const size_t output_buffer_size = 1 << 20;
+
+// Most messages read from the socket before checking standard in again
+const size_t receive_batch = 1024;
+
+// How long the socket can be quiet before buffered output is flushed
+const long flush_timeout = 100;
+
+void write_part(void const* data, size_t const& size, std::string const& delimiter)
+{
+	fwrite(data, 1, size, stdout);
+	fwrite(delimiter.data(), 1, delimiter.size(), stdout);
+}
+
+void send_record(zmqpp::socket& socket, zmqpp::message& message, char const* data, size_t const& size)
+{
+	message.add(data, size);
+	socket.send(message);
+}
+
+}
+
+std::string unescape_delimiter(std::string const& escaped)
+{
+	std::string delimiter;
+
+	for(size_t i = 0; i < escaped.size(); ++i)
+	{
+		if (('\\' != escaped[i]) || (i + 1 == escaped.size()))
+		{
+			delimiter.push_back(escaped[i]);
+			continue;
+		}
+
+		switch(escaped[++i])
+		{
+		case 'n': delimiter.push_back('\n'); break;
+		case 'r': delimiter.push_back('\r'); break;
+		case 't': delimiter.push_back('\t'); break;
+		case '0': delimiter.push_back('\0'); break;
+		default: delimiter.push_back(escaped[i]); break;
+		}
+	}
+
+	return delimiter;
+}
+
+int stream(zmqpp::socket& socket, stream_settings const& settings)
+{
+	if (settings.delimiter.empty())
+	{
+		std::cerr << "!!: Streaming requires a delimiter" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int standardin = fileno(stdin);
+	bool reading = settings.can_send;
+	bool unflushed = false;
+
+	// static as stdout still points at it after we return
+	static char output_buffer[output_buffer_size];
+	setvbuf(stdout, output_buffer, _IOFBF, output_buffer_size);
+
+	std::vector<char> pending;
+	pending.reserve(settings.block_size * 2);
+	size_t scanned = 0;
+
+	zmqpp::message message;
+	zmqpp::poller poller;
+	poller.add(socket, (settings.can_receive) ? zmqpp::poller::POLL_IN : zmqpp::poller::POLL_NONE);
+	poller.add(standardin, (reading) ? zmqpp::poller::POLL_IN | zmqpp::poller::POLL_ERROR : zmqpp::poller::POLL_NONE);
+
+	while(reading || settings.can_receive)
+	{
+		if (!poller.poll((unflushed) ? flush_timeout : zmqpp::poller::WAIT_FOREVER))
+		{
+			fflush(stdout);
+			unflushed = false;
+			continue;
+		}
+
+		if (poller.has_input(socket))
+		{
+			for(size_t count = 0; (count < receive_batch) && socket.receive(message, true); ++count)
+			{
+				for(size_t i = 0; i < message.parts(); ++i)
+				{
+					write_part(message.raw_data(i), message.size(i), settings.delimiter);
+				}
+
+				message.clear();
+				unflushed = true;
+			}
+		}
+
+		// a closed pipe is flagged as an error rather than input, read will see the end
+		if (reading && (poller.has_input(standardin) || poller.has_error(standardin)))
+		{
+			size_t used = pending.size();
+			pending.resize(used + settings.block_size);
+
+			ssize_t result = read(standardin, pending.data() + used, settings.block_size);
+			if (result < 0)
+			{
+				std::cerr << "!!: Error in standard input" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			pending.resize(used + result);
+
+			// send every complete record in this block back to back
+			size_t start = 0;
+			auto position = pending.begin() + scanned;
+			while(true)
+			{
+				position = std::search(position, pending.end(), settings.delimiter.begin(), settings.delimiter.end());
+				if (pending.end() == position)
+				{
+					break;
+				}
+
+				size_t end = position - pending.begin();
+				send_record(socket, message, pending.data() + start, end - start);
+
+				start = end + settings.delimiter.size();
+				position = pending.begin() + start;
+			}
+
+			pending.erase(pending.begin(), pending.begin() + start);
+			scanned = (pending.size() >= settings.delimiter.size()) ? pending.size() - settings.delimiter.size() + 1 : 0;
+
+			if (0 == result)
+			{
+				if (!pending.empty())
+				{
+					send_record(socket, message, pending.data(), pending.size());
+					pending.clear();
+				}
+
+				reading = false;
+				poller.check_for(standardin, zmqpp::poller::POLL_NONE);
+			}
+		}
+	}
+
+	fflush(stdout);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,53 @@
+/**
+ * \file
+ *
+ * Bulk streaming mode for the zmqpp client tool.
+ *
+ * Unlike the interactive mode standard in is read in large blocks and split
+ * into messages on a delimiter, and received messages are written through a
+ * large output buffer that is only flushed when the socket goes quiet.
+ */
+
+#ifndef ZMQPP_CLIENT_STREAM_HPP_
+#define ZMQPP_CLIENT_STREAM_HPP_
+
+#include <string>
+
+#include <zmqpp/zmqpp.hpp>
+
+/*!
+ * Options for streaming.
+ */
+struct stream_settings
+{
+	std::string delimiter; /*!< separator between messages on standard in and out */
+	size_t block_size;     /*!< bytes to read from standard in at a time */
+	bool can_send;         /*!< standard in should be sent to the socket */
+	bool can_receive;      /*!< the socket should be written to standard out */
+};
+
+/*!
+ * Convert the escape sequences \\n, \\r, \\t, \\0 and \\\\ in a delimiter.
+ *
+ * \param escaped delimiter as given on the command line.
+ * \return the raw delimiter bytes.
+ */
+std::string unescape_delimiter(std::string const& escaped);
+
+/*!
+ * Stream standard in to the socket and the socket to standard out.
+ *
+ * Each delimited record on standard in is sent as a single part message, any
+ * trailing data is sent at the end of input. Each part of a received message
+ * is written to standard out followed by the delimiter.
+ *
+ * Returns once standard in is finished if the socket is send only, otherwise
+ * runs until killed.
+ *
+ * \param socket connected or bound socket.
+ * \param settings delimiter and buffering options.
+ * \return process exit code.
+ */
+int stream(zmqpp::socket& socket, stream_settings const& settings);
+
+#endif /* ZMQPP_CLIENT_STREAM_HPP_ */
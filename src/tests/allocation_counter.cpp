@@ -0,0 +1,100 @@
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.hpp"
+
+namespace
+{
+
+// Per thread so zmq io threads and boost test internals on other threads don't
+// pollute the counts.
+thread_local size_t thread_allocations = 0;
+thread_local size_t thread_deallocations = 0;
+
+void* counted_allocate(size_t size)
+{
+	++thread_allocations;
+
+	void* memory = malloc((0 == size) ? 1 : size);
+	if (nullptr == memory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+void counted_release(void* memory)
+{
+	if (nullptr != memory)
+	{
+		++thread_deallocations;
+		free(memory);
+	}
+}
+
+}
+
+void* operator new(size_t size)
+{
+	return counted_allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+	return counted_allocate(size);
+}
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept
+{
+	++thread_allocations;
+	return malloc((0 == size) ? 1 : size);
+}
+
+void* operator new[](size_t size, std::nothrow_t const&) noexcept
+{
+	++thread_allocations;
+	return malloc((0 == size) ? 1 : size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	counted_release(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	counted_release(memory);
+}
+
+void operator delete(void* memory, std::nothrow_t const&) noexcept
+{
+	counted_release(memory);
+}
+
+void operator delete[](void* memory, std::nothrow_t const&) noexcept
+{
+	counted_release(memory);
+}
+
+allocation_counter::allocation_counter()
+	: _allocations(thread_allocations)
+	, _deallocations(thread_deallocations)
+{
+}
+
+size_t allocation_counter::allocations() const
+{
+	return thread_allocations - _allocations;
+}
+
+size_t allocation_counter::deallocations() const
+{
+	return thread_deallocations - _deallocations;
+}
+
+void allocation_counter::reset()
+{
+	_allocations = thread_allocations;
+	_deallocations = thread_deallocations;
+}
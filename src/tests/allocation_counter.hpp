@@ -0,0 +1,51 @@
+/**
+ * \file
+ *
+ * Test helper for checking code paths don't allocate.
+ *
+ * The test binary replaces the global operator new and delete so every
+ * allocation made through them on a thread is counted. libzmq is C++ so its
+ * allocations through new are seen too, tests should stick to small message
+ * parts (zmq keeps those inline in the zmq_msg_t) and inproc endpoints so
+ * anything counted comes from zmqpp.
+ *
+ * malloc is deliberately not counted, zmq uses it for the payload of large
+ * message parts which is unavoidable and not something zmqpp controls.
+ */
+
+#ifndef ZMQPP_TESTS_ALLOCATION_COUNTER_HPP_
+#define ZMQPP_TESTS_ALLOCATION_COUNTER_HPP_
+
+#include <cstddef>
+
+/*!
+ * Counts allocations made by the current thread since construction.
+ *
+ * Read the count before using any of the boost test macros, they allocate.
+ */
+class allocation_counter
+{
+public:
+	allocation_counter();
+
+	/*!
+	 * \return number of calls to operator new on this thread since construction.
+	 */
+	size_t allocations() const;
+
+	/*!
+	 * \return number of calls to operator delete on this thread since construction.
+	 */
+	size_t deallocations() const;
+
+	/*!
+	 * Restart counting from now.
+	 */
+	void reset();
+
+private:
+	size_t _allocations;
+	size_t _deallocations;
+};
+
+#endif /* ZMQPP_TESTS_ALLOCATION_COUNTER_HPP_ */
@@ -0,0 +1,206 @@
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/socket.hpp"
+
+#include "allocation_counter.hpp"
+
+BOOST_AUTO_TEST_SUITE( allocation )
+
+const int warm_up_messages = 1000;
+const int steady_state_messages = 10000;
+const int max_poll_timeout = 100;
+
+struct small_object
+{
+	int value;
+};
+
+BOOST_AUTO_TEST_CASE( counter_sees_allocations )
+{
+	allocation_counter counter;
+	int* value = new int(42);
+	delete value;
+
+	size_t allocations = counter.allocations();
+	size_t deallocations = counter.deallocations();
+
+	BOOST_CHECK_EQUAL(1, allocations);
+	BOOST_CHECK_EQUAL(1, deallocations);
+}
+
+BOOST_AUTO_TEST_CASE( message_add_is_amortised )
+{
+	zmqpp::message message;
+
+	allocation_counter counter;
+	for(int i = 0; i < 1024; ++i)
+	{
+		message.add("part");
+	}
+	size_t allocations = counter.allocations();
+
+	BOOST_CHECK_EQUAL(1024, message.parts());
+	BOOST_CHECK_LE(allocations, 10);
+	BOOST_CHECK_EQUAL("part", message.get(1023));
+}
+
+BOOST_AUTO_TEST_CASE( cleared_message_reuses_storage )
+{
+	zmqpp::message message;
+	message << "first" << "second" << "third";
+	message.clear();
+
+	allocation_counter counter;
+	for(int i = 0; i < steady_state_messages; ++i)
+	{
+		message << "first" << "second" << "third";
+		message.clear();
+	}
+	size_t allocations = counter.allocations();
+
+	BOOST_CHECK_EQUAL(0, allocations);
+	BOOST_CHECK_EQUAL(0, message.parts());
+}
+
+BOOST_AUTO_TEST_CASE( moving_objects_does_not_allocate_releasers )
+{
+	zmqpp::message message;
+	message.add("reserve");
+	message.clear();
+
+	small_object* object = new small_object();
+	object->value = 42;
+
+	allocation_counter counter;
+	message.move(object);
+	size_t allocations = counter.allocations();
+
+	BOOST_CHECK_EQUAL(0, allocations);
+	BOOST_REQUIRE_EQUAL(1, message.parts());
+
+	small_object* part = nullptr;
+	message.get(part, 0);
+	BOOST_CHECK_EQUAL(42, part->value);
+}
+
+BOOST_AUTO_TEST_CASE( steady_state_message_send_receive )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	zmqpp::message outbound;
+	zmqpp::message inbound;
+
+	for(int i = 0; i < warm_up_messages; ++i)
+	{
+		outbound << "hello" << "world";
+		pusher.send(outbound);
+		puller.receive(inbound);
+		inbound.clear();
+	}
+
+	allocation_counter counter;
+	bool all_sent = true;
+	bool all_received = true;
+	for(int i = 0; i < steady_state_messages; ++i)
+	{
+		outbound << "hello" << "world";
+		all_sent &= pusher.send(outbound);
+		all_received &= puller.receive(inbound);
+		all_received &= (2 == inbound.parts());
+		inbound.clear();
+	}
+	size_t allocations = counter.allocations();
+
+	BOOST_CHECK(all_sent);
+	BOOST_CHECK(all_received);
+	BOOST_CHECK_EQUAL(0, allocations);
+}
+
+BOOST_AUTO_TEST_CASE( steady_state_string_send_receive )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	std::string message;
+	for(int i = 0; i < warm_up_messages; ++i)
+	{
+		pusher.send("hello world!");
+		puller.receive(message);
+	}
+
+	allocation_counter counter;
+	for(int i = 0; i < steady_state_messages; ++i)
+	{
+		pusher.send("hello world!");
+		puller.receive(message);
+	}
+	size_t allocations = counter.allocations();
+
+	BOOST_CHECK_EQUAL(0, allocations);
+	BOOST_CHECK_EQUAL("hello world!", message);
+}
+
+BOOST_AUTO_TEST_CASE( steady_state_poll )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller1(context, zmqpp::socket_type::pull);
+	puller1.bind("inproc://test1");
+
+	zmqpp::socket puller2(context, zmqpp::socket_type::pull);
+	puller2.bind("inproc://test2");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test1");
+
+	zmqpp::poller poller;
+	poller.add(puller1);
+	poller.add(puller2);
+
+	zmqpp::message message;
+	for(int i = 0; i < warm_up_messages; ++i)
+	{
+		message << "hello world!";
+		pusher.send(message);
+		poller.poll(max_poll_timeout);
+		puller1.receive(message);
+		message.clear();
+	}
+
+	allocation_counter counter;
+	bool correct = true;
+	for(int i = 0; i < steady_state_messages; ++i)
+	{
+		message << "hello world!";
+		pusher.send(message);
+
+		correct &= poller.poll(max_poll_timeout);
+		correct &= poller.has_input(puller1);
+		correct &= !poller.has_input(puller2);
+
+		puller1.receive(message);
+		message.clear();
+	}
+	size_t allocations = counter.allocations();
+
+	BOOST_CHECK(correct);
+	BOOST_CHECK_EQUAL(0, allocations);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
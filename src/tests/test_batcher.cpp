@@ -0,0 +1,191 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <thread>
+
+#include "zmqpp/batcher.hpp"
+#include "zmqpp/context.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/socket.hpp"
+#include "zmqpp/unbatcher.hpp"
+
+BOOST_AUTO_TEST_SUITE( batcher )
+
+const int max_poll_timeout = 1000;
+
+BOOST_AUTO_TEST_CASE( round_trip_in_order )
+{
+	zmqpp::context context;
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.bind("inproc://test");
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.connect("inproc://test");
+
+	zmqpp::batcher batcher(pusher, 8192, std::chrono::seconds(10), 512, false);
+	for(int i = 0; i < 100; ++i)
+	{
+		zmqpp::message message;
+		message << "part" << i;
+		batcher.send(message);
+		BOOST_CHECK_EQUAL(0, message.parts());
+	}
+	BOOST_CHECK_EQUAL(100, batcher.pending());
+	BOOST_CHECK(batcher.flush());
+	BOOST_CHECK(!batcher.flush());
+
+	zmqpp::batcher::statistics stats = batcher.stats();
+	BOOST_CHECK_EQUAL(100, stats.messages);
+	BOOST_CHECK_EQUAL(100, stats.batched);
+	BOOST_CHECK_EQUAL(1, stats.batches);
+	BOOST_CHECK_EQUAL(0, stats.direct);
+
+	zmqpp::poller poller;
+	poller.add(puller);
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+
+	zmqpp::unbatcher unbatcher(puller);
+	for(int i = 0; i < 100; ++i)
+	{
+		zmqpp::message message;
+		BOOST_REQUIRE(unbatcher.receive(message, true));
+		BOOST_REQUIRE_EQUAL(2, message.parts());
+
+		std::string text;
+		int number;
+		message >> text >> number;
+		BOOST_CHECK_EQUAL("part", text);
+		BOOST_CHECK_EQUAL(i, number);
+	}
+
+	BOOST_CHECK_EQUAL(0, unbatcher.pending());
+	zmqpp::message none;
+	BOOST_CHECK(!unbatcher.receive(none, true));
+}
+
+BOOST_AUTO_TEST_CASE( size_and_large_messages )
+{
+	zmqpp::context context;
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.bind("inproc://test");
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.connect("inproc://test");
+
+	// each packed message is 4 + 4 + 92 bytes so ten fill a batch
+	zmqpp::batcher batcher(pusher, 1000, std::chrono::seconds(10), 512, false);
+	for(int i = 0; i < 25; ++i)
+	{
+		batcher.send(std::string(92, 'a' + i));
+	}
+	BOOST_CHECK_EQUAL(5, batcher.pending());
+
+	// a large message sends the remaining batch first to keep order
+	batcher.send(std::string(1000, 'z'));
+	BOOST_CHECK_EQUAL(0, batcher.pending());
+
+	zmqpp::batcher::statistics stats = batcher.stats();
+	BOOST_CHECK_EQUAL(3, stats.batches);
+	BOOST_CHECK_EQUAL(1, stats.direct);
+
+	zmqpp::unbatcher unbatcher(puller);
+	for(int i = 0; i < 25; ++i)
+	{
+		std::string text;
+		zmqpp::message message;
+		BOOST_REQUIRE(unbatcher.receive(message));
+		message >> text;
+		BOOST_CHECK(std::string(92, 'a' + i) == text);
+	}
+
+	zmqpp::message message;
+	BOOST_REQUIRE(unbatcher.receive(message));
+	BOOST_CHECK_EQUAL(1, message.parts());
+	BOOST_CHECK_EQUAL(1000, message.size(0));
+}
+
+BOOST_AUTO_TEST_CASE( delay_expires_batch )
+{
+	zmqpp::context context;
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.bind("inproc://test");
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.connect("inproc://test");
+
+	zmqpp::batcher batcher(pusher, 8192, std::chrono::milliseconds(20), 512, false);
+	BOOST_CHECK_EQUAL(-1, batcher.timeout());
+
+	batcher.send("first");
+	long timeout = batcher.timeout();
+	BOOST_CHECK(timeout > 0);
+	BOOST_CHECK(timeout <= 20);
+	BOOST_CHECK(!batcher.expire());
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(25));
+	BOOST_CHECK_EQUAL(0, batcher.timeout());
+	BOOST_CHECK(batcher.expire());
+	BOOST_CHECK_EQUAL(-1, batcher.timeout());
+
+	zmqpp::unbatcher unbatcher(puller);
+	zmqpp::message message;
+	BOOST_REQUIRE(unbatcher.receive(message));
+	std::string text;
+	message >> text;
+	BOOST_CHECK_EQUAL("first", text);
+}
+
+BOOST_AUTO_TEST_CASE( adaptive_sends_when_idle )
+{
+	zmqpp::context context;
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.bind("inproc://test");
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.connect("inproc://test");
+
+	zmqpp::batcher batcher(pusher, 8192, std::chrono::milliseconds(20));
+
+	// idle so the first goes straight out, the burst behind it is batched
+	batcher.send("idle");
+	BOOST_CHECK_EQUAL(0, batcher.pending());
+	for(int i = 0; i < 10; ++i)
+	{
+		batcher.send("burst");
+	}
+	BOOST_CHECK_EQUAL(10, batcher.pending());
+	BOOST_CHECK(batcher.flush());
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(25));
+	batcher.send("idle again");
+	BOOST_CHECK_EQUAL(0, batcher.pending());
+
+	zmqpp::batcher::statistics stats = batcher.stats();
+	BOOST_CHECK_EQUAL(2, stats.direct);
+	BOOST_CHECK_EQUAL(10, stats.batched);
+
+	// plain messages pass through the unbatcher untouched
+	std::string text;
+	zmqpp::message message;
+	zmqpp::unbatcher unbatcher(puller);
+	BOOST_REQUIRE(unbatcher.receive(message));
+	message >> text;
+	BOOST_CHECK_EQUAL("idle", text);
+
+	for(int i = 0; i < 10; ++i)
+	{
+		BOOST_REQUIRE(unbatcher.receive(message));
+	}
+	BOOST_CHECK_EQUAL(0, unbatcher.pending());
+
+	BOOST_REQUIRE(unbatcher.receive(message));
+	message >> text;
+	BOOST_CHECK_EQUAL("idle again", text);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,283 @@
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "zmqpp/broker.hpp"
+#include "zmqpp/context.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( broker )
+
+const int max_poll_timeout = 1000;
+
+struct fixture
+{
+	zmqpp::context context;
+	zmqpp::socket frontend;
+	zmqpp::socket backend;
+	zmqpp::socket client;
+
+	fixture()
+		: context()
+		, frontend(context, zmqpp::socket_type::router)
+		, backend(context, zmqpp::socket_type::router)
+		, client(context, zmqpp::socket_type::dealer)
+	{
+		frontend.bind("inproc://frontend");
+		backend.bind("inproc://backend");
+		client.connect("inproc://frontend");
+	}
+
+	void connect(zmqpp::socket& worker, std::string const& identity)
+	{
+		worker.set(zmqpp::socket_option::identity, identity);
+		worker.connect("inproc://backend");
+	}
+};
+
+// Run the broker until the socket has something to read
+bool pump(zmqpp::broker& broker, zmqpp::socket& socket)
+{
+	zmqpp::poller poller;
+	poller.add(socket);
+
+	for(int attempt = 0; attempt < 100; ++attempt)
+	{
+		broker.poll(10);
+		if (poller.poll(0))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::string receive_request(zmqpp::socket& worker, zmqpp::message& envelope)
+{
+	worker.receive(envelope);
+	BOOST_REQUIRE_EQUAL(2, envelope.parts());
+	return envelope.get(1);
+}
+
+BOOST_FIXTURE_TEST_CASE( invalid_sockets, fixture )
+{
+	BOOST_CHECK_THROW(zmqpp::broker(frontend, client), zmqpp::exception);
+	BOOST_CHECK_THROW(zmqpp::broker(frontend, backend, 0), zmqpp::exception);
+
+	zmqpp::broker broker(frontend, backend);
+	BOOST_CHECK_EQUAL(0, broker.workers());
+	BOOST_CHECK_EQUAL(0, broker.ready_workers());
+	BOOST_CHECK_EQUAL(0, broker.backlog());
+}
+
+BOOST_FIXTURE_TEST_CASE( least_recently_used_first, fixture )
+{
+	zmqpp::broker broker(frontend, backend);
+
+	zmqpp::socket first(context, zmqpp::socket_type::dealer);
+	connect(first, "first");
+	zmqpp::socket second(context, zmqpp::socket_type::dealer);
+	connect(second, "second");
+
+	first.send(zmqpp::broker::ready_signal);
+	while(broker.ready_workers() < 1) { broker.poll(max_poll_timeout); }
+	second.send(zmqpp::broker::ready_signal);
+	while(broker.ready_workers() < 2) { broker.poll(max_poll_timeout); }
+	BOOST_CHECK_EQUAL(2, broker.workers());
+
+	BOOST_CHECK(client.send("one"));
+	BOOST_REQUIRE(pump(broker, first));
+	BOOST_CHECK(client.send("two"));
+	BOOST_REQUIRE(pump(broker, second));
+
+	zmqpp::message one, two;
+	BOOST_CHECK_EQUAL("one", receive_request(first, one));
+	BOOST_CHECK_EQUAL("two", receive_request(second, two));
+	BOOST_CHECK_EQUAL(0, broker.ready_workers());
+
+	// second finishes first so is the least recently used afterwards
+	BOOST_CHECK(second.send(two));
+	BOOST_REQUIRE(pump(broker, client));
+	BOOST_CHECK(first.send(one));
+	while(broker.ready_workers() < 2) { broker.poll(max_poll_timeout); }
+
+	std::string reply;
+	BOOST_CHECK(client.receive(reply));
+	BOOST_CHECK_EQUAL("two", reply);
+	BOOST_CHECK(client.receive(reply));
+	BOOST_CHECK_EQUAL("one", reply);
+
+	BOOST_CHECK(client.send("three"));
+	BOOST_REQUIRE(pump(broker, second));
+
+	zmqpp::message three;
+	BOOST_CHECK_EQUAL("three", receive_request(second, three));
+
+	zmqpp::broker::statistics stats = broker.stats();
+	BOOST_CHECK_EQUAL(3, stats.requests);
+	BOOST_CHECK_EQUAL(2, stats.replies);
+	BOOST_CHECK_EQUAL(0, stats.backlogged);
+}
+
+BOOST_FIXTURE_TEST_CASE( backlog_waits_for_workers, fixture )
+{
+	zmqpp::broker broker(frontend, backend, 1000, 3, 2);
+
+	BOOST_CHECK(client.send("one"));
+	BOOST_CHECK(client.send("two"));
+	BOOST_CHECK(client.send("three"));
+
+	for(int attempt = 0; (attempt < 100) && (broker.backlog() < 2); ++attempt)
+	{
+		broker.poll(10);
+	}
+
+	// the third request is left with the frontend socket
+	broker.poll(10);
+	BOOST_CHECK_EQUAL(2, broker.backlog());
+
+	zmqpp::socket worker(context, zmqpp::socket_type::dealer);
+	connect(worker, "worker");
+	worker.send(zmqpp::broker::ready_signal);
+
+	std::string expected[] = { "one", "two", "three" };
+	for(int i = 0; i < 3; ++i)
+	{
+		BOOST_REQUIRE(pump(broker, worker));
+
+		zmqpp::message request;
+		BOOST_CHECK_EQUAL(expected[i], receive_request(worker, request));
+		BOOST_CHECK(worker.send(request));
+	}
+
+	BOOST_CHECK_EQUAL(0, broker.backlog());
+	BOOST_CHECK_EQUAL(3, broker.stats().backlogged);
+}
+
+BOOST_FIXTURE_TEST_CASE( silent_workers_are_evicted, fixture )
+{
+	zmqpp::broker broker(frontend, backend, 10, 2);
+
+	zmqpp::socket worker(context, zmqpp::socket_type::dealer);
+	connect(worker, "worker");
+	worker.send(zmqpp::broker::ready_signal);
+
+	// the broker heartbeats idle workers
+	BOOST_REQUIRE(pump(broker, worker));
+	std::string heartbeat;
+	BOOST_CHECK(worker.receive(heartbeat));
+	BOOST_CHECK(zmqpp::broker::heartbeat_signal == heartbeat);
+	BOOST_CHECK_EQUAL(1, broker.workers());
+
+	// answering keeps the worker alive
+	for(int i = 0; i < 5; ++i)
+	{
+		worker.send(zmqpp::broker::heartbeat_signal);
+		broker.poll(10);
+	}
+	BOOST_CHECK_EQUAL(1, broker.workers());
+
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(max_poll_timeout);
+	while((broker.workers() > 0) && (std::chrono::steady_clock::now() < deadline))
+	{
+		broker.poll(10);
+	}
+
+	BOOST_CHECK_EQUAL(0, broker.workers());
+	BOOST_CHECK_EQUAL(0, broker.ready_workers());
+	BOOST_CHECK_EQUAL(1, broker.stats().evicted);
+
+	// evicted workers get no requests
+	BOOST_CHECK(client.send("lost"));
+	broker.poll(10);
+	BOOST_CHECK_EQUAL(1, broker.backlog());
+}
+
+BOOST_FIXTURE_TEST_CASE( busy_workers_are_not_evicted, fixture )
+{
+	zmqpp::broker broker(frontend, backend, 10, 2);
+
+	zmqpp::socket worker(context, zmqpp::socket_type::dealer);
+	connect(worker, "worker");
+	worker.send(zmqpp::broker::ready_signal);
+	while(broker.ready_workers() < 1) { broker.poll(max_poll_timeout); }
+
+	BOOST_CHECK(client.send("slow"));
+	BOOST_REQUIRE(pump(broker, worker));
+
+	zmqpp::message request;
+	BOOST_CHECK_EQUAL("slow", receive_request(worker, request));
+
+	// the job runs for many expiry intervals without a word from the worker
+	std::chrono::steady_clock::time_point finished = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+	while(std::chrono::steady_clock::now() < finished)
+	{
+		broker.poll(10);
+	}
+
+	BOOST_CHECK_EQUAL(1, broker.workers());
+	BOOST_CHECK_EQUAL(0, broker.ready_workers());
+	BOOST_CHECK_EQUAL(0, broker.stats().evicted);
+
+	BOOST_CHECK(worker.send(request));
+	BOOST_REQUIRE(pump(broker, client));
+
+	std::string reply;
+	BOOST_CHECK(client.receive(reply));
+	BOOST_CHECK_EQUAL("slow", reply);
+	BOOST_CHECK_EQUAL(1, broker.workers());
+	BOOST_CHECK_EQUAL(1, broker.ready_workers());
+	BOOST_CHECK_EQUAL(0, broker.stats().evicted);
+}
+
+BOOST_AUTO_TEST_CASE( threaded_run )
+{
+	zmqpp::context context;
+
+	zmqpp::socket frontend(context, zmqpp::socket_type::router);
+	frontend.bind("inproc://frontend");
+	zmqpp::socket backend(context, zmqpp::socket_type::router);
+	backend.bind("inproc://backend");
+
+	zmqpp::broker broker(frontend, backend);
+	std::thread thread(&zmqpp::broker::run, &broker);
+
+	zmqpp::socket worker(context, zmqpp::socket_type::dealer);
+	worker.connect("inproc://backend");
+	worker.send(zmqpp::broker::ready_signal);
+
+	zmqpp::socket client(context, zmqpp::socket_type::request);
+	client.connect("inproc://frontend");
+	BOOST_CHECK(client.send("hello"));
+
+	zmqpp::poller poller;
+	poller.add(worker);
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+
+	// request sockets add an empty delimiter which the broker passes through
+	zmqpp::message request;
+	worker.receive(request);
+	BOOST_REQUIRE_EQUAL(3, request.parts());
+	BOOST_CHECK_EQUAL("", request.get(1));
+	BOOST_CHECK_EQUAL("hello", request.get(2));
+	BOOST_CHECK(worker.send(request));
+
+	poller.remove(worker);
+	poller.add(client);
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+
+	std::string reply;
+	BOOST_CHECK(client.receive(reply));
+	BOOST_CHECK_EQUAL("hello", reply);
+
+	broker.stop();
+	thread.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <thread>
+
+#include "zmqpp/channel.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+
+BOOST_AUTO_TEST_SUITE( channel )
+
+const int max_poll_timeout = 1000;
+
+BOOST_AUTO_TEST_CASE( initialise )
+{
+	zmqpp::channel pipe(1000);
+	BOOST_CHECK_EQUAL(1024, pipe.capacity());
+
+	zmqpp::message message;
+	BOOST_CHECK(!pipe.receive(message, true));
+	BOOST_CHECK(pipe.file_descriptor() >= 0);
+}
+
+BOOST_AUTO_TEST_CASE( send_and_receive )
+{
+	zmqpp::channel pipe;
+
+	zmqpp::message message;
+	message << "hello" << "world";
+	BOOST_CHECK(pipe.send(message));
+	BOOST_CHECK_EQUAL(0, message.parts());
+	BOOST_CHECK(pipe.send("second"));
+
+	zmqpp::message received;
+	BOOST_CHECK(pipe.receive(received, true));
+	BOOST_REQUIRE_EQUAL(2, received.parts());
+	BOOST_CHECK_EQUAL("hello", received.get(0));
+	BOOST_CHECK_EQUAL("world", received.get(1));
+
+	zmqpp::message not_empty;
+	not_empty << "part";
+	BOOST_CHECK_THROW(pipe.receive(not_empty, true), zmqpp::exception);
+
+	std::string text;
+	BOOST_CHECK(pipe.receive(text, true));
+	BOOST_CHECK_EQUAL("second", text);
+	BOOST_CHECK(!pipe.receive(text, true));
+}
+
+BOOST_AUTO_TEST_CASE( full_channel_refuses )
+{
+	zmqpp::channel pipe(2);
+
+	BOOST_CHECK(pipe.send("one", true));
+	BOOST_CHECK(pipe.send("two", true));
+
+	zmqpp::message message;
+	message << "three";
+	BOOST_CHECK(!pipe.send(message, true));
+	BOOST_CHECK_EQUAL(1, message.parts());
+
+	std::string text;
+	BOOST_CHECK(pipe.receive(text, true));
+	BOOST_CHECK_EQUAL("one", text);
+	BOOST_CHECK(pipe.send(message, true));
+}
+
+BOOST_AUTO_TEST_CASE( threaded_order )
+{
+	zmqpp::channel pipe(64);
+	const uint32_t count = 200000;
+
+	std::thread producer([&pipe, count]() {
+		for(uint32_t i = 0; i < count; ++i)
+		{
+			zmqpp::message message;
+			message << i;
+			pipe.send(message);
+		}
+	});
+
+	bool ordered = true;
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		zmqpp::message message;
+		pipe.receive(message);
+
+		uint32_t value = 0;
+		message >> value;
+		ordered &= (i == value);
+	}
+
+	producer.join();
+	BOOST_CHECK(ordered);
+}
+
+BOOST_AUTO_TEST_CASE( poller_wakes_parked_consumer )
+{
+	zmqpp::channel pipe;
+
+	zmqpp::poller poller;
+	poller.add(pipe.file_descriptor());
+
+	// parks the consumer
+	std::string text;
+	BOOST_CHECK(!pipe.receive(text, true));
+	BOOST_CHECK(!poller.poll(0));
+
+	std::thread producer([&pipe]() { pipe.send("hello"); });
+
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(poller.has_input(pipe.file_descriptor()));
+	producer.join();
+
+	BOOST_CHECK(pipe.receive(text, true));
+	BOOST_CHECK_EQUAL("hello", text);
+
+	// draining parks again and clears the wake up
+	BOOST_CHECK(!pipe.receive(text, true));
+	BOOST_CHECK(!poller.poll(0));
+
+	// no wake up needed while the consumer is not parked
+	BOOST_CHECK(pipe.send("again"));
+	BOOST_CHECK(poller.poll(0));
+	BOOST_CHECK(pipe.receive(text, true));
+	BOOST_CHECK(pipe.send("more"));
+	BOOST_CHECK(pipe.receive(text, true));
+	BOOST_CHECK_EQUAL("more", text);
+	BOOST_CHECK(!pipe.receive(text, true));
+	BOOST_CHECK(!poller.poll(0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,294 @@
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/epoll_poller.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/socket.hpp"
+
+#ifdef ZMQPP_HAVE_EPOLL
+
+BOOST_AUTO_TEST_SUITE( epoll_poll )
+
+const int max_poll_timeout = 100;
+
+BOOST_AUTO_TEST_CASE( initialise )
+{
+	zmqpp::context context;
+
+	zmqpp::socket socket(context, zmqpp::socket_type::pull);
+	socket.bind("inproc://test");
+
+	zmqpp::epoll_poller poller;
+	poller.add(socket);
+
+	BOOST_CHECK_EQUAL(1, poller.size());
+	BOOST_CHECK_EQUAL(zmqpp::poller::POLL_NONE, poller.events(socket));
+	BOOST_CHECK(!poller.has_input(socket));
+	BOOST_CHECK(!poller.poll(0));
+	BOOST_CHECK(!poller.poll(10));
+}
+
+BOOST_AUTO_TEST_CASE( simple_pull_push )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	zmqpp::epoll_poller poller;
+	zmqpp::epoll_poller::handle item = poller.add(puller);
+	BOOST_CHECK(!poller.poll(0));
+
+	BOOST_CHECK(pusher.send("hello world!"));
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+
+	BOOST_CHECK_EQUAL(zmqpp::poller::POLL_IN, poller.events(puller));
+	BOOST_CHECK(poller.has_input(item));
+	BOOST_REQUIRE_EQUAL(1, poller.ready().size());
+	BOOST_CHECK(item == poller.ready()[0]);
+
+	std::string message;
+	BOOST_CHECK(puller.receive(message));
+	BOOST_CHECK_EQUAL("hello world!", message);
+
+	BOOST_CHECK(!poller.poll(0));
+	BOOST_CHECK(!poller.has_input(puller));
+}
+
+BOOST_AUTO_TEST_CASE( unread_input_is_reported_again )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	zmqpp::epoll_poller poller;
+	poller.add(puller);
+
+	BOOST_CHECK(pusher.send("first"));
+	BOOST_CHECK(pusher.send("second"));
+
+	// the edge triggered descriptor will not signal again for messages already queued
+	std::string message;
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(puller.receive(message));
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(puller.receive(message));
+	BOOST_CHECK_EQUAL("second", message);
+	BOOST_CHECK(!poller.poll(0));
+}
+
+BOOST_AUTO_TEST_CASE( only_active_sockets_reported )
+{
+	zmqpp::context context;
+
+	const size_t idle_count = 200;
+	std::vector<std::unique_ptr<zmqpp::socket>> idle;
+	zmqpp::epoll_poller poller;
+
+	for(size_t i = 0; i < idle_count; ++i)
+	{
+		idle.push_back(std::unique_ptr<zmqpp::socket>(new zmqpp::socket(context, zmqpp::socket_type::pull)));
+		idle.back()->bind("inproc://idle" + std::to_string(i));
+		poller.add(*idle.back());
+	}
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+	poller.add(puller);
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	BOOST_CHECK(!poller.poll(0));
+	BOOST_CHECK(pusher.send("hello world!"));
+
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK_EQUAL(1, poller.ready().size());
+	BOOST_CHECK(poller.has_input(puller));
+	BOOST_CHECK(!poller.has_input(*idle.front()));
+}
+
+BOOST_AUTO_TEST_CASE( used_socket_found_without_recheck )
+{
+	zmqpp::context context;
+
+	zmqpp::socket server(context, zmqpp::socket_type::router);
+	server.bind("inproc://test");
+
+	zmqpp::socket client(context, zmqpp::socket_type::dealer);
+	client.connect("inproc://test");
+
+	zmqpp::epoll_poller poller;
+	zmqpp::epoll_poller manual(zmqpp::epoll_poller::recheck_mode::manual);
+	poller.add(client);
+	manual.add(client);
+	BOOST_CHECK(!poller.poll(0));
+	BOOST_CHECK(!manual.poll(0));
+
+	BOOST_CHECK(client.send("first"));
+	zmqpp::message request;
+	BOOST_REQUIRE(server.receive(request));
+	BOOST_CHECK(server.send(request));
+
+	// using the socket processes its commands, which swallows the edge for the reply
+	BOOST_CHECK(client.send("second"));
+	client.get<int>(zmqpp::socket_option::events);
+
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(poller.has_input(client));
+
+	manual.recheck(client);
+	BOOST_CHECK(manual.poll(max_poll_timeout));
+	BOOST_CHECK(manual.has_input(client));
+}
+
+BOOST_AUTO_TEST_CASE( check_for_output )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	zmqpp::epoll_poller poller;
+	poller.add(pusher, zmqpp::poller::POLL_NONE);
+	BOOST_CHECK(!poller.poll(0));
+
+	poller.check_for(pusher, zmqpp::poller::POLL_OUT);
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(poller.has_output(pusher));
+}
+
+BOOST_AUTO_TEST_CASE( file_descriptors )
+{
+	int descriptors[2];
+	BOOST_REQUIRE_EQUAL(0, pipe(descriptors));
+
+	zmqpp::epoll_poller poller;
+	poller.add(descriptors[0]);
+	BOOST_CHECK(!poller.poll(0));
+
+	BOOST_CHECK_EQUAL(1, write(descriptors[1], "x", 1));
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(poller.has_input(descriptors[0]));
+
+	// level triggered, still readable until read
+	BOOST_CHECK(poller.poll(0));
+
+	poller.check_for(descriptors[0], zmqpp::poller::POLL_NONE);
+	BOOST_CHECK(!poller.poll(0));
+
+	close(descriptors[1]);
+	poller.check_for(descriptors[0], zmqpp::poller::POLL_IN | zmqpp::poller::POLL_ERROR);
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+
+	poller.remove(descriptors[0]);
+	BOOST_CHECK_EQUAL(0, poller.size());
+	close(descriptors[0]);
+}
+
+BOOST_AUTO_TEST_CASE( remove_socket )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller1(context, zmqpp::socket_type::pull);
+	puller1.bind("inproc://test1");
+
+	zmqpp::socket puller2(context, zmqpp::socket_type::pull);
+	puller2.bind("inproc://test2");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test1");
+
+	zmqpp::epoll_poller poller;
+	zmqpp::epoll_poller::handle first = poller.add(puller1);
+	zmqpp::epoll_poller::handle second = poller.add(puller2);
+
+	BOOST_CHECK(pusher.send("hello world!"));
+	poller.remove(puller1);
+
+	BOOST_CHECK_EQUAL(1, poller.size());
+	BOOST_CHECK(!poller.find(puller1).valid());
+	BOOST_CHECK(poller.find(puller2) == second);
+	BOOST_CHECK_THROW(poller.events(first), zmqpp::exception);
+	BOOST_CHECK_THROW(poller.remove(puller1), zmqpp::exception);
+	BOOST_CHECK(!poller.poll(0));
+
+	BOOST_CHECK(poller.add(puller1) == first);
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(poller.has_input(puller1));
+}
+
+void ignore_signal(int)
+{
+}
+
+BOOST_AUTO_TEST_CASE( signal_does_not_end_poll )
+{
+	zmqpp::context context;
+
+	zmqpp::socket socket(context, zmqpp::socket_type::pull);
+	socket.bind("inproc://test");
+
+	struct sigaction action, previous;
+	std::memset(&action, 0, sizeof(action));
+	action.sa_handler = &ignore_signal;
+	sigemptyset(&action.sa_mask);
+	BOOST_REQUIRE_EQUAL(0, sigaction(SIGUSR1, &action, &previous));
+
+	zmqpp::epoll_poller poller;
+	poller.add(socket);
+
+	pthread_t polling = pthread_self();
+	std::thread interrupt([polling]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		pthread_kill(polling, SIGUSR1);
+	});
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	BOOST_CHECK_NO_THROW(BOOST_CHECK(!poller.poll(max_poll_timeout)));
+	long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	BOOST_CHECK(elapsed >= max_poll_timeout - 1);
+
+	interrupt.join();
+	sigaction(SIGUSR1, &previous, nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( throws_exception_unknown_socket )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	zmqpp::epoll_poller poller;
+	poller.add(puller);
+
+	BOOST_CHECK_THROW(poller.events(pusher), zmqpp::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif // ZMQPP_HAVE_EPOLL
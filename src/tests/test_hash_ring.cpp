@@ -0,0 +1,118 @@
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "zmqpp/exception.hpp"
+#include "zmqpp/hash_ring.hpp"
+
+BOOST_AUTO_TEST_SUITE( hash_ring )
+
+std::vector<std::string> owners(zmqpp::hash_ring const& ring, size_t const& keys)
+{
+	std::vector<std::string> owners;
+	for(size_t i = 0; i < keys; ++i)
+	{
+		owners.push_back(ring.find("key" + std::to_string(i)));
+	}
+
+	return owners;
+}
+
+BOOST_AUTO_TEST_CASE( nodes )
+{
+	zmqpp::hash_ring ring;
+	BOOST_CHECK(ring.empty());
+	BOOST_CHECK_THROW(ring.find("key"), zmqpp::exception);
+
+	BOOST_CHECK(ring.add("a"));
+	BOOST_CHECK(!ring.add("a"));
+	BOOST_CHECK(ring.add("b"));
+	BOOST_CHECK_EQUAL(2, ring.size());
+	BOOST_CHECK(ring.contains("a"));
+
+	BOOST_CHECK(ring.remove("a"));
+	BOOST_CHECK(!ring.remove("a"));
+	BOOST_CHECK(!ring.contains("a"));
+	BOOST_CHECK_EQUAL("b", ring.find("anything"));
+
+	// the same nodes map keys the same way whatever order they were added in
+	zmqpp::hash_ring first;
+	zmqpp::hash_ring second;
+	first.add("x");
+	first.add("y");
+	first.add("z");
+	second.add("z");
+	second.add("x");
+	second.add("y");
+	BOOST_CHECK(owners(first, 1000) == owners(second, 1000));
+}
+
+BOOST_AUTO_TEST_CASE( even_spread )
+{
+	zmqpp::hash_ring ring;
+	for(int i = 0; i < 4; ++i)
+	{
+		ring.add("worker-" + std::to_string(i));
+	}
+
+	std::map<std::string, size_t> counts;
+	std::vector<std::string> mapped = owners(ring, 20000);
+	for(size_t i = 0; i < mapped.size(); ++i)
+	{
+		++counts[mapped[i]];
+	}
+
+	BOOST_REQUIRE_EQUAL(4, counts.size());
+	for(auto it = counts.begin(); it != counts.end(); ++it)
+	{
+		BOOST_CHECK((*it).second > 3000);
+		BOOST_CHECK((*it).second < 7000);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( minimal_movement )
+{
+	zmqpp::hash_ring ring;
+	for(int i = 0; i < 4; ++i)
+	{
+		ring.add("worker-" + std::to_string(i));
+	}
+
+	std::vector<std::string> before = owners(ring, 10000);
+
+	ring.add("worker-4");
+	std::vector<std::string> after = owners(ring, 10000);
+
+	size_t moved = 0;
+	for(size_t i = 0; i < before.size(); ++i)
+	{
+		if (before[i] != after[i])
+		{
+			// only ever to the new node
+			BOOST_CHECK_EQUAL("worker-4", after[i]);
+			++moved;
+		}
+	}
+
+	// about a fifth of the keys should move
+	BOOST_CHECK(moved > 1000);
+	BOOST_CHECK(moved < 3000);
+
+	ring.remove("worker-4");
+	BOOST_CHECK(before == owners(ring, 10000));
+
+	// removing a node only moves that node's keys
+	ring.remove("worker-2");
+	after = owners(ring, 10000);
+	for(size_t i = 0; i < before.size(); ++i)
+	{
+		if ("worker-2" != before[i])
+		{
+			BOOST_CHECK_EQUAL(before[i], after[i]);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
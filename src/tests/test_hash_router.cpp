@@ -0,0 +1,115 @@
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/hash_router.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( hash_router )
+
+const int max_poll_timeout = 1000;
+
+BOOST_AUTO_TEST_CASE( requires_router )
+{
+	zmqpp::context context;
+	zmqpp::socket socket(context, zmqpp::socket_type::dealer);
+
+	BOOST_CHECK_THROW(zmqpp::hash_router router(socket), zmqpp::exception);
+}
+
+BOOST_AUTO_TEST_CASE( sticky_routing )
+{
+	zmqpp::context context;
+
+	zmqpp::socket socket(context, zmqpp::socket_type::router);
+	socket.bind("inproc://test");
+
+	zmqpp::hash_router router(socket, 1);
+	zmqpp::message message;
+	message << "header" << "key";
+	BOOST_CHECK_THROW(router.route(message), zmqpp::exception);
+
+	std::vector<std::unique_ptr<zmqpp::socket>> peers;
+	for(int i = 0; i < 3; ++i)
+	{
+		peers.push_back(std::unique_ptr<zmqpp::socket>(new zmqpp::socket(context, zmqpp::socket_type::dealer)));
+		peers.back()->set(zmqpp::socket_option::identity, "peer-" + std::to_string(i));
+		peers.back()->connect("inproc://test");
+		peers.back()->send(zmqpp::hash_router::join_signal);
+	}
+
+	// a normal message from a peer is passed back with its identity
+	peers[0]->send("hello");
+
+	zmqpp::message received;
+	BOOST_REQUIRE(router.receive(received));
+	BOOST_REQUIRE_EQUAL(2, received.parts());
+	BOOST_CHECK_EQUAL("peer-0", received.get(0));
+	BOOST_CHECK_EQUAL("hello", received.get(1));
+	BOOST_CHECK_EQUAL(3, router.peers());
+
+	zmqpp::message missing_key;
+	missing_key << "header";
+	BOOST_CHECK_THROW(router.route(missing_key), zmqpp::exception);
+
+	std::map<std::string, std::string> expected;
+	for(int i = 0; i < 30; ++i)
+	{
+		std::string key = "key" + std::to_string(i % 10);
+		expected[key] = router.peer_for(key);
+
+		zmqpp::message request;
+		request << "header" << key;
+		BOOST_REQUIRE(router.route(request));
+	}
+
+	// every peer gets only its own keys
+	size_t total = 0;
+	for(size_t i = 0; i < peers.size(); ++i)
+	{
+		zmqpp::poller poller;
+		poller.add(*peers[i]);
+
+		while(poller.poll(50))
+		{
+			zmqpp::message request;
+			peers[i]->receive(request);
+			BOOST_REQUIRE_EQUAL(2, request.parts());
+			BOOST_CHECK_EQUAL("peer-" + std::to_string(i), expected[request.get(1)]);
+			++total;
+		}
+	}
+	BOOST_CHECK_EQUAL(30, total);
+
+	// after a peer leaves its keys go elsewhere and the rest stay put
+	peers[1]->send(zmqpp::hash_router::leave_signal);
+	peers[2]->send("after leave");
+	received = zmqpp::message();
+	BOOST_REQUIRE(router.receive(received));
+	BOOST_CHECK_EQUAL(2, router.peers());
+
+	for(auto it = expected.begin(); it != expected.end(); ++it)
+	{
+		std::string const& owner = router.peer_for((*it).first);
+		BOOST_CHECK("peer-1" != owner);
+		if ("peer-1" != (*it).second)
+		{
+			BOOST_CHECK_EQUAL((*it).second, owner);
+		}
+	}
+
+	zmqpp::hash_router::statistics stats = router.stats();
+	BOOST_CHECK_EQUAL(30, stats.routed);
+	BOOST_CHECK_EQUAL(2, stats.received);
+	BOOST_CHECK_EQUAL(3, stats.joins);
+	BOOST_CHECK_EQUAL(1, stats.leaves);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <string>
+#include <thread>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/last_value_cache.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( last_value_cache )
+
+const int max_poll_timeout = 1000;
+
+void publish(zmqpp::socket& publisher, std::string const& topic, std::string const& value)
+{
+	zmqpp::message message;
+	message << topic << value;
+	publisher.send(message);
+}
+
+// Collect the latest value per topic until expecting have arrived, polling the cache meanwhile
+std::map<std::string, std::string> collect(zmqpp::last_value_cache& cache, zmqpp::socket& subscriber, size_t const& expecting)
+{
+	zmqpp::poller poller;
+	poller.add(subscriber);
+
+	std::map<std::string, std::string> values;
+	for(int attempt = 0; (attempt < 100) && (values.size() < expecting); ++attempt)
+	{
+		cache.poll(10);
+		while(poller.poll(0))
+		{
+			zmqpp::message message;
+			subscriber.receive(message);
+			BOOST_REQUIRE_EQUAL(2, message.parts());
+			values[message.get(0)] = message.get(1);
+		}
+	}
+
+	return values;
+}
+
+BOOST_AUTO_TEST_CASE( requires_xpub_backend )
+{
+	zmqpp::context context;
+	zmqpp::socket frontend(context, zmqpp::socket_type::xsubscribe);
+	zmqpp::socket backend(context, zmqpp::socket_type::publish);
+
+	BOOST_CHECK_THROW(zmqpp::last_value_cache cache(frontend, backend), zmqpp::exception);
+	BOOST_CHECK_THROW(zmqpp::last_value_cache cache(backend, frontend), zmqpp::exception);
+}
+
+BOOST_AUTO_TEST_CASE( late_joiners_get_current_values )
+{
+	zmqpp::context context;
+
+	zmqpp::socket publisher(context, zmqpp::socket_type::publish);
+	publisher.bind("inproc://feed");
+
+	zmqpp::socket frontend(context, zmqpp::socket_type::xsubscribe);
+	frontend.connect("inproc://feed");
+
+	zmqpp::socket backend(context, zmqpp::socket_type::xpublish);
+	backend.bind("inproc://cache");
+
+	zmqpp::last_value_cache cache(frontend, backend);
+
+	// the cache's subscription takes a moment to reach the publisher
+	for(int attempt = 0; (attempt < 100) && !cache.contains("sync"); ++attempt)
+	{
+		publish(publisher, "sync", "");
+		cache.poll(10);
+	}
+	BOOST_REQUIRE(cache.contains("sync"));
+
+	publish(publisher, "price.a", "1");
+	publish(publisher, "price.a", "2");
+	publish(publisher, "price.b", "5");
+	publish(publisher, "volume.a", "100");
+	while(cache.stats().topics < 4)
+	{
+		BOOST_REQUIRE(cache.poll(max_poll_timeout));
+	}
+
+	// nothing more is published, the values come from the cache alone
+	zmqpp::socket prices(context, zmqpp::socket_type::subscribe);
+	prices.connect("inproc://cache");
+	prices.subscribe("price.");
+
+	std::map<std::string, std::string> values = collect(cache, prices, 2);
+	BOOST_CHECK_EQUAL(2, values.size());
+	BOOST_CHECK_EQUAL("2", values["price.a"]);
+	BOOST_CHECK_EQUAL("5", values["price.b"]);
+
+	zmqpp::socket everything(context, zmqpp::socket_type::subscribe);
+	everything.connect("inproc://cache");
+	everything.subscribe("");
+
+	values = collect(cache, everything, 4);
+	BOOST_CHECK_EQUAL(4, values.size());
+	BOOST_CHECK_EQUAL("100", values["volume.a"]);
+
+	// live updates still flow through and replace the cached value
+	publish(publisher, "price.a", "3");
+	values = collect(cache, prices, 1);
+	BOOST_CHECK_EQUAL("3", values["price.a"]);
+
+	zmqpp::last_value_cache::statistics stats = cache.stats();
+	BOOST_CHECK_EQUAL(4, stats.topics);
+	BOOST_CHECK(stats.subscriptions >= 2);
+	BOOST_CHECK(stats.replayed >= 6);
+}
+
+BOOST_AUTO_TEST_CASE( run_until_stopped )
+{
+	zmqpp::context context;
+
+	zmqpp::socket frontend(context, zmqpp::socket_type::subscribe);
+	zmqpp::socket backend(context, zmqpp::socket_type::xpublish);
+	zmqpp::last_value_cache cache(frontend, backend);
+
+	std::thread thread(&zmqpp::last_value_cache::run, &cache);
+	cache.stop();
+	thread.join();
+
+	BOOST_CHECK_EQUAL(0, cache.stats().updates);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,154 @@
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/pipeline.hpp"
+
+BOOST_AUTO_TEST_SUITE( pipeline )
+
+void square(zmqpp::message& task, zmqpp::message& result)
+{
+	int number;
+	task >> number;
+
+	// uneven work so results finish out of order
+	if (0 == number % 7)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+
+	result << number * number;
+}
+
+BOOST_AUTO_TEST_CASE( unordered_results )
+{
+	zmqpp::context context;
+	zmqpp::pipeline pipeline(context, &square, 4);
+	BOOST_CHECK_EQUAL(4, pipeline.workers());
+
+	std::thread feeder([&pipeline]() {
+		for(int i = 0; i < 1000; ++i)
+		{
+			zmqpp::message task;
+			task << i;
+			pipeline.submit(task);
+		}
+	});
+
+	std::set<int> results;
+	std::set<uint64_t> sequences;
+	for(int i = 0; i < 1000; ++i)
+	{
+		zmqpp::message result;
+		uint64_t sequence;
+		BOOST_REQUIRE(pipeline.receive(result, sequence));
+
+		int number;
+		result >> number;
+		results.insert(number);
+		sequences.insert(sequence);
+	}
+	feeder.join();
+
+	BOOST_CHECK_EQUAL(1000, results.size());
+	BOOST_CHECK_EQUAL(1000, sequences.size());
+	BOOST_CHECK_EQUAL(1, results.count(999 * 999));
+
+	zmqpp::message none;
+	BOOST_CHECK(!pipeline.receive(none, true));
+
+	zmqpp::pipeline::statistics stats = pipeline.stats();
+	BOOST_CHECK_EQUAL(1000, stats.submitted);
+	BOOST_CHECK_EQUAL(1000, stats.processed);
+	BOOST_CHECK_EQUAL(1000, stats.delivered);
+	BOOST_CHECK_EQUAL(0, stats.queued);
+	BOOST_CHECK(stats.seconds > 0);
+}
+
+BOOST_AUTO_TEST_CASE( sequenced_results )
+{
+	zmqpp::context context;
+	zmqpp::pipeline pipeline(context, &square, 4, zmqpp::pipeline::ordering::sequenced);
+
+	// small enough to submit everything before receiving
+	for(int i = 0; i < 200; ++i)
+	{
+		zmqpp::message task;
+		task << i;
+		BOOST_REQUIRE(pipeline.submit(task));
+	}
+
+	for(int i = 0; i < 200; ++i)
+	{
+		zmqpp::message result;
+		uint64_t sequence;
+		BOOST_REQUIRE(pipeline.receive(result, sequence));
+		BOOST_CHECK_EQUAL(i, sequence);
+
+		int number;
+		result >> number;
+		BOOST_CHECK_EQUAL(i * i, number);
+	}
+
+	zmqpp::pipeline::statistics stats = pipeline.stats();
+	BOOST_CHECK_EQUAL(200, stats.delivered);
+	BOOST_CHECK_EQUAL(0, stats.held);
+}
+
+BOOST_AUTO_TEST_CASE( failed_work_keeps_order )
+{
+	zmqpp::context context;
+	zmqpp::pipeline pipeline(context, [](zmqpp::message& task, zmqpp::message& result) {
+		int number;
+		task >> number;
+		if (number == 3)
+		{
+			throw std::runtime_error("bad task");
+		}
+		result << number;
+	}, 2, zmqpp::pipeline::ordering::sequenced);
+
+	for(int i = 0; i < 6; ++i)
+	{
+		zmqpp::message task;
+		task << i;
+		pipeline.submit(task);
+	}
+
+	for(int i = 0; i < 6; ++i)
+	{
+		zmqpp::message result;
+		BOOST_REQUIRE(pipeline.receive(result));
+		BOOST_CHECK_EQUAL((3 == i) ? 0 : 1, result.parts());
+	}
+
+	BOOST_CHECK_EQUAL(1, pipeline.stats().failed);
+}
+
+BOOST_AUTO_TEST_CASE( stops_with_unreceived_results )
+{
+	zmqpp::context context;
+	zmqpp::pipeline pipeline(context, [](zmqpp::message& task, zmqpp::message& result) {
+		result.add(task.raw_data(0), task.size(0));
+	}, 2);
+
+	// fill the high water marks then let the destructor stop the blocked
+	// workers, the first submit waits for a worker to connect
+	std::string payload(1024, 'x');
+	zmqpp::message task;
+	task << payload;
+	BOOST_REQUIRE(pipeline.submit(task));
+	task << payload;
+	while(pipeline.submit(task, true))
+	{
+		task << payload;
+	}
+
+	BOOST_CHECK(pipeline.stats().submitted > 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,10 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
+
+#include <unistd.h>
+
 #include "zmqpp/context.hpp"
 #include "zmqpp/message.hpp"
 #include "zmqpp/poller.hpp"
@@ -103,6 +107,217 @@ BOOST_AUTO_TEST_CASE( multi_socket_poll )
 	BOOST_CHECK(!puller1.has_more_parts());
 }
 
+BOOST_AUTO_TEST_CASE( remove_socket )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller1(context, zmqpp::socket_type::pull);
+	puller1.bind("inproc://test1");
+
+	zmqpp::socket puller2(context, zmqpp::socket_type::pull);
+	puller2.bind("inproc://test2");
+
+	zmqpp::socket puller3(context, zmqpp::socket_type::pull);
+	puller3.bind("inproc://test3");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test3");
+
+	BOOST_CHECK(pusher.send("hello world!"));
+
+	zmqpp::poller poller;
+	poller.add(puller1);
+	poller.add(puller2);
+	poller.add(puller3);
+
+	poller.remove(puller1);
+	BOOST_CHECK_EQUAL(2, poller.size());
+	BOOST_CHECK(!poller.find(puller1).valid());
+	BOOST_CHECK_THROW(poller.events(puller1), zmqpp::exception);
+	BOOST_CHECK_THROW(poller.remove(puller1), zmqpp::exception);
+
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(!poller.has_input(puller2));
+	BOOST_CHECK(poller.has_input(puller3));
+}
+
+BOOST_AUTO_TEST_CASE( remove_file_descriptor )
+{
+	zmqpp::poller poller;
+	poller.add(0);
+	poller.add(1);
+
+	poller.remove(0);
+	BOOST_CHECK_EQUAL(1, poller.size());
+	BOOST_CHECK_EQUAL(1, poller.raw_item(0).fd);
+	BOOST_CHECK(!poller.find(0).valid());
+	BOOST_CHECK(poller.find(1).valid());
+	BOOST_CHECK_THROW(poller.remove(0), zmqpp::exception);
+}
+
+BOOST_AUTO_TEST_CASE( handles_survive_removal )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller1(context, zmqpp::socket_type::pull);
+	puller1.bind("inproc://test1");
+
+	zmqpp::socket puller2(context, zmqpp::socket_type::pull);
+	puller2.bind("inproc://test2");
+
+	zmqpp::socket puller3(context, zmqpp::socket_type::pull);
+	puller3.bind("inproc://test3");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test3");
+
+	BOOST_CHECK(pusher.send("hello world!"));
+
+	zmqpp::poller poller;
+	zmqpp::poller::handle first = poller.add(puller1);
+	zmqpp::poller::handle second = poller.add(puller2);
+	zmqpp::poller::handle third = poller.add(puller3);
+
+	BOOST_CHECK(first.valid());
+	BOOST_CHECK(first != second);
+	BOOST_CHECK(poller.find(puller2) == second);
+
+	// the last item is moved into the gap, its handle must still work
+	poller.remove(first);
+	BOOST_CHECK(third == poller.raw_handle(0));
+	BOOST_CHECK_THROW(poller.events(first), zmqpp::exception);
+
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(poller.has_input(third));
+	BOOST_CHECK(!poller.has_input(second));
+
+	poller.check_for(third, zmqpp::poller::POLL_NONE);
+	BOOST_CHECK(!poller.poll(0));
+
+	// freed slots are reused
+	zmqpp::poller::handle again = poller.add(puller1);
+	BOOST_CHECK(again == first);
+	BOOST_CHECK_EQUAL(zmqpp::poller::POLL_NONE, poller.events(again));
+}
+
+BOOST_AUTO_TEST_CASE( spin_finds_queued_input )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	BOOST_CHECK(pusher.send("hello world!"));
+
+	zmqpp::poller poller;
+	poller.add(puller);
+	poller.set_spin(1000000);
+
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(poller.has_input(puller));
+	BOOST_CHECK_EQUAL(1, poller.stats().polls);
+	BOOST_CHECK_EQUAL(1, poller.stats().spin_hits);
+	BOOST_CHECK_EQUAL(0, poller.stats().blocking_polls);
+	BOOST_CHECK_EQUAL(1, poller.stats().spin_iterations);
+
+	std::string message;
+	BOOST_CHECK(puller.receive(message));
+	BOOST_CHECK_EQUAL("hello world!", message);
+}
+
+BOOST_AUTO_TEST_CASE( spin_reports_ready_descriptors )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	int pipes[2];
+	BOOST_REQUIRE_EQUAL(0, pipe(pipes));
+	BOOST_REQUIRE_EQUAL(1, write(pipes[1], "x", 1));
+
+	zmqpp::poller poller;
+	poller.add(puller);
+	poller.add(pipes[0]);
+	poller.set_spin(1000000);
+
+	// the socket stays busy, the pipe still has to be seen
+	for(int i = 0; i < 3; ++i)
+	{
+		BOOST_CHECK(pusher.send("busy"));
+		BOOST_CHECK(poller.poll(max_poll_timeout));
+		BOOST_CHECK(poller.has_input(puller));
+		BOOST_CHECK(poller.has_input(pipes[0]));
+
+		std::string message;
+		BOOST_CHECK(puller.receive(message));
+	}
+	BOOST_CHECK_EQUAL(3, poller.stats().spin_hits);
+	BOOST_CHECK_EQUAL(0, poller.stats().blocking_polls);
+
+	close(pipes[0]);
+	close(pipes[1]);
+}
+
+BOOST_AUTO_TEST_CASE( spin_falls_back_to_blocking )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::poller poller;
+	poller.add(puller);
+	poller.set_spin(0, 10);
+
+	BOOST_CHECK(!poller.poll(10));
+	BOOST_CHECK(!poller.has_input(puller));
+	BOOST_CHECK_EQUAL(0, poller.stats().spin_hits);
+	BOOST_CHECK_EQUAL(1, poller.stats().blocking_polls);
+	BOOST_CHECK_EQUAL(10, poller.stats().spin_iterations);
+
+	// a zero timeout never spins
+	BOOST_CHECK(!poller.poll(0));
+	BOOST_CHECK_EQUAL(10, poller.stats().spin_iterations);
+	BOOST_CHECK_EQUAL(2, poller.stats().blocking_polls);
+
+	poller.reset_stats();
+	BOOST_CHECK_EQUAL(0, poller.stats().polls);
+	BOOST_CHECK_EQUAL(0, poller.stats().blocking_polls);
+
+	// disabled by default
+	poller.set_spin(0, 0);
+	BOOST_CHECK(!poller.poll(1));
+	BOOST_CHECK_EQUAL(0, poller.stats().spin_iterations);
+}
+
+BOOST_AUTO_TEST_CASE( spin_limited_by_timeout )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::poller poller;
+	poller.add(puller);
+	poller.set_spin(10000000000ULL);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	BOOST_CHECK(!poller.poll(20));
+	long taken = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+	BOOST_CHECK(taken >= 20);
+	BOOST_CHECK(taken < 1000);
+	BOOST_CHECK_EQUAL(1, poller.stats().blocking_polls);
+	BOOST_CHECK(poller.stats().spin_iterations > 0);
+}
+
 BOOST_AUTO_TEST_CASE( throws_exception_unknown_socket )
 {
 	zmqpp::context context;
@@ -0,0 +1,181 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <thread>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/proxy.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( proxy )
+
+const int max_poll_timeout = 1000;
+
+BOOST_AUTO_TEST_CASE( invalid_pairs )
+{
+	zmqpp::context context;
+
+	zmqpp::socket pull(context, zmqpp::socket_type::pull);
+	zmqpp::socket push(context, zmqpp::socket_type::push);
+	zmqpp::socket pub(context, zmqpp::socket_type::publish);
+	zmqpp::socket router(context, zmqpp::socket_type::router);
+	zmqpp::socket other_router(context, zmqpp::socket_type::router);
+	zmqpp::socket dealer(context, zmqpp::socket_type::dealer);
+	zmqpp::socket other_dealer(context, zmqpp::socket_type::dealer);
+
+	BOOST_CHECK_THROW(zmqpp::proxy(router, other_router), zmqpp::exception);
+	BOOST_CHECK_THROW(zmqpp::proxy(dealer, other_dealer), zmqpp::exception);
+	BOOST_CHECK_THROW(zmqpp::proxy(push, pull), zmqpp::exception);
+	BOOST_CHECK_THROW(zmqpp::proxy(pub, pull), zmqpp::exception);
+	BOOST_CHECK_THROW(zmqpp::proxy(router, push), zmqpp::exception);
+	BOOST_CHECK_THROW(zmqpp::proxy(pull, push, 0), zmqpp::exception);
+}
+
+BOOST_AUTO_TEST_CASE( pipeline_with_capture )
+{
+	zmqpp::context context;
+
+	zmqpp::socket frontend(context, zmqpp::socket_type::pull);
+	frontend.bind("inproc://frontend");
+	zmqpp::socket backend(context, zmqpp::socket_type::push);
+	backend.bind("inproc://backend");
+	zmqpp::socket capture(context, zmqpp::socket_type::push);
+	capture.bind("inproc://capture");
+
+	zmqpp::socket producer(context, zmqpp::socket_type::push);
+	producer.connect("inproc://frontend");
+	zmqpp::socket consumer(context, zmqpp::socket_type::pull);
+	consumer.connect("inproc://backend");
+	zmqpp::socket listener(context, zmqpp::socket_type::pull);
+	listener.connect("inproc://capture");
+
+	zmqpp::proxy proxy(frontend, backend, 2);
+	proxy.set_capture(&capture);
+
+	const int count = 5;
+	for(int i = 0; i < count; ++i)
+	{
+		zmqpp::message message;
+		message << "part" << i;
+		producer.send(message);
+	}
+
+	int forwarded = 0;
+	while((forwarded < count) && proxy.poll(max_poll_timeout))
+	{
+		forwarded = proxy.stats(zmqpp::proxy::direction::frontend_to_backend).messages;
+	}
+
+	zmqpp::proxy::statistics stats = proxy.stats(zmqpp::proxy::direction::frontend_to_backend);
+	BOOST_CHECK_EQUAL(count, stats.messages);
+	BOOST_CHECK_EQUAL(count * 2, stats.frames);
+	BOOST_CHECK_EQUAL(count * (4 + sizeof(int)), stats.bytes);
+	BOOST_CHECK(stats.batches >= 3);
+	BOOST_CHECK_EQUAL(0, proxy.stats(zmqpp::proxy::direction::backend_to_frontend).messages);
+
+	for(int i = 0; i < count; ++i)
+	{
+		zmqpp::message message;
+		BOOST_REQUIRE(consumer.receive(message));
+		std::string text;
+		int value = -1;
+		message >> text >> value;
+		BOOST_CHECK_EQUAL("part", text);
+		BOOST_CHECK_EQUAL(i, value);
+
+		zmqpp::message captured;
+		BOOST_REQUIRE(listener.receive(captured));
+		BOOST_CHECK_EQUAL(2, captured.parts());
+	}
+}
+
+BOOST_AUTO_TEST_CASE( request_reply_through_broker )
+{
+	zmqpp::context context;
+
+	zmqpp::socket frontend(context, zmqpp::socket_type::router);
+	frontend.bind("inproc://frontend");
+	zmqpp::socket backend(context, zmqpp::socket_type::dealer);
+	backend.bind("inproc://backend");
+
+	zmqpp::proxy proxy(frontend, backend);
+	std::thread broker([&proxy]() { proxy.run(); });
+
+	zmqpp::socket worker(context, zmqpp::socket_type::reply);
+	worker.connect("inproc://backend");
+	zmqpp::socket client(context, zmqpp::socket_type::request);
+	client.connect("inproc://frontend");
+
+	BOOST_CHECK(client.send("hello"));
+
+	zmqpp::poller poller;
+	poller.add(worker);
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+
+	std::string request;
+	BOOST_CHECK(worker.receive(request));
+	BOOST_CHECK_EQUAL("hello", request);
+	BOOST_CHECK(worker.send("world"));
+
+	poller.remove(worker);
+	poller.add(client);
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+
+	std::string reply;
+	BOOST_CHECK(client.receive(reply));
+	BOOST_CHECK_EQUAL("world", reply);
+
+	proxy.stop();
+	broker.join();
+
+	BOOST_CHECK_EQUAL(1, proxy.stats(zmqpp::proxy::direction::frontend_to_backend).messages);
+	BOOST_CHECK_EQUAL(1, proxy.stats(zmqpp::proxy::direction::backend_to_frontend).messages);
+
+	// stopping is final so running again returns straight away
+	proxy.run();
+}
+
+BOOST_AUTO_TEST_CASE( forwards_subscriptions )
+{
+	zmqpp::context context;
+
+	zmqpp::socket frontend(context, zmqpp::socket_type::xsubscribe);
+	frontend.bind("inproc://frontend");
+	zmqpp::socket backend(context, zmqpp::socket_type::xpublish);
+	backend.bind("inproc://backend");
+
+	zmqpp::socket publisher(context, zmqpp::socket_type::publish);
+	publisher.connect("inproc://frontend");
+	zmqpp::socket subscriber(context, zmqpp::socket_type::subscribe);
+	subscriber.connect("inproc://backend");
+	subscriber.subscribe("topic");
+
+	zmqpp::proxy proxy(frontend, backend);
+
+	// the subscription travels upstream to the publisher
+	BOOST_REQUIRE(proxy.poll(max_poll_timeout));
+	BOOST_CHECK_EQUAL(1, proxy.stats(zmqpp::proxy::direction::backend_to_frontend).messages);
+
+	zmqpp::poller poller;
+	poller.add(subscriber);
+
+	std::string text;
+	for(int attempt = 0; (attempt < 100) && text.empty(); ++attempt)
+	{
+		publisher.send("ignored");
+		publisher.send("topic update");
+		proxy.poll(10);
+
+		if (poller.poll(10))
+		{
+			subscriber.receive(text);
+		}
+	}
+
+	BOOST_CHECK_EQUAL("topic update", text);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,188 @@
+#include <boost/test/unit_test.hpp>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/reactor.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( reactor )
+
+const int max_poll_timeout = 100;
+
+BOOST_AUTO_TEST_CASE( initialise )
+{
+	zmqpp::context context;
+
+	zmqpp::socket socket(context, zmqpp::socket_type::pull);
+	socket.bind("inproc://test");
+
+	bool called = false;
+	zmqpp::reactor reactor;
+	reactor.add(socket, [&called](short const&) { called = true; });
+
+	BOOST_CHECK(!reactor.poll(0));
+	BOOST_CHECK(!called);
+}
+
+BOOST_AUTO_TEST_CASE( dispatches_only_ready_sockets )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller1(context, zmqpp::socket_type::pull);
+	puller1.bind("inproc://test1");
+
+	zmqpp::socket puller2(context, zmqpp::socket_type::pull);
+	puller2.bind("inproc://test2");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test2");
+
+	BOOST_CHECK(pusher.send("hello world!"));
+
+	int first_called = 0;
+	int second_called = 0;
+	short second_events = zmqpp::poller::POLL_NONE;
+	std::string received;
+
+	zmqpp::reactor reactor;
+	reactor.add(puller1, [&first_called](short const&) { ++first_called; });
+	reactor.add(puller2, [&](short const& events) {
+		++second_called;
+		second_events = events;
+		puller2.receive(received);
+	});
+
+	BOOST_CHECK(reactor.poll(max_poll_timeout));
+	BOOST_CHECK_EQUAL(0, first_called);
+	BOOST_CHECK_EQUAL(1, second_called);
+	BOOST_CHECK_EQUAL(zmqpp::poller::POLL_IN, second_events);
+	BOOST_CHECK_EQUAL("hello world!", received);
+
+	BOOST_CHECK(!reactor.poll(0));
+	BOOST_CHECK_EQUAL(1, second_called);
+}
+
+BOOST_AUTO_TEST_CASE( check_for_disables_dispatch )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	BOOST_CHECK(pusher.send("hello world!"));
+
+	bool called = false;
+	zmqpp::reactor reactor;
+	reactor.add(puller, [&called](short const&) { called = true; });
+	reactor.check_for(puller, zmqpp::poller::POLL_NONE);
+
+	BOOST_CHECK(!reactor.poll(0));
+	BOOST_CHECK(!called);
+
+	reactor.check_for(puller, zmqpp::poller::POLL_IN);
+	BOOST_CHECK(reactor.poll(max_poll_timeout));
+	BOOST_CHECK(called);
+}
+
+BOOST_AUTO_TEST_CASE( handler_can_add_sockets )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller1(context, zmqpp::socket_type::pull);
+	puller1.bind("inproc://test1");
+
+	zmqpp::socket puller2(context, zmqpp::socket_type::pull);
+	puller2.bind("inproc://test2");
+
+	zmqpp::socket pusher1(context, zmqpp::socket_type::push);
+	pusher1.connect("inproc://test1");
+
+	zmqpp::socket pusher2(context, zmqpp::socket_type::push);
+	pusher2.connect("inproc://test2");
+
+	BOOST_CHECK(pusher1.send("first"));
+	BOOST_CHECK(pusher2.send("second"));
+
+	std::string first, second;
+	zmqpp::reactor reactor;
+	reactor.add(puller1, [&](short const&) {
+		puller1.receive(first);
+		reactor.add(puller2, [&](short const&) { puller2.receive(second); });
+	});
+
+	BOOST_CHECK(reactor.poll(max_poll_timeout));
+	BOOST_CHECK_EQUAL("first", first);
+	BOOST_CHECK_EQUAL("", second);
+
+	BOOST_CHECK(reactor.poll(max_poll_timeout));
+	BOOST_CHECK_EQUAL("second", second);
+}
+
+BOOST_AUTO_TEST_CASE( handler_can_remove_sockets )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller1(context, zmqpp::socket_type::pull);
+	puller1.bind("inproc://test1");
+
+	zmqpp::socket puller2(context, zmqpp::socket_type::pull);
+	puller2.bind("inproc://test2");
+
+	zmqpp::socket pusher1(context, zmqpp::socket_type::push);
+	pusher1.connect("inproc://test1");
+
+	zmqpp::socket pusher2(context, zmqpp::socket_type::push);
+	pusher2.connect("inproc://test2");
+
+	BOOST_CHECK(pusher1.send("first"));
+	BOOST_CHECK(pusher2.send("second"));
+
+	int first_called = 0;
+	int second_called = 0;
+	zmqpp::reactor reactor;
+	reactor.add(puller1, [&](short const&) {
+		++first_called;
+		reactor.remove(puller1);
+		reactor.remove(puller2);
+	});
+	reactor.add(puller2, [&](short const&) { ++second_called; });
+
+	BOOST_CHECK(reactor.poll(max_poll_timeout));
+	BOOST_CHECK_EQUAL(1, first_called);
+	BOOST_CHECK_EQUAL(0, second_called);
+	BOOST_CHECK_EQUAL(0, reactor.get_poller().size());
+	BOOST_CHECK_THROW(reactor.remove(puller1), zmqpp::exception);
+
+	zmqpp::poller::handle item = reactor.add(puller2, [&](short const&) { ++second_called; });
+	BOOST_CHECK(reactor.poll(max_poll_timeout));
+	BOOST_CHECK_EQUAL(1, second_called);
+
+	reactor.remove(item);
+	BOOST_CHECK_EQUAL(0, reactor.get_poller().size());
+}
+
+BOOST_AUTO_TEST_CASE( timers_fire_during_poll )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	int ticks = 0;
+	zmqpp::reactor reactor;
+	reactor.add(puller, [](short const&) { });
+	zmqpp::timer_wheel::timer_id id = reactor.timers().add_repeating(5, [&ticks]() { ++ticks; });
+
+	// blocks until the timer rather than forever
+	BOOST_CHECK(reactor.poll());
+	BOOST_CHECK_EQUAL(1, ticks);
+
+	BOOST_CHECK(reactor.timers().cancel(id));
+	BOOST_CHECK(!reactor.poll(10));
+	BOOST_CHECK_EQUAL(1, ticks);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
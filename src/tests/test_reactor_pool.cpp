@@ -0,0 +1,188 @@
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/reactor.hpp"
+#include "zmqpp/reactor_pool.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( reactor_pool )
+
+const std::chrono::seconds max_wait(5);
+
+BOOST_AUTO_TEST_CASE( initialise )
+{
+	zmqpp::reactor_pool pool(3);
+
+	BOOST_CHECK_EQUAL(3, pool.size());
+	BOOST_CHECK_EQUAL(zmqpp::reactor_pool::not_in_pool, pool.current());
+	BOOST_CHECK_THROW(pool.post(3, [](zmqpp::reactor&) { }), zmqpp::exception);
+}
+
+BOOST_AUTO_TEST_CASE( post_runs_on_requested_thread )
+{
+	zmqpp::reactor_pool pool(4);
+
+	for(size_t thread = 0; thread < pool.size(); ++thread)
+	{
+		std::promise<size_t> ran_on;
+		pool.post(thread, [&pool, &ran_on](zmqpp::reactor&) { ran_on.set_value(pool.current()); });
+
+		std::future<size_t> result = ran_on.get_future();
+		BOOST_REQUIRE(std::future_status::ready == result.wait_for(max_wait));
+		BOOST_CHECK_EQUAL(thread, result.get());
+	}
+}
+
+BOOST_AUTO_TEST_CASE( posts_to_a_thread_keep_order )
+{
+	zmqpp::reactor_pool pool(2);
+
+	const int count = 10000;
+	std::vector<int> seen;
+	std::promise<void> done;
+
+	for(int i = 0; i < count; ++i)
+	{
+		pool.post(1, [&seen, &done, i, count](zmqpp::reactor&) {
+			seen.push_back(i);
+			if (count - 1 == i) { done.set_value(); }
+		});
+	}
+
+	BOOST_REQUIRE(std::future_status::ready == done.get_future().wait_for(max_wait));
+	BOOST_REQUIRE_EQUAL(count, seen.size());
+	for(int i = 0; i < count; ++i)
+	{
+		BOOST_CHECK_EQUAL(i, seen[i]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( submitted_tasks_all_run )
+{
+	zmqpp::reactor_pool pool(4);
+
+	const int count = 10000;
+	std::atomic<int> ran(0);
+	std::promise<void> done;
+
+	for(int i = 0; i < count; ++i)
+	{
+		pool.submit([&ran, &done, count]() {
+			if (count == ++ran) { done.set_value(); }
+		});
+	}
+
+	BOOST_REQUIRE(std::future_status::ready == done.get_future().wait_for(max_wait));
+	BOOST_CHECK_EQUAL(count, ran.load());
+}
+
+BOOST_AUTO_TEST_CASE( idle_threads_steal_work )
+{
+	zmqpp::reactor_pool pool(4);
+
+	const int count = 200;
+	std::atomic<int> ran(0);
+	std::mutex mutex;
+	std::set<size_t> threads;
+	std::promise<void> done;
+
+	// All submitted from one pool thread so any spread is down to stealing
+	pool.post(0, [&](zmqpp::reactor&) {
+		for(int i = 0; i < count; ++i)
+		{
+			pool.submit([&]() {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					threads.insert(pool.current());
+				}
+				if (count == ++ran) { done.set_value(); }
+			});
+		}
+	});
+
+	BOOST_REQUIRE(std::future_status::ready == done.get_future().wait_for(max_wait));
+	BOOST_CHECK(threads.size() > 1);
+}
+
+BOOST_AUTO_TEST_CASE( sockets_owned_by_pool_thread )
+{
+	zmqpp::context context;
+	zmqpp::reactor_pool pool(2);
+
+	std::unique_ptr<zmqpp::socket> puller;
+	std::promise<void> bound;
+	std::promise<std::string> received;
+
+	pool.post(1, [&](zmqpp::reactor& reactor) {
+		puller.reset(new zmqpp::socket(context, zmqpp::socket_type::pull));
+		puller->bind("inproc://test");
+		reactor.add(*puller, [&](short const&) {
+			std::string message;
+			puller->receive(message);
+			received.set_value(message);
+		});
+		bound.set_value();
+	});
+
+	BOOST_REQUIRE(std::future_status::ready == bound.get_future().wait_for(max_wait));
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+	BOOST_CHECK(pusher.send("hello world!"));
+
+	std::future<std::string> result = received.get_future();
+	BOOST_REQUIRE(std::future_status::ready == result.wait_for(max_wait));
+	BOOST_CHECK_EQUAL("hello world!", result.get());
+
+	std::promise<void> closed;
+	pool.post(1, [&](zmqpp::reactor& reactor) {
+		reactor.remove(*puller);
+		puller.reset();
+		closed.set_value();
+	});
+	BOOST_REQUIRE(std::future_status::ready == closed.get_future().wait_for(max_wait));
+}
+
+BOOST_AUTO_TEST_CASE( stop_is_idempotent )
+{
+	zmqpp::reactor_pool pool(2);
+	pool.stop();
+	pool.stop();
+}
+
+BOOST_AUTO_TEST_CASE( stop_drops_queued_jobs )
+{
+	zmqpp::reactor_pool pool(1);
+
+	std::promise<void> started;
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	pool.post(0, [&started, released](zmqpp::reactor&) {
+		started.set_value();
+		released.wait();
+	});
+	BOOST_REQUIRE(std::future_status::ready == started.get_future().wait_for(max_wait));
+
+	std::atomic<bool> ran(false);
+	pool.post(0, [&ran](zmqpp::reactor&) { ran.store(true); });
+
+	// let stop mark the pool stopped while the first job still holds the thread
+	std::thread stopping([&pool]() { pool.stop(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	release.set_value();
+	stopping.join();
+
+	BOOST_CHECK(!ran.load());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
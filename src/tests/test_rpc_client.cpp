@@ -0,0 +1,312 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/rpc_client.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( rpc_client )
+
+const int max_poll_timeout = 1000;
+
+std::vector<zmqpp::message> receive_all(zmqpp::socket& server, size_t const& count)
+{
+	zmqpp::poller poller;
+	poller.add(server);
+
+	std::vector<zmqpp::message> requests;
+	while((requests.size() < count) && poller.poll(max_poll_timeout))
+	{
+		zmqpp::message request;
+		while(server.receive(request, true))
+		{
+			requests.push_back(std::move(request));
+			request = zmqpp::message();
+		}
+	}
+
+	return requests;
+}
+
+BOOST_AUTO_TEST_CASE( requires_dealer )
+{
+	zmqpp::context context;
+	zmqpp::socket socket(context, zmqpp::socket_type::request);
+
+	BOOST_CHECK_THROW(zmqpp::rpc_client client(socket), zmqpp::exception);
+}
+
+BOOST_AUTO_TEST_CASE( window_and_out_of_order_replies )
+{
+	zmqpp::context context;
+
+	zmqpp::socket server(context, zmqpp::socket_type::router);
+	server.bind("inproc://test");
+
+	zmqpp::socket socket(context, zmqpp::socket_type::dealer);
+	socket.connect("inproc://test");
+
+	zmqpp::rpc_client client(socket, 4);
+
+	std::vector<std::string> replies(10);
+	for(int i = 0; i < 10; ++i)
+	{
+		zmqpp::message request;
+		request << std::to_string(i);
+		client.call(request, [&replies, i](zmqpp::rpc_client::status const& outcome, zmqpp::message& reply) {
+			BOOST_CHECK(zmqpp::rpc_client::status::replied == outcome);
+			reply >> replies[i];
+		});
+	}
+	BOOST_CHECK_EQUAL(4, client.in_flight());
+	BOOST_CHECK_EQUAL(6, client.queued());
+
+	size_t finished = 0;
+	while(finished < 10)
+	{
+		std::vector<zmqpp::message> requests = receive_all(server, client.in_flight());
+		BOOST_REQUIRE(!requests.empty());
+
+		// reply in reverse, with the envelope untouched
+		for(auto it = requests.rbegin(); it != requests.rend(); ++it)
+		{
+			BOOST_REQUIRE_EQUAL(4, (*it).parts());
+			std::string body = (*it).get(3);
+			zmqpp::message reply;
+			reply.add((*it).raw_data(0), (*it).size(0));
+			reply.add((*it).raw_data(1), (*it).size(1));
+			reply.add((*it).raw_data(2), (*it).size(2));
+			reply << "reply " + body;
+			server.send(reply);
+		}
+
+		size_t target = finished + requests.size();
+		while(finished < target)
+		{
+			size_t done = client.poll(max_poll_timeout);
+			BOOST_REQUIRE(done > 0);
+			finished += done;
+		}
+	}
+
+	for(int i = 0; i < 10; ++i)
+	{
+		BOOST_CHECK_EQUAL("reply " + std::to_string(i), replies[i]);
+	}
+
+	zmqpp::rpc_client::statistics stats = client.stats();
+	BOOST_CHECK_EQUAL(10, stats.requests);
+	BOOST_CHECK_EQUAL(10, stats.replies);
+	BOOST_CHECK_EQUAL(6, stats.queued);
+	BOOST_CHECK_EQUAL(-1, client.timeout());
+}
+
+BOOST_AUTO_TEST_CASE( timeouts_and_late_replies )
+{
+	zmqpp::context context;
+
+	zmqpp::socket server(context, zmqpp::socket_type::router);
+	server.bind("inproc://test");
+
+	zmqpp::socket socket(context, zmqpp::socket_type::dealer);
+	socket.connect("inproc://test");
+
+	zmqpp::rpc_client client(socket, 1, std::chrono::milliseconds(20));
+
+	std::vector<zmqpp::rpc_client::status> outcomes;
+	auto record = [&outcomes](zmqpp::rpc_client::status const& outcome, zmqpp::message& reply) {
+		outcomes.push_back(outcome);
+		BOOST_CHECK_EQUAL(0, reply.parts());
+	};
+
+	zmqpp::message first;
+	first << "first";
+	client.call(first, record);
+
+	// waits behind the first so times out without ever being sent
+	zmqpp::message second;
+	second << "second";
+	client.call(second, record, std::chrono::milliseconds(5));
+
+	long timeout = client.timeout();
+	BOOST_CHECK(timeout >= 0);
+	BOOST_CHECK(timeout <= 20);
+
+	while(outcomes.size() < 2)
+	{
+		client.poll(max_poll_timeout);
+	}
+	BOOST_CHECK(zmqpp::rpc_client::status::timed_out == outcomes[0]);
+	BOOST_CHECK(zmqpp::rpc_client::status::timed_out == outcomes[1]);
+	BOOST_CHECK_EQUAL(0, client.in_flight());
+	BOOST_CHECK_EQUAL(0, client.queued());
+
+	// answering now is too late
+	std::vector<zmqpp::message> requests = receive_all(server, 1);
+	BOOST_REQUIRE_EQUAL(1, requests.size());
+	server.send(requests[0]);
+
+	zmqpp::poller poller;
+	poller.add(socket);
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+	BOOST_CHECK_EQUAL(0, client.process());
+
+	zmqpp::rpc_client::statistics stats = client.stats();
+	BOOST_CHECK_EQUAL(2, stats.timeouts);
+	BOOST_CHECK_EQUAL(1, stats.late);
+	BOOST_CHECK_EQUAL(0, stats.replies);
+}
+
+BOOST_AUTO_TEST_CASE( unreachable_server_keeps_timing_out )
+{
+	zmqpp::context context;
+
+	// nothing listens here, sent requests pile up in the dealer until it is full
+	zmqpp::socket socket(context, zmqpp::socket_type::dealer);
+	socket.set(zmqpp::socket_option::send_high_water_mark, 8);
+	socket.set(zmqpp::socket_option::receive_high_water_mark, 8);
+	socket.set(zmqpp::socket_option::linger, 0);
+	socket.connect("tcp://127.0.0.1:48153");
+
+	zmqpp::rpc_client client(socket, 4, std::chrono::milliseconds(5));
+
+	size_t timeouts = 0;
+	auto record = [&timeouts](zmqpp::rpc_client::status const& outcome, zmqpp::message&) {
+		BOOST_CHECK(zmqpp::rpc_client::status::timed_out == outcome);
+		++timeouts;
+	};
+
+	size_t const calls = 200;
+	for(size_t i = 0; i < calls; ++i)
+	{
+		zmqpp::message request;
+		request << "request";
+		client.call(request, record);
+		client.poll(1);
+	}
+
+	while((timeouts < calls) && (client.timeout() >= 0))
+	{
+		client.poll(max_poll_timeout);
+	}
+
+	BOOST_CHECK_EQUAL(calls, timeouts);
+	BOOST_CHECK_EQUAL(0, client.in_flight());
+	BOOST_CHECK_EQUAL(0, client.queued());
+	BOOST_CHECK(client.stats().queued > 0);
+}
+
+BOOST_AUTO_TEST_CASE( future_from_reply_socket )
+{
+	zmqpp::context context;
+
+	zmqpp::socket server(context, zmqpp::socket_type::reply);
+	server.bind("inproc://test");
+
+	zmqpp::socket socket(context, zmqpp::socket_type::dealer);
+	socket.connect("inproc://test");
+
+	zmqpp::rpc_client client(socket);
+
+	std::vector<std::future<zmqpp::message>> futures;
+	for(int i = 0; i < 3; ++i)
+	{
+		zmqpp::message request;
+		request << i;
+		futures.push_back(client.call(request));
+	}
+
+	zmqpp::poller poller;
+	poller.add(server);
+	for(int i = 0; i < 3; ++i)
+	{
+		BOOST_REQUIRE(poller.poll(max_poll_timeout));
+		zmqpp::message request;
+		server.receive(request);
+		BOOST_REQUIRE_EQUAL(1, request.parts());
+
+		int number;
+		request >> number;
+		zmqpp::message reply;
+		reply << number * 10;
+		server.send(reply);
+	}
+
+	size_t finished = 0;
+	while(finished < 3)
+	{
+		size_t done = client.poll(max_poll_timeout);
+		BOOST_REQUIRE(done > 0);
+		finished += done;
+	}
+
+	for(int i = 0; i < 3; ++i)
+	{
+		zmqpp::message reply = futures[i].get();
+		int number;
+		reply >> number;
+		BOOST_CHECK_EQUAL(i * 10, number);
+	}
+
+	// a timed out future throws
+	zmqpp::message request;
+	request << "ignored";
+	std::future<zmqpp::message> future = client.call(request, std::chrono::milliseconds(5));
+	while(0 == client.poll(max_poll_timeout));
+	BOOST_CHECK_THROW(future.get(), zmqpp::exception);
+}
+
+BOOST_AUTO_TEST_CASE( malformed_replies_dropped )
+{
+	zmqpp::context context;
+
+	zmqpp::socket server(context, zmqpp::socket_type::router);
+	server.bind("inproc://test");
+
+	zmqpp::socket socket(context, zmqpp::socket_type::dealer);
+	socket.connect("inproc://test");
+
+	zmqpp::rpc_client client(socket);
+
+	zmqpp::message request;
+	request << "request";
+	client.call(request, zmqpp::rpc_client::callback());
+
+	std::vector<zmqpp::message> requests = receive_all(server, 1);
+	BOOST_REQUIRE_EQUAL(1, requests.size());
+	std::string identity = requests[0].get(0);
+
+	zmqpp::message short_id;
+	short_id << identity << "id" << "" << "body";
+	server.send(short_id);
+
+	zmqpp::message no_delimiter;
+	no_delimiter.add(identity.data(), identity.size());
+	no_delimiter.add(requests[0].raw_data(1), requests[0].size(1));
+	no_delimiter << "body";
+	server.send(no_delimiter);
+
+	zmqpp::message no_body;
+	no_body.add(identity.data(), identity.size());
+	no_body.add(requests[0].raw_data(1), requests[0].size(1));
+	no_body << "";
+	server.send(no_body);
+
+	server.send(requests[0]);
+
+	while(client.in_flight() > 0)
+	{
+		client.poll(max_poll_timeout);
+	}
+
+	zmqpp::rpc_client::statistics stats = client.stats();
+	BOOST_CHECK_EQUAL(3, stats.malformed);
+	BOOST_CHECK_EQUAL(1, stats.replies);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
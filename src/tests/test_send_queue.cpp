@@ -0,0 +1,189 @@
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/send_queue.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( send_queue )
+
+const int max_poll_timeout = 1000;
+
+BOOST_AUTO_TEST_CASE( initialise )
+{
+	zmqpp::context context;
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.bind("inproc://test");
+
+	zmqpp::send_queue queue(pusher, 1000);
+	BOOST_CHECK_EQUAL(1024, queue.capacity());
+	BOOST_CHECK(!queue.blocked());
+	BOOST_CHECK_EQUAL(0, queue.stats().sent);
+}
+
+BOOST_AUTO_TEST_CASE( many_producers )
+{
+	zmqpp::context context;
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.bind("inproc://test");
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.connect("inproc://test");
+
+	const int producers = 4;
+	const int count = 10000;
+
+	zmqpp::send_queue queue(pusher, 64);
+
+	std::vector<std::thread> threads;
+	for(int producer = 0; producer < producers; ++producer)
+	{
+		threads.push_back(std::thread([&queue, producer, count]() {
+			for(int i = 0; i < count; ++i)
+			{
+				zmqpp::message message;
+				message << producer << i;
+				queue.send(message);
+			}
+		}));
+	}
+
+	zmqpp::poller poller;
+	poller.add(puller);
+
+	std::vector<int> next(producers, 0);
+	bool ordered = true;
+	int received = 0;
+	while((received < producers * count) && poller.poll(max_poll_timeout))
+	{
+		zmqpp::message message;
+		puller.receive(message);
+
+		int producer = 0, i = 0;
+		message >> producer >> i;
+		ordered &= (next[producer] == i);
+		next[producer] = i + 1;
+		++received;
+	}
+
+	for(size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join();
+	}
+
+	BOOST_CHECK_EQUAL(producers * count, received);
+	BOOST_CHECK(ordered);
+	BOOST_CHECK_EQUAL(producers * count, queue.stats().sent);
+}
+
+BOOST_AUTO_TEST_CASE( backpressure_when_socket_blocked )
+{
+	zmqpp::context context;
+
+	// no peer yet so the push socket refuses every message
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.bind("inproc://test");
+
+	zmqpp::send_queue queue(pusher, 4);
+
+	int queued = 0;
+	for(int i = 0; i < 100; ++i)
+	{
+		zmqpp::message message;
+		message << i;
+		if (!queue.try_send(message))
+		{
+			BOOST_CHECK_EQUAL(1, message.parts());
+			break;
+		}
+		++queued;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	// the owner thread holds one message while the queue holds the rest
+	BOOST_CHECK_EQUAL(5, queued);
+	BOOST_CHECK(queue.blocked());
+	BOOST_CHECK_EQUAL(1, queue.stats().rejected);
+	BOOST_CHECK_EQUAL(1, queue.stats().hwm_stalls);
+
+	zmqpp::message late;
+	late << queued;
+	BOOST_CHECK(!queue.send(late, 10));
+	BOOST_CHECK_EQUAL(1, late.parts());
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.connect("inproc://test");
+
+	BOOST_CHECK(queue.send(late, max_poll_timeout));
+
+	for(int i = 0; i <= queued; ++i)
+	{
+		zmqpp::message message;
+		BOOST_REQUIRE(puller.receive(message));
+
+		int value = -1;
+		message >> value;
+		BOOST_CHECK_EQUAL(i, value);
+	}
+	BOOST_CHECK(!queue.blocked());
+}
+
+BOOST_AUTO_TEST_CASE( destroy_wakes_waiting_producers )
+{
+	zmqpp::context context;
+
+	// no peer so the queue fills and stays full
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.bind("inproc://test");
+
+	std::unique_ptr<zmqpp::send_queue> queue(new zmqpp::send_queue(pusher, 2));
+	for(int i = 0; i < 100; ++i)
+	{
+		zmqpp::message message;
+		message << i;
+		if (!queue->try_send(message))
+		{
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	zmqpp::send_queue* full = queue.get();
+	std::atomic<size_t> started(0);
+	std::vector<std::thread> producers;
+	std::vector<int> results(4, -1);
+	for(size_t i = 0; i < results.size(); ++i)
+	{
+		producers.push_back(std::thread([full, &started, &results, i]() {
+			zmqpp::message message;
+			message << "waiting";
+			started.fetch_add(1);
+			results[i] = full->send(message) ? 1 : 0;
+		}));
+	}
+
+	while(started.load() < results.size())
+	{
+		std::this_thread::yield();
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	queue.reset();
+
+	for(size_t i = 0; i < producers.size(); ++i)
+	{
+		producers[i].join();
+		BOOST_CHECK_EQUAL(0, results[i]);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
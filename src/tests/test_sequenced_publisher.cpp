@@ -0,0 +1,169 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <string>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/inet.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/sequenced_publisher.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( sequenced_publisher )
+
+const int max_poll_timeout = 1000;
+
+uint64_t sequence_of(zmqpp::message& message, size_t const& part)
+{
+	uint64_t network[2];
+	BOOST_REQUIRE_EQUAL(sizeof(network), message.size(part));
+	std::memcpy(network, message.raw_data(part), sizeof(network));
+	return ntohll(network[0]);
+}
+
+uint64_t epoch_of(zmqpp::message& message, size_t const& part)
+{
+	uint64_t network[2];
+	BOOST_REQUIRE_EQUAL(sizeof(network), message.size(part));
+	std::memcpy(network, message.raw_data(part), sizeof(network));
+	return ntohll(network[1]);
+}
+
+BOOST_AUTO_TEST_CASE( sequences_per_topic )
+{
+	zmqpp::context context;
+
+	zmqpp::socket wrong(context, zmqpp::socket_type::push);
+	BOOST_CHECK_THROW(zmqpp::sequenced_publisher publisher(wrong), zmqpp::exception);
+
+	zmqpp::socket socket(context, zmqpp::socket_type::publish);
+	socket.bind("inproc://test");
+
+	zmqpp::socket subscriber(context, zmqpp::socket_type::subscribe);
+	subscriber.connect("inproc://test");
+	subscriber.subscribe("");
+
+	zmqpp::sequenced_publisher publisher(socket);
+	zmqpp::poller poller;
+	poller.add(subscriber);
+
+	// wait out the slow joiner before counting
+	while(!poller.poll(10))
+	{
+		publisher.send("sync", "");
+	}
+	zmqpp::message sync;
+	while(subscriber.receive(sync, true))
+	{
+		sync = zmqpp::message();
+	}
+
+	BOOST_CHECK_EQUAL(1, publisher.send("a", "one"));
+	BOOST_CHECK_EQUAL(2, publisher.send("a", "two"));
+	BOOST_CHECK_EQUAL(1, publisher.send("b", "one"));
+
+	zmqpp::message multipart;
+	multipart << "x" << "y";
+	BOOST_CHECK_EQUAL(3, publisher.send("a", multipart));
+
+	BOOST_CHECK_EQUAL(3, publisher.sequence("a"));
+	BOOST_CHECK_EQUAL(1, publisher.sequence("b"));
+	BOOST_CHECK_EQUAL(0, publisher.sequence("c"));
+
+	zmqpp::message message;
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+	subscriber.receive(message);
+	BOOST_REQUIRE_EQUAL(3, message.parts());
+	BOOST_CHECK_EQUAL("a", message.get(0));
+	BOOST_CHECK_EQUAL(1, sequence_of(message, 1));
+	BOOST_CHECK_EQUAL(publisher.epoch(), epoch_of(message, 1));
+	BOOST_CHECK_EQUAL("one", message.get(2));
+
+	// every publisher, restarted or not, has its own epoch
+	zmqpp::sequenced_publisher restarted(socket);
+	BOOST_CHECK(0 != publisher.epoch());
+	BOOST_CHECK(restarted.epoch() != publisher.epoch());
+
+	for(int i = 0; i < 2; ++i)
+	{
+		message = zmqpp::message();
+		BOOST_REQUIRE(poller.poll(max_poll_timeout));
+		subscriber.receive(message);
+	}
+	BOOST_CHECK_EQUAL("b", message.get(0));
+	BOOST_CHECK_EQUAL(1, sequence_of(message, 1));
+
+	message = zmqpp::message();
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+	subscriber.receive(message);
+	BOOST_REQUIRE_EQUAL(4, message.parts());
+	BOOST_CHECK_EQUAL(3, sequence_of(message, 1));
+	BOOST_CHECK_EQUAL("y", message.get(3));
+}
+
+BOOST_AUTO_TEST_CASE( replay_from_history )
+{
+	zmqpp::context context;
+
+	zmqpp::socket socket(context, zmqpp::socket_type::publish);
+	socket.bind("inproc://test");
+
+	zmqpp::socket router(context, zmqpp::socket_type::router);
+	router.bind("inproc://replay");
+
+	zmqpp::socket dealer(context, zmqpp::socket_type::dealer);
+	dealer.connect("inproc://replay");
+
+	zmqpp::sequenced_publisher publisher(socket, 3);
+	for(int i = 1; i <= 5; ++i)
+	{
+		publisher.send("topic", "body " + std::to_string(i));
+	}
+
+	// only 3 to 5 are still kept, ask for 2 to 4
+	zmqpp::message request;
+	request << "topic" << static_cast<uint64_t>(2) << static_cast<uint64_t>(4);
+	dealer.send(request);
+
+	zmqpp::message unknown;
+	unknown << "unknown" << static_cast<uint64_t>(1) << static_cast<uint64_t>(2);
+	dealer.send(unknown);
+
+	zmqpp::message garbage;
+	garbage << "topic";
+	dealer.send(garbage);
+
+	zmqpp::poller poller;
+	poller.add(router);
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+
+	size_t served = 0;
+	while((served < 2) && poller.poll(max_poll_timeout))
+	{
+		served += publisher.replay(router);
+	}
+	BOOST_CHECK_EQUAL(2, served);
+
+	poller.add(dealer);
+	for(uint64_t sequence = 3; sequence <= 4; ++sequence)
+	{
+		BOOST_REQUIRE(poller.poll(max_poll_timeout));
+		zmqpp::message message;
+		BOOST_REQUIRE(dealer.receive(message));
+		BOOST_REQUIRE_EQUAL(3, message.parts());
+		BOOST_CHECK_EQUAL("topic", message.get(0));
+		BOOST_CHECK_EQUAL(sequence, sequence_of(message, 1));
+		BOOST_CHECK_EQUAL("body " + std::to_string(sequence), message.get(2));
+	}
+
+	zmqpp::sequenced_publisher::statistics stats = publisher.stats();
+	BOOST_CHECK_EQUAL(5, stats.sent);
+	BOOST_CHECK_EQUAL(2, stats.requests);
+	BOOST_CHECK_EQUAL(2, stats.replayed);
+	BOOST_CHECK_EQUAL(3, stats.unavailable);
+	BOOST_CHECK_EQUAL(1, stats.malformed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
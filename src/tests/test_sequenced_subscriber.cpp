@@ -0,0 +1,243 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/inet.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/sequenced_publisher.hpp"
+#include "zmqpp/sequenced_subscriber.hpp"
+#include "zmqpp/socket.hpp"
+
+BOOST_AUTO_TEST_SUITE( sequenced_subscriber )
+
+const int max_poll_timeout = 1000;
+
+// Publish raw frames until the subscriber sees one so none of the real ones are lost
+void sync(zmqpp::socket& publisher, zmqpp::socket& subscriber)
+{
+	zmqpp::poller poller;
+	poller.add(subscriber);
+
+	while(!poller.poll(10))
+	{
+		publisher.send("sync");
+	}
+
+	zmqpp::message message;
+	while(subscriber.receive(message, true))
+	{
+		message = zmqpp::message();
+	}
+}
+
+void publish(zmqpp::socket& publisher, std::string const& topic, uint64_t const& sequence, uint64_t const& epoch)
+{
+	zmqpp::message message;
+	message << topic;
+	uint64_t network[2] = { htonll(sequence), htonll(epoch) };
+	message.add(network, sizeof(network));
+	message << "body";
+	publisher.send(message);
+}
+
+void publish(zmqpp::socket& publisher, std::string const& topic, uint64_t const& sequence)
+{
+	publish(publisher, topic, sequence, 1);
+}
+
+BOOST_AUTO_TEST_CASE( detects_gaps )
+{
+	zmqpp::context context;
+
+	zmqpp::socket wrong(context, zmqpp::socket_type::pull);
+	BOOST_CHECK_THROW(zmqpp::sequenced_subscriber subscriber(wrong), zmqpp::exception);
+
+	zmqpp::socket publisher(context, zmqpp::socket_type::publish);
+	publisher.bind("inproc://test");
+
+	zmqpp::socket socket(context, zmqpp::socket_type::subscribe);
+	socket.connect("inproc://test");
+	socket.subscribe("");
+	sync(publisher, socket);
+
+	zmqpp::sequenced_subscriber subscriber(socket);
+	std::vector<std::tuple<std::string, uint64_t, uint64_t>> gaps;
+	subscriber.set_gap_handler([&gaps](std::string const& topic, uint64_t const& first, uint64_t const& last) {
+		gaps.push_back(std::make_tuple(topic, first, last));
+	});
+
+	publish(publisher, "a", 7);  // joined part way through
+	publish(publisher, "a", 8);
+	publish(publisher, "b", 1);
+	publish(publisher, "a", 12); // 9 to 11 lost
+	publish(publisher, "a", 10); // stale
+	publisher.send("not sequenced");
+	zmqpp::message no_epoch;
+	no_epoch << "b" << static_cast<uint64_t>(2) << "body";
+	publisher.send(no_epoch);
+	publish(publisher, "b", 2);
+	publish(publisher, "b", 1);  // stale, a restart comes with a new epoch
+
+	std::vector<uint64_t> expected { 7, 8, 1, 12, 2 };
+	for(size_t i = 0; i < expected.size(); ++i)
+	{
+		std::string topic;
+		uint64_t sequence;
+		zmqpp::message body;
+		BOOST_REQUIRE(subscriber.receive(topic, sequence, body));
+		BOOST_CHECK_EQUAL(expected[i], sequence);
+		BOOST_CHECK_EQUAL("body", body.get(0));
+	}
+
+	BOOST_REQUIRE_EQUAL(1, gaps.size());
+	BOOST_CHECK_EQUAL("a", std::get<0>(gaps[0]));
+	BOOST_CHECK_EQUAL(9, std::get<1>(gaps[0]));
+	BOOST_CHECK_EQUAL(11, std::get<2>(gaps[0]));
+
+	BOOST_CHECK_EQUAL(12, subscriber.sequence("a"));
+	BOOST_CHECK_EQUAL(2, subscriber.sequence("b"));
+
+	std::string topic;
+	uint64_t sequence;
+	zmqpp::message body;
+	BOOST_CHECK(!subscriber.receive(topic, sequence, body, true));
+
+	zmqpp::sequenced_subscriber::statistics stats = subscriber.stats();
+	BOOST_CHECK_EQUAL(5, stats.received);
+	BOOST_CHECK_EQUAL(1, stats.gaps);
+	BOOST_CHECK_EQUAL(3, stats.missed);
+	BOOST_CHECK_EQUAL(2, stats.stale);
+	BOOST_CHECK_EQUAL(0, stats.resets);
+	BOOST_CHECK_EQUAL(2, stats.malformed);
+}
+
+BOOST_AUTO_TEST_CASE( restart_detected_by_epoch )
+{
+	zmqpp::context context;
+
+	zmqpp::socket publisher(context, zmqpp::socket_type::publish);
+	publisher.bind("inproc://test");
+
+	zmqpp::socket socket(context, zmqpp::socket_type::subscribe);
+	socket.connect("inproc://test");
+	socket.subscribe("");
+	sync(publisher, socket);
+
+	zmqpp::sequenced_subscriber subscriber(socket);
+	std::vector<std::tuple<std::string, uint64_t, uint64_t>> gaps;
+	subscriber.set_gap_handler([&gaps](std::string const& topic, uint64_t const& first, uint64_t const& last) {
+		gaps.push_back(std::make_tuple(topic, first, last));
+	});
+
+	for(uint64_t sequence = 1; sequence <= 5; ++sequence)
+	{
+		publish(publisher, "a", sequence, 7);
+	}
+	publish(publisher, "a", 3, 9); // restarted, 1 and 2 lost
+	publish(publisher, "a", 4, 9);
+	publish(publisher, "a", 2, 9); // stale within the new epoch
+
+	std::vector<uint64_t> expected { 1, 2, 3, 4, 5, 3, 4 };
+	for(size_t i = 0; i < expected.size(); ++i)
+	{
+		std::string topic;
+		uint64_t sequence;
+		zmqpp::message body;
+		BOOST_REQUIRE(subscriber.receive(topic, sequence, body));
+		BOOST_CHECK_EQUAL(expected[i], sequence);
+	}
+
+	BOOST_REQUIRE_EQUAL(1, gaps.size());
+	BOOST_CHECK_EQUAL("a", std::get<0>(gaps[0]));
+	BOOST_CHECK_EQUAL(1, std::get<1>(gaps[0]));
+	BOOST_CHECK_EQUAL(2, std::get<2>(gaps[0]));
+	BOOST_CHECK_EQUAL(4, subscriber.sequence("a"));
+
+	zmqpp::sequenced_subscriber::statistics stats = subscriber.stats();
+	BOOST_CHECK_EQUAL(7, stats.received);
+	BOOST_CHECK_EQUAL(1, stats.resets);
+	BOOST_CHECK_EQUAL(1, stats.gaps);
+	BOOST_CHECK_EQUAL(2, stats.missed);
+
+	std::string topic;
+	uint64_t sequence;
+	zmqpp::message body;
+	BOOST_CHECK(!subscriber.receive(topic, sequence, body, true));
+	BOOST_CHECK_EQUAL(1, subscriber.stats().stale);
+}
+
+BOOST_AUTO_TEST_CASE( recovers_from_publisher_history )
+{
+	zmqpp::context context;
+
+	// the history is kept by a publisher nobody listens to, the subscriber
+	// is fed the same sequence with a hole in it
+	zmqpp::socket history_socket(context, zmqpp::socket_type::publish);
+	zmqpp::sequenced_publisher publisher(history_socket, 16);
+	for(int i = 1; i <= 5; ++i)
+	{
+		publisher.send("topic", std::to_string(i));
+	}
+
+	zmqpp::socket lossy(context, zmqpp::socket_type::publish);
+	lossy.bind("inproc://test");
+
+	zmqpp::socket router(context, zmqpp::socket_type::router);
+	router.bind("inproc://replay");
+
+	zmqpp::socket socket(context, zmqpp::socket_type::subscribe);
+	socket.connect("inproc://test");
+	socket.subscribe("");
+	sync(lossy, socket);
+
+	zmqpp::socket dealer(context, zmqpp::socket_type::dealer);
+	dealer.connect("inproc://replay");
+
+	zmqpp::sequenced_subscriber subscriber(socket);
+	subscriber.set_recovery(&dealer);
+
+	publish(lossy, "topic", 1);
+	publish(lossy, "topic", 5);
+
+	std::string topic;
+	uint64_t sequence;
+	for(int i = 0; i < 2; ++i)
+	{
+		zmqpp::message body;
+		BOOST_REQUIRE(subscriber.receive(topic, sequence, body));
+	}
+	BOOST_CHECK_EQUAL(1, subscriber.stats().gaps);
+	BOOST_REQUIRE_EQUAL(1, subscriber.stats().requests);
+
+	zmqpp::poller poller;
+	poller.add(router);
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+	BOOST_CHECK_EQUAL(1, publisher.replay(router));
+
+	poller.add(dealer);
+	std::vector<std::string> recovered;
+	while((recovered.size() < 3) && poller.poll(max_poll_timeout))
+	{
+		zmqpp::message body;
+		while(subscriber.recover(topic, sequence, body, true))
+		{
+			BOOST_CHECK_EQUAL("topic", topic);
+			BOOST_CHECK_EQUAL(recovered.size() + 2, sequence);
+			recovered.push_back(body.get(0));
+			body = zmqpp::message();
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(3, recovered.size());
+	BOOST_CHECK_EQUAL("2", recovered[0]);
+	BOOST_CHECK_EQUAL("4", recovered[2]);
+	BOOST_CHECK_EQUAL(3, subscriber.stats().recovered);
+	BOOST_CHECK_EQUAL(5, subscriber.sequence("topic"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
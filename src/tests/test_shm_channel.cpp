@@ -0,0 +1,275 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "zmqpp/exception.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/shm_channel.hpp"
+
+BOOST_AUTO_TEST_SUITE( shm_channel )
+
+const int max_poll_timeout = 1000;
+
+std::string unique_name(std::string const& test)
+{
+	return "test-" + test + "-" + std::to_string(getpid());
+}
+
+BOOST_AUTO_TEST_CASE( initialise )
+{
+	std::string name = unique_name("initialise");
+	BOOST_CHECK_THROW(zmqpp::shm_channel(name, zmqpp::shm_channel::role::sender), zmqpp::exception);
+	BOOST_CHECK_THROW(zmqpp::shm_channel("bad/name", zmqpp::shm_channel::role::receiver), zmqpp::exception);
+
+	zmqpp::shm_channel receiver(name, zmqpp::shm_channel::role::receiver, 5000);
+	BOOST_CHECK_EQUAL(8192, receiver.capacity());
+	BOOST_CHECK_EQUAL(4096, receiver.max_message_size());
+	BOOST_CHECK(receiver.file_descriptor() >= 0);
+
+	zmqpp::shm_channel sender(name, zmqpp::shm_channel::role::sender);
+	BOOST_CHECK_EQUAL(8192, sender.capacity());
+
+	std::string text;
+	BOOST_CHECK(!receiver.receive(text, true));
+	BOOST_CHECK_THROW(sender.receive(text, true), zmqpp::exception);
+	BOOST_CHECK_THROW(receiver.send("wrong way"), zmqpp::exception);
+}
+
+BOOST_AUTO_TEST_CASE( name_in_use )
+{
+	std::string name = unique_name("name_in_use");
+	zmqpp::shm_channel receiver(name, zmqpp::shm_channel::role::receiver);
+	BOOST_CHECK_THROW(zmqpp::shm_channel(name, zmqpp::shm_channel::role::receiver), zmqpp::exception);
+
+	// the failed receiver must not have removed the live channel
+	zmqpp::shm_channel sender(name, zmqpp::shm_channel::role::sender);
+	BOOST_CHECK(sender.send("still here"));
+
+	zmqpp::poller poller;
+	poller.add(receiver.file_descriptor());
+	std::string text;
+	BOOST_CHECK(receiver.receive(text, true));
+	BOOST_CHECK_EQUAL("still here", text);
+	BOOST_CHECK(!receiver.receive(text, true));
+	BOOST_CHECK(sender.send("woken"));
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(receiver.receive(text, true));
+	BOOST_CHECK_EQUAL("woken", text);
+}
+
+BOOST_AUTO_TEST_CASE( remove_stale )
+{
+	std::string name = unique_name("remove_stale");
+
+	// a receiver that exits without cleaning up leaves its name in use
+	pid_t child = fork();
+	BOOST_REQUIRE(child >= 0);
+	if (0 == child)
+	{
+		new zmqpp::shm_channel(name, zmqpp::shm_channel::role::receiver);
+		_exit(0);
+	}
+
+	int status = 0;
+	BOOST_REQUIRE_EQUAL(child, waitpid(child, &status, 0));
+	BOOST_CHECK_THROW(zmqpp::shm_channel(name, zmqpp::shm_channel::role::receiver), zmqpp::exception);
+
+	zmqpp::shm_channel::remove(name);
+	zmqpp::shm_channel receiver(name, zmqpp::shm_channel::role::receiver);
+	zmqpp::shm_channel sender(name, zmqpp::shm_channel::role::sender);
+	BOOST_CHECK(sender.send("fresh"));
+
+	std::string text;
+	BOOST_CHECK(receiver.receive(text, true));
+	BOOST_CHECK_EQUAL("fresh", text);
+}
+
+BOOST_AUTO_TEST_CASE( send_and_receive )
+{
+	std::string name = unique_name("send_and_receive");
+	zmqpp::shm_channel receiver(name, zmqpp::shm_channel::role::receiver);
+	zmqpp::shm_channel sender(name, zmqpp::shm_channel::role::sender);
+
+	zmqpp::message message;
+	message << "hello" << "world" << 42;
+	BOOST_CHECK(sender.send(message));
+	BOOST_CHECK_EQUAL(0, message.parts());
+	BOOST_CHECK(sender.send("second"));
+
+	zmqpp::message received;
+	BOOST_CHECK(receiver.receive(received, true));
+	BOOST_REQUIRE_EQUAL(3, received.parts());
+	std::string first, second;
+	int number = 0;
+	received >> first >> second >> number;
+	BOOST_CHECK_EQUAL("hello", first);
+	BOOST_CHECK_EQUAL("world", second);
+	BOOST_CHECK_EQUAL(42, number);
+
+	zmqpp::message not_empty;
+	not_empty << "part";
+	BOOST_CHECK_THROW(receiver.receive(not_empty, true), zmqpp::exception);
+
+	std::string text;
+	BOOST_CHECK(receiver.receive(text, true));
+	BOOST_CHECK_EQUAL("second", text);
+	BOOST_CHECK(!receiver.receive(text, true));
+}
+
+BOOST_AUTO_TEST_CASE( claim_and_peek_in_place )
+{
+	std::string name = unique_name("claim_and_peek");
+	zmqpp::shm_channel receiver(name, zmqpp::shm_channel::role::receiver);
+	zmqpp::shm_channel sender(name, zmqpp::shm_channel::role::sender);
+
+	BOOST_CHECK_THROW(sender.commit(), zmqpp::exception);
+	BOOST_CHECK_THROW(receiver.release(), zmqpp::exception);
+
+	void* part = sender.claim(5);
+	BOOST_REQUIRE(nullptr != part);
+	std::memcpy(part, "hello", 5);
+
+	void const* data = nullptr;
+	size_t size = 0;
+	BOOST_CHECK(!receiver.peek(data, size, true));
+
+	sender.commit();
+
+	BOOST_CHECK(receiver.peek(data, size, true));
+	BOOST_CHECK_EQUAL("hello", std::string(static_cast<char const*>(data), size));
+	receiver.release();
+	BOOST_CHECK(!receiver.peek(data, size, true));
+}
+
+BOOST_AUTO_TEST_CASE( full_ring_refuses )
+{
+	std::string name = unique_name("full_ring_refuses");
+	zmqpp::shm_channel receiver(name, zmqpp::shm_channel::role::receiver, 4096);
+	zmqpp::shm_channel sender(name, zmqpp::shm_channel::role::sender);
+
+	std::string large(1000, 'x');
+	BOOST_CHECK_THROW(sender.send(std::string(4096, 'x'), true), zmqpp::exception);
+
+	int sent = 0;
+	while(sender.send(large, true))
+	{
+		++sent;
+	}
+	BOOST_CHECK_EQUAL(4, sent);
+
+	zmqpp::message message;
+	message << large;
+	BOOST_CHECK(!sender.send(message, true));
+	BOOST_CHECK_EQUAL(1, message.parts());
+
+	std::string text;
+	BOOST_CHECK(receiver.receive(text, true));
+	BOOST_CHECK_EQUAL(large, text);
+	BOOST_CHECK(sender.send(message, true));
+}
+
+BOOST_AUTO_TEST_CASE( threaded_order_across_wrap )
+{
+	std::string name = unique_name("threaded_order");
+	zmqpp::shm_channel receiver(name, zmqpp::shm_channel::role::receiver, 4096);
+	zmqpp::shm_channel sender(name, zmqpp::shm_channel::role::sender);
+	const uint32_t count = 100000;
+
+	std::thread producer([&sender, count]() {
+		for(uint32_t i = 0; i < count; ++i)
+		{
+			// varying sizes so records land across the end of the ring
+			zmqpp::message message;
+			message << i << std::string(i % 300, 'x');
+			sender.send(message);
+		}
+	});
+
+	bool ordered = true;
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		zmqpp::message message;
+		receiver.receive(message);
+
+		uint32_t value = 0;
+		std::string padding;
+		message >> value >> padding;
+		ordered &= (i == value) && (padding.size() == i % 300);
+	}
+
+	producer.join();
+	BOOST_CHECK(ordered);
+}
+
+BOOST_AUTO_TEST_CASE( poller_wakes_parked_receiver )
+{
+	std::string name = unique_name("poller_wakes");
+	zmqpp::shm_channel receiver(name, zmqpp::shm_channel::role::receiver);
+	zmqpp::shm_channel sender(name, zmqpp::shm_channel::role::sender);
+
+	zmqpp::poller poller;
+	poller.add(receiver.file_descriptor());
+
+	// parks the receiver
+	std::string text;
+	BOOST_CHECK(!receiver.receive(text, true));
+	BOOST_CHECK(!poller.poll(0));
+
+	std::thread producer([&sender]() { sender.send("hello"); });
+
+	BOOST_CHECK(poller.poll(max_poll_timeout));
+	BOOST_CHECK(poller.has_input(receiver.file_descriptor()));
+	producer.join();
+
+	BOOST_CHECK(receiver.receive(text, true));
+	BOOST_CHECK_EQUAL("hello", text);
+
+	// draining parks again and clears the wake up
+	BOOST_CHECK(!receiver.receive(text, true));
+	BOOST_CHECK(!poller.poll(0));
+}
+
+BOOST_AUTO_TEST_CASE( between_processes )
+{
+	std::string name = unique_name("between_processes");
+	zmqpp::shm_channel receiver(name, zmqpp::shm_channel::role::receiver);
+	const uint32_t count = 10000;
+
+	pid_t child = fork();
+	BOOST_REQUIRE(child >= 0);
+	if (0 == child)
+	{
+		zmqpp::shm_channel sender(name, zmqpp::shm_channel::role::sender);
+		for(uint32_t i = 0; i < count; ++i)
+		{
+			zmqpp::message message;
+			message << i;
+			sender.send(message);
+		}
+		_exit(0);
+	}
+
+	bool ordered = true;
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		zmqpp::message message;
+		receiver.receive(message);
+
+		uint32_t value = 0;
+		message >> value;
+		ordered &= (i == value);
+	}
+
+	int status = -1;
+	waitpid(child, &status, 0);
+	BOOST_CHECK_EQUAL(0, status);
+	BOOST_CHECK(ordered);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -58,6 +58,21 @@ BOOST_AUTO_TEST_CASE( valid_socket )
 	BOOST_CHECK(!socket.receive(message, true));
 }
 
+BOOST_AUTO_TEST_CASE( blocked_send_keeps_message )
+{
+	zmqpp::context context;
+	zmqpp::socket socket(context, zmqpp::socket_type::push);
+	socket.bind("inproc://test");
+
+	zmqpp::message message;
+	message << "hello" << "world";
+	BOOST_CHECK(!socket.send(message, true));
+
+	BOOST_REQUIRE_EQUAL(2, message.parts());
+	BOOST_CHECK_EQUAL("hello", message.get(0));
+	BOOST_CHECK_EQUAL("world", message.get(1));
+}
+
 BOOST_AUTO_TEST_CASE( valid_move_supporting )
 {
 	zmqpp::context context;
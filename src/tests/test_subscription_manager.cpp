@@ -0,0 +1,216 @@
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/socket.hpp"
+#include "zmqpp/subscription_manager.hpp"
+
+BOOST_AUTO_TEST_SUITE( subscription_manager )
+
+const int max_poll_timeout = 1000;
+
+BOOST_AUTO_TEST_CASE( reference_counting )
+{
+	zmqpp::context context;
+	zmqpp::socket socket(context, zmqpp::socket_type::subscribe);
+
+	zmqpp::socket wrong(context, zmqpp::socket_type::publish);
+	BOOST_CHECK_THROW(zmqpp::subscription_manager manager(wrong), zmqpp::exception);
+
+	zmqpp::subscription_manager manager(socket);
+
+	std::vector<std::string> topics { "a", "b", "a", "c" };
+	manager.add(topics.begin(), topics.end());
+	BOOST_CHECK_EQUAL(3, manager.topics());
+	BOOST_CHECK_EQUAL(3, manager.pending());
+	BOOST_CHECK_EQUAL(3, manager.flush());
+	BOOST_CHECK_EQUAL(0, manager.pending());
+	BOOST_CHECK_EQUAL(0, manager.flush());
+
+	// one reference to a is left
+	manager.remove("a");
+	BOOST_CHECK(manager.subscribed("a"));
+	BOOST_CHECK_EQUAL(0, manager.pending());
+
+	manager.remove("a");
+	manager.remove("a");
+	manager.remove("unknown");
+	BOOST_CHECK(!manager.subscribed("a"));
+	BOOST_CHECK_EQUAL(1, manager.pending());
+
+	// changes that cancel out never reach the socket
+	manager.add("a");
+	manager.add("d");
+	manager.remove("d");
+	BOOST_CHECK_EQUAL(0, manager.pending());
+	BOOST_CHECK_EQUAL(0, manager.flush());
+
+	zmqpp::subscription_manager::statistics stats = manager.stats();
+	BOOST_CHECK_EQUAL(1, stats.flushes);
+	BOOST_CHECK_EQUAL(3, stats.updates);
+	BOOST_CHECK_EQUAL(4, stats.coalesced);
+}
+
+BOOST_AUTO_TEST_CASE( subscribe_socket_filters )
+{
+	zmqpp::context context;
+
+	zmqpp::socket publisher(context, zmqpp::socket_type::publish);
+	publisher.bind("inproc://test");
+
+	zmqpp::socket subscriber(context, zmqpp::socket_type::subscribe);
+	subscriber.connect("inproc://test");
+
+	zmqpp::subscription_manager manager(subscriber);
+	manager.add("wanted");
+	manager.add("removed");
+	manager.flush();
+	manager.remove("removed");
+	manager.flush();
+
+	zmqpp::poller poller;
+	poller.add(subscriber);
+
+	std::set<std::string> received;
+	for(int attempt = 0; (attempt < 100) && received.empty(); ++attempt)
+	{
+		publisher.send("removed topic");
+		publisher.send("wanted topic");
+
+		while(poller.poll(10))
+		{
+			std::string text;
+			subscriber.receive(text);
+			received.insert(text);
+		}
+	}
+
+	BOOST_CHECK_EQUAL(1, received.size());
+	BOOST_CHECK_EQUAL(1, received.count("wanted topic"));
+}
+
+BOOST_AUTO_TEST_CASE( xsubscribe_sends_frames )
+{
+	zmqpp::context context;
+
+	zmqpp::socket publisher(context, zmqpp::socket_type::xpublish);
+	publisher.bind("inproc://test");
+
+	zmqpp::socket subscriber(context, zmqpp::socket_type::xsubscribe);
+	subscriber.connect("inproc://test");
+
+	zmqpp::subscription_manager manager(subscriber);
+	for(int i = 0; i < 1000; ++i)
+	{
+		manager.add("topic" + std::to_string(i));
+	}
+	BOOST_CHECK_EQUAL(1000, manager.flush());
+
+	zmqpp::poller poller;
+	poller.add(publisher);
+
+	std::set<std::string> frames;
+	while((frames.size() < 1000) && poller.poll(max_poll_timeout))
+	{
+		std::string frame;
+		publisher.receive(frame);
+		BOOST_REQUIRE(!frame.empty());
+		BOOST_CHECK_EQUAL('\1', frame[0]);
+		frames.insert(frame.substr(1));
+	}
+
+	BOOST_CHECK_EQUAL(1000, frames.size());
+	BOOST_CHECK_EQUAL(1, frames.count("topic999"));
+
+	manager.remove("topic5");
+	manager.flush();
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+	std::string frame;
+	publisher.receive(frame);
+	BOOST_CHECK(std::string("\0topic5", 7) == frame);
+
+	// nothing was staged and the socket already knows its subscriptions
+	BOOST_CHECK_EQUAL(0, manager.resubscribe());
+	BOOST_CHECK(!poller.poll(10));
+}
+
+BOOST_AUTO_TEST_CASE( xsubscribe_reconnect_replays_once )
+{
+	zmqpp::context context;
+	std::string const endpoint = "tcp://127.0.0.1:48151";
+
+	std::unique_ptr<zmqpp::socket> publisher(new zmqpp::socket(context, zmqpp::socket_type::xpublish));
+	publisher->bind(endpoint);
+
+	zmqpp::socket subscriber(context, zmqpp::socket_type::xsubscribe);
+	subscriber.set(zmqpp::socket_option::reconnect_interval, 10);
+	subscriber.connect(endpoint);
+
+	zmqpp::subscription_manager manager(subscriber);
+	manager.add("a");
+	manager.add("b");
+	BOOST_CHECK_EQUAL(2, manager.flush());
+
+	// the subscriber is polled as well, libzmq only handles its reconnect
+	// while the application calls into the socket
+	auto drain = [&publisher, &subscriber](std::multiset<std::string>& frames, size_t wanted) {
+		zmqpp::poller poller;
+		poller.add(*publisher);
+		poller.add(subscriber);
+		auto collect = [&](long timeout) {
+			while(poller.poll(timeout))
+			{
+				if (poller.has_input(*publisher))
+				{
+					std::string frame;
+					publisher->receive(frame);
+					frames.insert(frame);
+					return true;
+				}
+			}
+			return false;
+		};
+		while((frames.size() < wanted) && collect(max_poll_timeout)) { }
+		// anything more would be a duplicate
+		while(collect(50)) { }
+	};
+
+	std::multiset<std::string> frames;
+	drain(frames, 2);
+	BOOST_CHECK_EQUAL(2, frames.size());
+
+	// restart the publisher, the subscriber replays its subscriptions itself
+	publisher.reset();
+	publisher.reset(new zmqpp::socket(context, zmqpp::socket_type::xpublish));
+	for(int attempt = 0; ; ++attempt)
+	{
+		// closing is asynchronous so the port may not be released yet
+		try { publisher->bind(endpoint); break; }
+		catch(zmqpp::zmq_internal_exception&) { BOOST_REQUIRE(attempt < 100); }
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	BOOST_CHECK_EQUAL(0, manager.resubscribe());
+
+	frames.clear();
+	drain(frames, 2);
+	BOOST_CHECK_EQUAL(2, frames.size());
+	BOOST_CHECK_EQUAL(1, frames.count("\1a"));
+	BOOST_CHECK_EQUAL(1, frames.count("\1b"));
+
+	manager.remove("a");
+	BOOST_CHECK_EQUAL(1, manager.flush());
+	frames.clear();
+	drain(frames, 1);
+	BOOST_CHECK_EQUAL(1, frames.size());
+	BOOST_CHECK_EQUAL(1, frames.count(std::string("\0a", 2)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
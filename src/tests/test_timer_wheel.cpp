@@ -0,0 +1,196 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#include "zmqpp/timer_wheel.hpp"
+
+BOOST_AUTO_TEST_SUITE( timer_wheel )
+
+typedef zmqpp::timer_wheel::clock_type clock_type;
+
+const clock_type::time_point start = clock_type::now();
+
+clock_type::time_point at(long const& milliseconds)
+{
+	return start + std::chrono::milliseconds(milliseconds);
+}
+
+BOOST_AUTO_TEST_CASE( initialise )
+{
+	zmqpp::timer_wheel timers(start);
+
+	BOOST_CHECK_EQUAL(0, timers.size());
+	BOOST_CHECK_EQUAL(-1, timers.next_timeout(at(0)));
+	BOOST_CHECK_EQUAL(0, timers.expire(at(1000)));
+}
+
+BOOST_AUTO_TEST_CASE( one_shot )
+{
+	zmqpp::timer_wheel timers(start);
+
+	int called = 0;
+	zmqpp::timer_wheel::timer_id id = timers.add(10, [&called]() { ++called; }, at(0));
+	BOOST_CHECK(id.valid());
+	BOOST_CHECK_EQUAL(1, timers.size());
+	BOOST_CHECK_EQUAL(10, timers.next_timeout(at(0)));
+	BOOST_CHECK_EQUAL(4, timers.next_timeout(at(6)));
+
+	BOOST_CHECK_EQUAL(0, timers.expire(at(9)));
+	BOOST_CHECK_EQUAL(0, called);
+
+	BOOST_CHECK_EQUAL(1, timers.expire(at(10)));
+	BOOST_CHECK_EQUAL(1, called);
+	BOOST_CHECK_EQUAL(0, timers.size());
+	BOOST_CHECK_EQUAL(-1, timers.next_timeout(at(10)));
+
+	BOOST_CHECK_EQUAL(0, timers.expire(at(100)));
+	BOOST_CHECK_EQUAL(1, called);
+	BOOST_CHECK(!timers.cancel(id));
+}
+
+BOOST_AUTO_TEST_CASE( never_fires_early )
+{
+	zmqpp::timer_wheel timers(start);
+
+	bool called = false;
+	timers.add(5, [&called]() { called = true; }, at(0) + std::chrono::microseconds(100));
+
+	BOOST_CHECK_EQUAL(0, timers.expire(at(5)));
+	BOOST_CHECK_EQUAL(1, timers.expire(at(6)));
+	BOOST_CHECK(called);
+}
+
+BOOST_AUTO_TEST_CASE( repeating )
+{
+	zmqpp::timer_wheel timers(start);
+
+	int called = 0;
+	zmqpp::timer_wheel::timer_id id = timers.add_repeating(5, [&called]() { ++called; }, at(0));
+
+	for(long now = 0; now <= 100; ++now)
+	{
+		timers.expire(at(now));
+	}
+	BOOST_CHECK_EQUAL(20, called);
+	BOOST_CHECK_EQUAL(1, timers.size());
+
+	// missed firings are skipped rather than run back to back
+	BOOST_CHECK_EQUAL(1, timers.expire(at(1000)));
+	BOOST_CHECK_EQUAL(21, called);
+	BOOST_CHECK_EQUAL(5, timers.next_timeout(at(1000)));
+
+	BOOST_CHECK(timers.cancel(id));
+	BOOST_CHECK(!timers.cancel(id));
+	BOOST_CHECK_EQUAL(0, timers.size());
+	BOOST_CHECK_EQUAL(0, timers.expire(at(2000)));
+	BOOST_CHECK_EQUAL(21, called);
+}
+
+BOOST_AUTO_TEST_CASE( cancel_before_firing )
+{
+	zmqpp::timer_wheel timers(start);
+
+	bool called = false;
+	zmqpp::timer_wheel::timer_id id = timers.add(10, [&called]() { called = true; }, at(0));
+	BOOST_CHECK(timers.cancel(id));
+	BOOST_CHECK_EQUAL(0, timers.size());
+
+	BOOST_CHECK_EQUAL(0, timers.expire(at(100)));
+	BOOST_CHECK(!called);
+
+	// the slot is reused but the old id must not cancel the new timer
+	zmqpp::timer_wheel::timer_id reused = timers.add(10, [&called]() { called = true; }, at(100));
+	BOOST_CHECK(reused != id);
+	BOOST_CHECK(!timers.cancel(id));
+	BOOST_CHECK_EQUAL(1, timers.expire(at(110)));
+	BOOST_CHECK(called);
+}
+
+BOOST_AUTO_TEST_CASE( long_timers_cascade )
+{
+	zmqpp::timer_wheel timers(start);
+
+	const long delays[] = { 63, 64, 65, 4095, 4096, 4097, 300000, 20000000 };
+	std::vector<long> fired_at;
+
+	long now = 0;
+	for(size_t i = 0; i < sizeof(delays) / sizeof(delays[0]); ++i)
+	{
+		timers.add(delays[i], [&fired_at, &now]() { fired_at.push_back(now); }, at(now));
+	}
+
+	// Jump straight to each wakeup the wheel asks for
+	while(timers.size() > 0)
+	{
+		long wait = timers.next_timeout(at(now));
+		BOOST_REQUIRE(wait > 0);
+		now += wait;
+		timers.expire(at(now));
+	}
+
+	BOOST_REQUIRE_EQUAL(sizeof(delays) / sizeof(delays[0]), fired_at.size());
+	for(size_t i = 0; i < fired_at.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(delays[i], fired_at[i]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( many_timers_fire_on_time )
+{
+	zmqpp::timer_wheel timers(start);
+
+	const size_t count = 10000;
+	size_t late = 0;
+	size_t fired = 0;
+	long now = 0;
+
+	srand(1);
+	for(size_t i = 0; i < count; ++i)
+	{
+		long delay = rand() % 100000;
+		timers.add(delay, [&, delay]() {
+			++fired;
+			if (now != delay) { ++late; }
+		}, at(0));
+	}
+
+	for(now = 0; now <= 100000; ++now)
+	{
+		timers.expire(at(now));
+	}
+
+	BOOST_CHECK_EQUAL(count, fired);
+	BOOST_CHECK_EQUAL(0, late);
+}
+
+BOOST_AUTO_TEST_CASE( callbacks_change_timers )
+{
+	zmqpp::timer_wheel timers(start);
+
+	int first = 0;
+	int second = 0;
+	int added = 0;
+	zmqpp::timer_wheel::timer_id second_id;
+	zmqpp::timer_wheel::timer_id first_id;
+
+	first_id = timers.add_repeating(10, [&]() {
+		++first;
+		timers.cancel(second_id);
+		timers.cancel(first_id);
+		timers.add(5, [&added]() { ++added; }, at(10));
+	}, at(0));
+	second_id = timers.add(10, [&second]() { ++second; }, at(0));
+
+	BOOST_CHECK_EQUAL(1, timers.expire(at(10)));
+	BOOST_CHECK_EQUAL(1, first);
+	BOOST_CHECK_EQUAL(0, second);
+	BOOST_CHECK_EQUAL(1, timers.size());
+
+	BOOST_CHECK_EQUAL(1, timers.expire(at(100)));
+	BOOST_CHECK_EQUAL(1, first);
+	BOOST_CHECK_EQUAL(1, added);
+	BOOST_CHECK_EQUAL(0, timers.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,250 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "zmqpp/context.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/poller.hpp"
+#include "zmqpp/socket.hpp"
+#include "zmqpp/topic_dispatcher.hpp"
+
+BOOST_AUTO_TEST_SUITE( topic_dispatcher )
+
+const int max_poll_timeout = 1000;
+
+zmqpp::topic_dispatcher::handler record(std::vector<std::string>& calls, std::string const& name)
+{
+	return [&calls, name](zmqpp::message&) { calls.push_back(name); };
+}
+
+size_t dispatch(zmqpp::topic_dispatcher& dispatcher, std::string const& topic)
+{
+	zmqpp::message message;
+	message << topic << "body";
+	return dispatcher.dispatch(message);
+}
+
+BOOST_AUTO_TEST_CASE( prefixes_shortest_first )
+{
+	zmqpp::context context;
+	zmqpp::socket socket(context, zmqpp::socket_type::subscribe);
+	zmqpp::topic_dispatcher dispatcher(socket);
+
+	std::vector<std::string> calls;
+	dispatcher.subscribe("abc", record(calls, "abc"));
+	dispatcher.subscribe("", record(calls, "all"));
+	dispatcher.subscribe("a", record(calls, "a"));
+	dispatcher.subscribe("b", record(calls, "b"));
+	dispatcher.subscribe("ab", record(calls, "ab"));
+	BOOST_CHECK_EQUAL(5, dispatcher.topics());
+
+	BOOST_CHECK_EQUAL(4, dispatch(dispatcher, "abcd"));
+	BOOST_REQUIRE_EQUAL(4, calls.size());
+	BOOST_CHECK_EQUAL("all", calls[0]);
+	BOOST_CHECK_EQUAL("a", calls[1]);
+	BOOST_CHECK_EQUAL("ab", calls[2]);
+	BOOST_CHECK_EQUAL("abc", calls[3]);
+
+	calls.clear();
+	BOOST_CHECK_EQUAL(2, dispatch(dispatcher, "b"));
+	BOOST_CHECK_EQUAL(1, dispatch(dispatcher, "x"));
+	BOOST_CHECK_EQUAL(2, dispatch(dispatcher, "ac"));
+	BOOST_CHECK_EQUAL(2, dispatch(dispatcher, "a"));
+}
+
+BOOST_AUTO_TEST_CASE( unsubscribe_keeps_tree_consistent )
+{
+	zmqpp::context context;
+	zmqpp::socket socket(context, zmqpp::socket_type::subscribe);
+	zmqpp::topic_dispatcher dispatcher(socket);
+
+	std::vector<std::string> calls;
+	zmqpp::topic_dispatcher::subscription abc = dispatcher.subscribe("abc", record(calls, "abc"));
+	zmqpp::topic_dispatcher::subscription abd = dispatcher.subscribe("abd", record(calls, "abd"));
+	zmqpp::topic_dispatcher::subscription ab = dispatcher.subscribe("ab", record(calls, "ab"));
+	zmqpp::topic_dispatcher::subscription second = dispatcher.subscribe("ab", record(calls, "ab again"));
+	BOOST_CHECK_EQUAL(4, dispatcher.subscriptions());
+	BOOST_CHECK_EQUAL(3, dispatcher.topics());
+
+	dispatcher.unsubscribe(ab);
+	BOOST_CHECK_EQUAL(3, dispatcher.topics());
+	BOOST_CHECK_EQUAL(2, dispatch(dispatcher, "abcx"));
+
+	dispatcher.unsubscribe(second);
+	BOOST_CHECK_EQUAL(2, dispatcher.topics());
+	dispatcher.unsubscribe(second);
+	dispatcher.unsubscribe(12345);
+	BOOST_CHECK_EQUAL(2, dispatcher.subscriptions());
+
+	dispatcher.unsubscribe(abc);
+	BOOST_CHECK_EQUAL(0, dispatch(dispatcher, "abc"));
+	BOOST_CHECK_EQUAL(1, dispatch(dispatcher, "abd"));
+
+	dispatcher.unsubscribe(abd);
+	BOOST_CHECK_EQUAL(0, dispatcher.topics());
+	BOOST_CHECK_EQUAL(0, dispatch(dispatcher, "abd"));
+
+	// everything can be added back after the tree has been folded away
+	dispatcher.subscribe("abd", record(calls, "abd"));
+	BOOST_CHECK_EQUAL(1, dispatch(dispatcher, "abd"));
+}
+
+BOOST_AUTO_TEST_CASE( changes_during_dispatch )
+{
+	zmqpp::context context;
+	zmqpp::socket socket(context, zmqpp::socket_type::subscribe);
+	zmqpp::topic_dispatcher dispatcher(socket);
+
+	std::vector<std::string> calls;
+	zmqpp::topic_dispatcher::subscription longer = dispatcher.subscribe("abc", record(calls, "abc"));
+	dispatcher.subscribe("a", [&](zmqpp::message&) {
+		calls.push_back("a");
+		dispatcher.unsubscribe(longer);
+		dispatcher.subscribe("ab", record(calls, "ab"));
+	});
+
+	BOOST_CHECK_EQUAL(1, dispatch(dispatcher, "abc"));
+	BOOST_CHECK_EQUAL(1, calls.size());
+	BOOST_CHECK_EQUAL(2, dispatcher.topics());
+
+	calls.clear();
+	dispatch(dispatcher, "abc");
+	BOOST_REQUIRE(calls.size() >= 2);
+	BOOST_CHECK_EQUAL("a", calls[0]);
+	BOOST_CHECK_EQUAL("ab", calls[1]);
+}
+
+BOOST_AUTO_TEST_CASE( handler_unsubscribes_itself )
+{
+	zmqpp::context context;
+	zmqpp::socket socket(context, zmqpp::socket_type::subscribe);
+	zmqpp::topic_dispatcher dispatcher(socket);
+
+	// the captured string is only valid while the handler is alive, and the
+	// nested dispatch must not apply the unsubscribe before it returns
+	std::vector<std::string> calls;
+	zmqpp::topic_dispatcher::subscription self = 0;
+	std::string name(64, 'x');
+	self = dispatcher.subscribe("a", [&dispatcher, &calls, &self, name](zmqpp::message&) {
+		dispatcher.unsubscribe(self);
+		dispatch(dispatcher, "b");
+		calls.push_back(name);
+	});
+	dispatcher.subscribe("b", record(calls, "b"));
+
+	BOOST_CHECK_EQUAL(1, dispatch(dispatcher, "a"));
+	BOOST_REQUIRE_EQUAL(2, calls.size());
+	BOOST_CHECK_EQUAL("b", calls[0]);
+	BOOST_CHECK_EQUAL(name, calls[1]);
+	BOOST_CHECK_EQUAL(1, dispatcher.topics());
+	BOOST_CHECK_EQUAL(1, dispatcher.subscriptions());
+
+	calls.clear();
+	BOOST_CHECK_EQUAL(0, dispatch(dispatcher, "a"));
+	BOOST_CHECK(calls.empty());
+}
+
+bool matches_linear_scan(zmqpp::topic_dispatcher& dispatcher, std::vector<std::string> const& topics)
+{
+	bool matched = true;
+	for(int i = 0; i < 500; ++i)
+	{
+		std::string topic;
+		size_t length = std::rand() % 8;
+		for(size_t c = 0; c < length; ++c)
+		{
+			topic.push_back('a' + std::rand() % 3);
+		}
+
+		size_t expected = 0;
+		for(size_t t = 0; t < topics.size(); ++t)
+		{
+			if (0 == topic.compare(0, topics[t].size(), topics[t]))
+			{
+				++expected;
+			}
+		}
+
+		matched &= (expected == dispatch(dispatcher, topic));
+	}
+
+	return matched;
+}
+
+BOOST_AUTO_TEST_CASE( random_topics )
+{
+	zmqpp::context context;
+	zmqpp::socket socket(context, zmqpp::socket_type::subscribe);
+	zmqpp::topic_dispatcher dispatcher(socket);
+
+	std::srand(42);
+	std::vector<std::string> topics;
+	std::vector<zmqpp::topic_dispatcher::subscription> ids;
+	for(int i = 0; i < 2000; ++i)
+	{
+		std::string topic;
+		size_t length = 1 + std::rand() % 6;
+		for(size_t c = 0; c < length; ++c)
+		{
+			topic.push_back('a' + std::rand() % 3);
+		}
+
+		topics.push_back(topic);
+		ids.push_back(dispatcher.subscribe(topic, [](zmqpp::message&) { }));
+	}
+
+	BOOST_CHECK(matches_linear_scan(dispatcher, topics));
+
+	// removing every other subscription splits and folds plenty of edges
+	std::vector<std::string> remaining;
+	for(size_t i = 0; i < ids.size(); ++i)
+	{
+		if (0 == i % 2)
+		{
+			dispatcher.unsubscribe(ids[i]);
+		}
+		else
+		{
+			remaining.push_back(topics[i]);
+		}
+	}
+
+	BOOST_CHECK_EQUAL(remaining.size(), dispatcher.subscriptions());
+	BOOST_CHECK(matches_linear_scan(dispatcher, remaining));
+}
+
+BOOST_AUTO_TEST_CASE( subscribes_socket )
+{
+	zmqpp::context context;
+
+	zmqpp::socket publisher(context, zmqpp::socket_type::publish);
+	publisher.bind("inproc://test");
+
+	zmqpp::socket subscriber(context, zmqpp::socket_type::subscribe);
+	subscriber.connect("inproc://test");
+
+	zmqpp::topic_dispatcher dispatcher(subscriber);
+	std::vector<std::string> calls;
+	dispatcher.subscribe("wanted", record(calls, "wanted"));
+
+	zmqpp::poller poller;
+	poller.add(subscriber);
+
+	for(int attempt = 0; (attempt < 100) && calls.empty(); ++attempt)
+	{
+		publisher.send("other topic");
+		publisher.send("wanted topic");
+
+		while(poller.poll(10))
+		{
+			BOOST_CHECK(dispatcher.receive(true));
+		}
+	}
+
+	BOOST_CHECK(!calls.empty());
+	BOOST_CHECK(!dispatcher.receive(true));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
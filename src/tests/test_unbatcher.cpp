@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include "zmqpp/batcher.hpp"
+#include "zmqpp/context.hpp"
+#include "zmqpp/exception.hpp"
+#include "zmqpp/message.hpp"
+#include "zmqpp/socket.hpp"
+#include "zmqpp/unbatcher.hpp"
+
+BOOST_AUTO_TEST_SUITE( unbatcher )
+
+BOOST_AUTO_TEST_CASE( passes_plain_messages )
+{
+	zmqpp::context context;
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.bind("inproc://test");
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.connect("inproc://test");
+
+	zmqpp::message sent;
+	sent << zmqpp::batcher::marker << "not a batch" << "three";
+	pusher.send(sent);
+
+	zmqpp::unbatcher unbatcher(puller);
+	zmqpp::message message;
+	BOOST_REQUIRE(unbatcher.receive(message));
+	BOOST_CHECK_EQUAL(3, message.parts());
+	BOOST_CHECK_EQUAL(0, unbatcher.pending());
+}
+
+BOOST_AUTO_TEST_CASE( rejects_malformed_batches )
+{
+	zmqpp::context context;
+
+	zmqpp::socket pusher(context, zmqpp::socket_type::push);
+	pusher.bind("inproc://test");
+
+	zmqpp::socket puller(context, zmqpp::socket_type::pull);
+	puller.connect("inproc://test");
+
+	zmqpp::unbatcher unbatcher(puller);
+	zmqpp::message message;
+
+	// truncated length
+	message << zmqpp::batcher::marker << std::string("\0\0", 2);
+	pusher.send(message);
+	BOOST_CHECK_THROW(unbatcher.receive(message), zmqpp::exception);
+
+	// part runs past the end
+	message << zmqpp::batcher::marker << std::string("\0\0\0\1\0\0\0\11short", 13);
+	pusher.send(message);
+	BOOST_CHECK_THROW(unbatcher.receive(message), zmqpp::exception);
+
+	// empty batch
+	message << zmqpp::batcher::marker << std::string();
+	pusher.send(message);
+	BOOST_CHECK_THROW(unbatcher.receive(message), zmqpp::exception);
+
+	BOOST_CHECK_EQUAL(0, unbatcher.pending());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
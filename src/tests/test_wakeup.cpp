@@ -0,0 +1,56 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fcntl.h>
+
+#include "zmqpp/poller.hpp"
+#include "zmqpp/wakeup.hpp"
+
+BOOST_AUTO_TEST_SUITE( wakeup )
+
+const int max_poll_timeout = 1000;
+
+BOOST_AUTO_TEST_CASE( descriptor_is_nonblocking_and_close_on_exec )
+{
+	zmqpp::wakeup wakeup;
+
+	BOOST_CHECK(fcntl(wakeup.file_descriptor(), F_GETFL) & O_NONBLOCK);
+	BOOST_CHECK(fcntl(wakeup.file_descriptor(), F_GETFD) & FD_CLOEXEC);
+}
+
+BOOST_AUTO_TEST_CASE( signal_readable_until_drained )
+{
+	zmqpp::wakeup wakeup;
+
+	zmqpp::poller poller;
+	poller.add(wakeup.file_descriptor());
+
+	BOOST_CHECK(!poller.poll(0));
+	BOOST_CHECK(!wakeup.drain());
+
+	wakeup.signal();
+	wakeup.signal();
+
+	BOOST_REQUIRE(poller.poll(max_poll_timeout));
+	BOOST_CHECK(poller.has_input(wakeup.file_descriptor()));
+	BOOST_CHECK(poller.poll(0));
+
+	BOOST_CHECK(wakeup.drain());
+	BOOST_CHECK(!wakeup.drain());
+	BOOST_CHECK(!poller.poll(0));
+}
+
+BOOST_AUTO_TEST_CASE( signal_never_blocks )
+{
+	zmqpp::wakeup wakeup;
+
+	// well past any pipe buffer
+	for(int i = 0; i < 1000000; ++i)
+	{
+		wakeup.signal();
+	}
+
+	BOOST_CHECK(wakeup.drain());
+	BOOST_CHECK(!wakeup.drain());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
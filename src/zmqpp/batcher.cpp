@@ -0,0 +1,180 @@
+#include <stdexcept>
+
+#include "exception.hpp"
+#include "inet.hpp"
+#include "socket.hpp"
+#include "batcher.hpp"
+
+namespace zmqpp
+{
+
+const std::string batcher::marker("\0zmqpp-batch", 12);
+
+batcher::batcher(socket& socket, size_t const& batch_size /* = 8192 */,
+		std::chrono::microseconds const& delay /* = std::chrono::microseconds(1000) */,
+		size_t const& small_message /* = 512 */, bool const& adaptive /* = true */)
+	: _socket(socket)
+	, _batch_size(batch_size)
+	, _delay(delay)
+	, _small_message(small_message)
+	, _adaptive(adaptive)
+	, _buffer()
+	, _pending(0)
+	, _oldest()
+	, _last_send()
+	, _stats()
+{
+	_buffer.reserve(batch_size + small_message);
+}
+
+batcher::~batcher()
+{
+	try
+	{
+		flush();
+	}
+	catch(...)
+	{
+		// nowhere to report a failure from here
+	}
+}
+
+void batcher::send(message& message)
+{
+	if (message.parts() == 0)
+	{
+		throw std::invalid_argument("sending requires messages have at least one part");
+	}
+
+	++_stats.messages;
+
+	// Packed size, a part count then a length before each part
+	size_t size = sizeof(uint32_t) * (1 + message.parts());
+	for(size_t i = 0; i < message.parts(); ++i)
+	{
+		size += message.size(i);
+	}
+
+	clock_type::time_point now = clock_type::now();
+
+	// Large messages gain nothing from batching but must not overtake what is batched
+	if (size > _small_message)
+	{
+		flush();
+		_socket.send(message);
+		_last_send = now;
+		++_stats.direct;
+		return;
+	}
+
+	if (_adaptive && (0 == _pending) && (now - _last_send >= _delay))
+	{
+		_socket.send(message);
+		_last_send = now;
+		++_stats.direct;
+		return;
+	}
+
+	if ((_pending > 0) && (_buffer.size() + size > _batch_size))
+	{
+		flush();
+	}
+
+	if (0 == _pending)
+	{
+		_oldest = now;
+	}
+
+	append(message);
+	++_pending;
+	message = message_t();
+
+	if ((_buffer.size() >= _batch_size) || (now - _oldest >= _delay))
+	{
+		flush();
+	}
+}
+
+void batcher::send(std::string const& string)
+{
+	message message;
+	message << string;
+
+	send(message);
+}
+
+bool batcher::flush()
+{
+	if (0 == _pending)
+	{
+		return false;
+	}
+
+	message batch;
+	batch.add(marker.data(), marker.size());
+	batch.add(_buffer.data(), _buffer.size());
+	_socket.send(batch);
+
+	_stats.batched += _pending;
+	++_stats.batches;
+
+	_buffer.clear();
+	_pending = 0;
+	_last_send = clock_type::now();
+
+	return true;
+}
+
+bool batcher::expire()
+{
+	if ((0 == _pending) || (clock_type::now() - _oldest < _delay))
+	{
+		return false;
+	}
+
+	return flush();
+}
+
+long batcher::timeout() const
+{
+	if (0 == _pending)
+	{
+		return -1;
+	}
+
+	clock_type::duration remaining = (_oldest + _delay) - clock_type::now();
+	if (remaining <= clock_type::duration::zero())
+	{
+		return 0;
+	}
+
+	return std::chrono::duration_cast<std::chrono::milliseconds>(remaining + std::chrono::milliseconds(1) - clock_type::duration(1)).count();
+}
+
+size_t batcher::pending() const
+{
+	return _pending;
+}
+
+batcher::statistics batcher::stats() const
+{
+	return _stats;
+}
+
+void batcher::append(message& message)
+{
+	append(static_cast<uint32_t>(message.parts()));
+	for(size_t i = 0; i < message.parts(); ++i)
+	{
+		append(static_cast<uint32_t>(message.size(i)));
+		_buffer.append(static_cast<char const*>(message.raw_data(i)), message.size(i));
+	}
+}
+
+void batcher::append(uint32_t const& value)
+{
+	uint32_t network = htonl(value);
+	_buffer.append(reinterpret_cast<char const*>(&network), sizeof(network));
+}
+
+}
@@ -0,0 +1,151 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_BATCHER_HPP_
+#define ZMQPP_BATCHER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Packs many small messages into a single batch message before sending.
+ *
+ * When the per message cost of 0mq dominates, because messages are tiny and
+ * numerous, a batcher collects them into one frame and sends that when it
+ * reaches the batch size or the oldest message in it reaches the delay. An
+ * unbatcher on the receiving side hands the original messages back one at
+ * a time, in order.
+ *
+ * Messages larger than the small message limit are sent as they are, after
+ * anything already batched, and so are messages the unbatcher sees without
+ * the batch marker, so batched and plain senders can share a receiver.
+ *
+ * In adaptive mode, the default, a message arriving when nothing is batched
+ * and nothing has been sent for at least the delay is sent straight away.
+ * Under light load every message goes out immediately and batching only
+ * starts once messages arrive faster than the delay.
+ *
+ * The delay is only checked when sending, so a caller with nothing more to
+ * send must call expire after timeout milliseconds or flush itself.
+ */
+class batcher
+{
+public:
+	typedef std::chrono::steady_clock clock_type; /*!< Clock delays are measured with. */
+
+	static const std::string marker; /*!< first part of every batch message */
+
+	/*!
+	 * Counters for the batcher.
+	 */
+	struct statistics
+	{
+		uint64_t messages; /*!< messages given to send */
+		uint64_t batched;  /*!< messages that went out inside a batch */
+		uint64_t batches;  /*!< batch messages sent */
+		uint64_t direct;   /*!< messages sent as they were */
+	};
+
+	/*!
+	 * Create a batcher for a socket.
+	 *
+	 * \param socket the socket to send on, which must outlive the batcher.
+	 * \param batch_size bytes of packed messages that trigger a send.
+	 * \param delay longest a message waits in a batch.
+	 * \param small_message largest message in bytes that is batched.
+	 * \param adaptive send immediately when the socket has been idle.
+	 */
+	batcher(socket_t& socket, size_t const& batch_size = 8192,
+			std::chrono::microseconds const& delay = std::chrono::microseconds(1000),
+			size_t const& small_message = 512, bool const& adaptive = true);
+
+	/*!
+	 * Cleanup the batcher, anything batched is sent first.
+	 */
+	~batcher();
+
+	/*!
+	 * Batch or send a message.
+	 *
+	 * \param message the message to send, emptied.
+	 */
+	void send(message_t& message);
+
+	/*!
+	 * Batch or send a single part message.
+	 *
+	 * \param string the message content.
+	 */
+	void send(std::string const& string);
+
+	/*!
+	 * Send anything batched now.
+	 *
+	 * \return true if a batch was sent.
+	 */
+	bool flush();
+
+	/*!
+	 * Send the batch if its oldest message has waited for the delay.
+	 *
+	 * \return true if a batch was sent.
+	 */
+	bool expire();
+
+	/*!
+	 * Get how long until the batch must be sent.
+	 *
+	 * \return milliseconds until expire will send, rounded up, or -1 if nothing is batched.
+	 */
+	long timeout() const;
+
+	/*!
+	 * Get the number of messages waiting in the batch.
+	 *
+	 * \return batched message count.
+	 */
+	size_t pending() const;
+
+	/*!
+	 * Get the batcher counters.
+	 *
+	 * \return the counters so far.
+	 */
+	statistics stats() const;
+
+private:
+	socket_t& _socket;
+	size_t _batch_size;
+	clock_type::duration _delay;
+	size_t _small_message;
+	bool _adaptive;
+
+	std::string _buffer;
+	size_t _pending;
+	clock_type::time_point _oldest;
+	clock_type::time_point _last_send;
+	statistics _stats;
+
+	void append(message_t& message);
+	void append(uint32_t const& value);
+
+	// No copy - private and not implemented
+	batcher(batcher const&);
+	batcher& operator=(batcher const&);
+};
+
+}
+
+#endif /* ZMQPP_BATCHER_HPP_ */
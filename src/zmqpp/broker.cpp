@@ -0,0 +1,454 @@
+#include <cerrno>
+
+#include <zmq.h>
+
+#include "exception.hpp"
+#include "socket.hpp"
+#include "broker.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+// Most messages routed from one socket before the other gets a turn
+const size_t batch_size = 256;
+
+int receive_frame(zmq_msg_t& frame, void* socket, int const& flags)
+{
+#if (ZMQ_VERSION_MAJOR == 3) and (ZMQ_VERSION_MINOR == 0)
+	return zmq_recvmsg(socket, &frame, flags);
+#else
+	return zmq_msg_recv(&frame, socket, flags);
+#endif
+}
+
+int send_frame(zmq_msg_t& frame, void* socket, int const& flags)
+{
+#if (ZMQ_VERSION_MAJOR == 3) and (ZMQ_VERSION_MINOR == 0)
+	return zmq_sendmsg(socket, &frame, flags);
+#else
+	return zmq_msg_send(&frame, socket, flags);
+#endif
+}
+
+bool has_more(void* socket)
+{
+	int more = 0;
+	size_t more_size = sizeof(more);
+	zmq_getsockopt(socket, ZMQ_RCVMORE, &more, &more_size);
+
+	return 0 != more;
+}
+
+bool frame_is(zmq_msg_t& frame, std::string const& signal)
+{
+	return (zmq_msg_size(&frame) == signal.size())
+		&& (0 == signal.compare(0, signal.size(), static_cast<char const*>(zmq_msg_data(&frame)), signal.size()));
+}
+
+// Moves the frame, and everything after it in the same message, without copying the data
+void forward(zmq_msg_t& frame, bool more, void* source, void* sink)
+{
+	while(true)
+	{
+		if (send_frame(frame, sink, more ? ZMQ_SNDMORE : 0) < 0)
+		{
+			throw zmq_internal_exception();
+		}
+
+		if (!more)
+		{
+			return;
+		}
+
+		if (receive_frame(frame, source, 0) < 0)
+		{
+			throw zmq_internal_exception();
+		}
+
+		more = has_more(source);
+	}
+}
+
+}
+
+const std::string broker::ready_signal("\001", 1);
+const std::string broker::heartbeat_signal("\002", 1);
+
+broker::broker(socket& frontend, socket& backend, long const& heartbeat_interval /* = 1000 */,
+		size_t const& liveness /* = 3 */, size_t const& backlog_limit /* = 10000 */)
+	: _frontend(frontend)
+	, _backend(backend)
+	, _heartbeat_interval(std::chrono::milliseconds(heartbeat_interval))
+	, _expiry_interval(std::chrono::milliseconds(heartbeat_interval * liveness))
+	, _backlog_limit(backlog_limit)
+	, _poller()
+	, _running(true)
+	, _workers()
+	, _ready_front(nullptr)
+	, _ready_back(nullptr)
+	, _ready_count(0)
+	, _backlog()
+	, _next_heartbeat(clock_type::now() + _heartbeat_interval)
+	, _stats()
+{
+	if ((socket_type::router != frontend.type()) || (socket_type::router != backend.type()))
+	{
+		throw exception("broker frontend and backend must both be router sockets");
+	}
+
+	if ((heartbeat_interval <= 0) || (0 == liveness))
+	{
+		throw exception("broker heartbeat interval and liveness must be positive");
+	}
+
+	_poller.add(_backend);
+	_poller.add(_frontend);
+	_poller.add(_wakeup.file_descriptor());
+}
+
+broker::~broker()
+{
+}
+
+bool broker::poll(long timeout /* = poller::WAIT_FOREVER */)
+{
+	// Stop reading clients once there is nowhere left to put their requests
+	bool accepting = (_ready_count > 0) || (_backlog.size() < _backlog_limit);
+	_poller.check_for(_frontend, accepting ? poller::POLL_IN : poller::POLL_NONE);
+
+	clock_type::time_point now = clock_type::now();
+	long until_heartbeat = 0;
+	if (_next_heartbeat > now)
+	{
+		until_heartbeat = std::chrono::duration_cast<std::chrono::milliseconds>(_next_heartbeat - now).count() + 1;
+	}
+
+	if ((poller::WAIT_FOREVER == timeout) || (until_heartbeat < timeout))
+	{
+		timeout = until_heartbeat;
+	}
+
+	size_t routed = 0;
+	if (_poller.poll(timeout))
+	{
+		if (_poller.has_input(_wakeup.file_descriptor()))
+		{
+			_wakeup.drain();
+		}
+
+		if (_poller.has_input(_backend))
+		{
+			routed += route_replies();
+		}
+
+		if (_poller.has_input(_frontend))
+		{
+			routed += route_requests();
+		}
+	}
+
+	if (clock_type::now() >= _next_heartbeat)
+	{
+		heartbeat();
+	}
+
+	return routed > 0;
+}
+
+void broker::run()
+{
+	while(_running.load())
+	{
+		poll();
+	}
+}
+
+void broker::stop()
+{
+	_running.store(false);
+
+	_wakeup.signal();
+}
+
+size_t broker::ready_workers() const
+{
+	return _ready_count;
+}
+
+size_t broker::workers() const
+{
+	return _workers.size();
+}
+
+size_t broker::backlog() const
+{
+	return _backlog.size();
+}
+
+broker::statistics broker::stats() const
+{
+	return _stats;
+}
+
+size_t broker::route_replies()
+{
+	void* source = static_cast<void*>(_backend);
+	void* sink = static_cast<void*>(_frontend);
+
+	zmq_msg_t frame;
+	zmq_msg_init(&frame);
+
+	size_t routed = 0;
+	try
+	{
+		for(size_t count = 0; count < batch_size; ++count)
+		{
+			if (receive_frame(frame, source, ZMQ_DONTWAIT) < 0)
+			{
+				if (EAGAIN == zmq_errno())
+				{
+					break;
+				}
+
+				throw zmq_internal_exception();
+			}
+
+			if (!has_more(source))
+			{
+				// Nothing but an identity, not something a worker would send
+				continue;
+			}
+
+			std::string identity(static_cast<char const*>(zmq_msg_data(&frame)), zmq_msg_size(&frame));
+			worker* sender = seen(identity);
+
+			if (receive_frame(frame, source, 0) < 0)
+			{
+				throw zmq_internal_exception();
+			}
+
+			bool more = has_more(source);
+			if (!more && frame_is(frame, heartbeat_signal))
+			{
+				continue;
+			}
+
+			if (!more && frame_is(frame, ready_signal))
+			{
+				push_ready(sender);
+				continue;
+			}
+
+			forward(frame, more, source, sink);
+			++_stats.replies;
+			++routed;
+
+			push_ready(sender);
+		}
+	}
+	catch(...)
+	{
+		zmq_msg_close(&frame);
+		throw;
+	}
+
+	zmq_msg_close(&frame);
+
+	// Workers that just freed up take the oldest waiting requests first
+	while((_ready_count > 0) && !_backlog.empty())
+	{
+		dispatch(pop_ready(), _backlog.front());
+		_backlog.pop_front();
+	}
+
+	return routed;
+}
+
+size_t broker::route_requests()
+{
+	void* source = static_cast<void*>(_frontend);
+	void* sink = static_cast<void*>(_backend);
+
+	size_t routed = 0;
+	while(routed < batch_size)
+	{
+		if ((_ready_count > 0) && _backlog.empty())
+		{
+			zmq_msg_t frame;
+			zmq_msg_init(&frame);
+
+			try
+			{
+				if (receive_frame(frame, source, ZMQ_DONTWAIT) < 0)
+				{
+					if (EAGAIN != zmq_errno())
+					{
+						throw zmq_internal_exception();
+					}
+
+					zmq_msg_close(&frame);
+					break;
+				}
+
+				worker* target = pop_ready();
+				_backend.send(target->identity, socket::SEND_MORE);
+				forward(frame, has_more(source), source, sink);
+			}
+			catch(...)
+			{
+				zmq_msg_close(&frame);
+				throw;
+			}
+
+			zmq_msg_close(&frame);
+			++_stats.requests;
+		}
+		else if (_backlog.size() < _backlog_limit)
+		{
+			message request;
+			if (!_frontend.receive(request, true))
+			{
+				break;
+			}
+
+			_backlog.push_back(std::move(request));
+			++_stats.backlogged;
+		}
+		else
+		{
+			break;
+		}
+
+		++routed;
+	}
+
+	return routed;
+}
+
+void broker::dispatch(worker* target, message& request)
+{
+	_backend.send(target->identity, socket::SEND_MORE);
+	_backend.send(request);
+	++_stats.requests;
+}
+
+void broker::heartbeat()
+{
+	clock_type::time_point now = clock_type::now();
+
+	// Busy workers do not heartbeat so only idle ones can expire
+	for(worker* target = _ready_front; nullptr != target; )
+	{
+		worker* next = target->next;
+
+		if (target->expiry < now)
+		{
+			forget(target);
+			++_stats.evicted;
+		}
+		else
+		{
+			_backend.send(target->identity, socket::SEND_MORE);
+			_backend.send(heartbeat_signal);
+		}
+
+		target = next;
+	}
+
+	_next_heartbeat = now + _heartbeat_interval;
+}
+
+broker::worker* broker::seen(std::string const& identity)
+{
+	auto it = _workers.find(identity);
+	if (_workers.end() == it)
+	{
+		worker fresh;
+		fresh.identity = identity;
+		fresh.previous = nullptr;
+		fresh.next = nullptr;
+		fresh.ready = false;
+
+		it = _workers.insert(std::make_pair(identity, fresh)).first;
+	}
+
+	worker* target = &(*it).second;
+	target->expiry = clock_type::now() + _expiry_interval;
+
+	return target;
+}
+
+void broker::forget(worker* target)
+{
+	if (target->ready)
+	{
+		unlink_ready(target);
+	}
+
+	// Copied as the key must outlive the erase
+	std::string identity = target->identity;
+	_workers.erase(identity);
+}
+
+void broker::push_ready(worker* target)
+{
+	if (target->ready)
+	{
+		return;
+	}
+
+	target->ready = true;
+	target->previous = _ready_back;
+	target->next = nullptr;
+
+	if (nullptr == _ready_back)
+	{
+		_ready_front = target;
+	}
+	else
+	{
+		_ready_back->next = target;
+	}
+
+	_ready_back = target;
+	++_ready_count;
+}
+
+broker::worker* broker::pop_ready()
+{
+	worker* target = _ready_front;
+	unlink_ready(target);
+
+	return target;
+}
+
+void broker::unlink_ready(worker* target)
+{
+	if (nullptr == target->previous)
+	{
+		_ready_front = target->next;
+	}
+	else
+	{
+		target->previous->next = target->next;
+	}
+
+	if (nullptr == target->next)
+	{
+		_ready_back = target->previous;
+	}
+	else
+	{
+		target->next->previous = target->previous;
+	}
+
+	target->previous = nullptr;
+	target->next = nullptr;
+	target->ready = false;
+	--_ready_count;
+}
+
+}
@@ -0,0 +1,187 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_BROKER_HPP_
+#define ZMQPP_BROKER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+#include "poller.hpp"
+#include "wakeup.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Load balancing broker handing each request to the least recently used
+ * ready worker.
+ *
+ * Both sockets must be routers. Clients connect to the frontend with request
+ * or dealer sockets and are not aware of the broker. Workers connect to the
+ * backend with dealer sockets and speak a small protocol, every message to
+ * or from a worker starts with the worker's identity which the dealer adds
+ * and removes itself:
+ *
+ * \li worker sends ready_signal once connected to get its first request.
+ * \li broker sends the client envelope, an empty frame and the request.
+ * \li worker replies with that envelope, an empty frame and the reply, and
+ *     is then ready again.
+ * \li either side sends heartbeat_signal every heartbeat interval while the
+ *     worker is idle.
+ *
+ * An idle worker not heard from for liveness heartbeat intervals is
+ * forgotten. A worker busy with a request is left alone however long the
+ * request takes.
+ * Requests arriving while no worker is ready are held in order up to the
+ * backlog limit, after which the frontend is no longer read until a worker
+ * frees up.
+ *
+ * The broker uses the sockets from whichever thread calls run or poll, the
+ * sockets must not be used elsewhere meanwhile. Only stop is safe to call
+ * from other threads.
+ */
+class broker
+{
+public:
+	static const std::string ready_signal;     /*!< first message from a new worker */
+	static const std::string heartbeat_signal; /*!< keep alive sent both ways between idle workers and the broker */
+
+	/*!
+	 * Counters for the broker, read from the broker thread or once stopped.
+	 */
+	struct statistics
+	{
+		uint64_t requests;   /*!< requests handed to workers */
+		uint64_t replies;    /*!< replies returned to clients */
+		uint64_t backlogged; /*!< requests that had to wait for a worker */
+		uint64_t evicted;    /*!< idle workers forgotten for missing heartbeats */
+	};
+
+	/*!
+	 * Create a broker between two router sockets.
+	 *
+	 * \param frontend router socket clients connect to.
+	 * \param backend router socket workers connect to.
+	 * \param heartbeat_interval milliseconds between heartbeats.
+	 * \param liveness heartbeats a worker can miss before being forgotten.
+	 * \param backlog_limit most requests held while no worker is ready.
+	 */
+	broker(socket_t& frontend, socket_t& backend, long const& heartbeat_interval = 1000,
+			size_t const& liveness = 3, size_t const& backlog_limit = 10000);
+
+	/*!
+	 * Cleanup the broker, the sockets are left open and any backlog is dropped.
+	 */
+	~broker();
+
+	/*!
+	 * Wait for messages and route everything that has arrived.
+	 *
+	 * Heartbeats and evictions are also handled here, so the wait is cut
+	 * short when the next heartbeat is due.
+	 *
+	 * \param timeout milliseconds to wait, or poller::WAIT_FOREVER.
+	 * \return true if any messages were routed.
+	 */
+	bool poll(long timeout = poller::WAIT_FOREVER);
+
+	/*!
+	 * Route messages until stop is called.
+	 */
+	void run();
+
+	/*!
+	 * Make run return, safe to call from any thread.
+	 *
+	 * Stopping is final, any later run returns straight away.
+	 */
+	void stop();
+
+	/*!
+	 * Get the number of workers waiting for a request.
+	 *
+	 * \return ready worker count.
+	 */
+	size_t ready_workers() const;
+
+	/*!
+	 * Get the number of workers known to the broker, ready or busy.
+	 *
+	 * \return worker count.
+	 */
+	size_t workers() const;
+
+	/*!
+	 * Get the number of requests waiting for a worker.
+	 *
+	 * \return backlog size.
+	 */
+	size_t backlog() const;
+
+	/*!
+	 * Get the broker counters.
+	 *
+	 * \return the counters so far.
+	 */
+	statistics stats() const;
+
+private:
+	typedef std::chrono::steady_clock clock_type;
+
+	struct worker
+	{
+		std::string identity;
+		clock_type::time_point expiry;
+		worker* previous;
+		worker* next;
+		bool ready;
+	};
+
+	socket_t& _frontend;
+	socket_t& _backend;
+	clock_type::duration _heartbeat_interval;
+	clock_type::duration _expiry_interval;
+	size_t _backlog_limit;
+	poller _poller;
+	wakeup _wakeup;
+	std::atomic<bool> _running;
+
+	std::unordered_map<std::string, worker> _workers;
+	worker* _ready_front; // least recently used
+	worker* _ready_back;
+	size_t _ready_count;
+
+	std::deque<message_t> _backlog;
+	clock_type::time_point _next_heartbeat;
+	statistics _stats;
+
+	size_t route_replies();
+	size_t route_requests();
+	void dispatch(worker* target, message_t& request);
+	void heartbeat();
+	worker* seen(std::string const& identity);
+	void forget(worker* target);
+	void push_ready(worker* target);
+	worker* pop_ready();
+	void unlink_ready(worker* target);
+
+	// No copy - private and not implemented
+	broker(broker const&);
+	broker& operator=(broker const&);
+};
+
+}
+
+#endif /* ZMQPP_BROKER_HPP_ */
@@ -0,0 +1,216 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include <poll.h>
+
+#include "exception.hpp"
+#include "channel.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+// How many times a full channel is retried before the producer starts yielding, then sleeping
+const int spin_attempts = 64;
+const int yield_attempts = 64;
+const std::chrono::microseconds full_sleep(50);
+
+}
+
+const size_t channel::cache_line;
+
+channel::channel(size_t const& capacity /* = 1024 */)
+	: _mask(0)
+	, _ring()
+	, _armed(false)
+	, _owed(false)
+	, _head(0)
+	, _cached_tail(0)
+	, _tail(0)
+	, _cached_head(0)
+	, _parked(false)
+{
+	size_t size = 2;
+	while(size < capacity)
+	{
+		size <<= 1;
+	}
+
+	_mask = size - 1;
+	_ring.reset(new message[size]);
+
+}
+
+channel::~channel()
+{
+}
+
+bool channel::send(message& message, bool const& dont_block /* = false */)
+{
+	if (message.parts() == 0)
+	{
+		throw std::invalid_argument("sending requires messages have at least one part");
+	}
+
+	for(int attempt = 0; !push(message); ++attempt)
+	{
+		if (dont_block)
+		{
+			return false;
+		}
+
+		if (attempt < spin_attempts)
+		{
+			continue;
+		}
+
+		if (attempt < spin_attempts + yield_attempts)
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			std::this_thread::sleep_for(full_sleep);
+		}
+	}
+
+	// Only a parked consumer needs a system call to wake it
+	if (_parked.load() && _parked.exchange(false))
+	{
+		_wakeup.signal();
+	}
+
+	return true;
+}
+
+bool channel::send(std::string const& string, bool const& dont_block /* = false */)
+{
+	message message;
+	message << string;
+
+	return send(message, dont_block);
+}
+
+bool channel::receive(message& message, bool const& dont_block /* = false */)
+{
+	if (message.parts() > 0)
+	{
+		throw exception("receiving can only be done to empty messages");
+	}
+
+	while(true)
+	{
+		if (pop(message))
+		{
+			return true;
+		}
+
+		// Park before the last look so the producer either sees us parked or we see its message
+		park();
+
+		if (pop(message))
+		{
+			return true;
+		}
+
+		if (dont_block)
+		{
+			return false;
+		}
+
+		wait();
+	}
+}
+
+bool channel::receive(std::string& string, bool const& dont_block /* = false */)
+{
+	message message;
+	if (!receive(message, dont_block))
+	{
+		return false;
+	}
+
+	string = message.get(0);
+	return true;
+}
+
+int channel::file_descriptor() const
+{
+	return _wakeup.file_descriptor();
+}
+
+size_t channel::capacity() const
+{
+	return _mask + 1;
+}
+
+bool channel::push(message& message)
+{
+	size_t head = _head.load(std::memory_order_relaxed);
+	if (head - _cached_tail > _mask)
+	{
+		_cached_tail = _tail.load(std::memory_order_acquire);
+		if (head - _cached_tail > _mask)
+		{
+			return false;
+		}
+	}
+
+	// swapped so the producer is left holding the slot's empty message
+	_ring[head & _mask] = std::move(message);
+	_head.store(head + 1);
+
+	return true;
+}
+
+bool channel::pop(message& message)
+{
+	size_t tail = _tail.load(std::memory_order_relaxed);
+	if (tail == _cached_head)
+	{
+		_cached_head = _head.load();
+		if (tail == _cached_head)
+		{
+			return false;
+		}
+	}
+
+	message = std::move(_ring[tail & _mask]);
+	_tail.store(tail + 1, std::memory_order_release);
+
+	return true;
+}
+
+void channel::park()
+{
+	// The producer cleared our last park so it has written, or is about to write, a wake up
+	if (_armed && !_parked.load())
+	{
+		_owed = true;
+	}
+
+	// Keep trying on later parks if the wake up had not arrived yet
+	if (_owed)
+	{
+		_owed = !_wakeup.drain();
+	}
+
+	_parked.store(true);
+	_armed = true;
+}
+
+void channel::wait()
+{
+	pollfd item;
+	item.fd = _wakeup.file_descriptor();
+	item.events = POLLIN;
+	item.revents = 0;
+
+	while((::poll(&item, 1, -1) < 0) && (EINTR == errno)) { }
+}
+
+}
@@ -0,0 +1,140 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_CHANNEL_HPP_
+#define ZMQPP_CHANNEL_HPP_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+#include "wakeup.hpp"
+
+namespace zmqpp
+{
+
+typedef message message_t;
+
+/*!
+ * Single producer, single consumer message channel within one process.
+ *
+ * An alternative to a pair of inproc sockets for pipeline stages in the same
+ * process that does not go through libzmq at all. Messages are moved through
+ * a lock free ring so no message data is copied, and the producer and
+ * consumer indexes live on separate cache lines.
+ *
+ * The consumer is only woken through a file descriptor when it has parked,
+ * which is whenever a receive finds the channel empty. While messages keep
+ * flowing no system calls are made.
+ *
+ * The file descriptor can be added to a poller or reactor. Once it reports
+ * input keep calling receive without blocking until it returns false.
+ *
+ * Exactly one thread may send and one thread may receive at a time.
+ */
+class channel
+{
+public:
+	/*!
+	 * Create an empty channel.
+	 *
+	 * \param capacity most messages waiting, rounded up to a power of two.
+	 */
+	channel(size_t const& capacity = 1024);
+
+	/*!
+	 * Cleanup the channel, any messages waiting are dropped.
+	 */
+	~channel();
+
+	/*!
+	 * Send a message to the consumer.
+	 *
+	 * If the channel is full this waits for room unless dont_block is set.
+	 *
+	 * \param message message to send, emptied on success.
+	 * \param dont_block return rather than wait when the channel is full.
+	 * \return true if sent, false if the channel was full and the message is unchanged.
+	 */
+	bool send(message_t& message, bool const& dont_block = false);
+
+	/*!
+	 * Send a single part message.
+	 *
+	 * \param string the message content.
+	 * \param dont_block return rather than wait when the channel is full.
+	 * \return true if sent, false if the channel was full.
+	 */
+	bool send(std::string const& string, bool const& dont_block = false);
+
+	/*!
+	 * Receive the next message.
+	 *
+	 * If the channel is empty this waits for a message unless dont_block is
+	 * set.
+	 *
+	 * \param message empty message to receive into.
+	 * \param dont_block return rather than wait when the channel is empty.
+	 * \return true if a message was received, false if the channel was empty.
+	 */
+	bool receive(message_t& message, bool const& dont_block = false);
+
+	/*!
+	 * Receive the first part of the next message as a string.
+	 *
+	 * \param string string to receive into.
+	 * \param dont_block return rather than wait when the channel is empty.
+	 * \return true if a message was received, false if the channel was empty.
+	 */
+	bool receive(std::string& string, bool const& dont_block = false);
+
+	/*!
+	 * Get the descriptor that becomes readable when a parked consumer has
+	 * messages waiting.
+	 *
+	 * \return file descriptor suitable for poller::add.
+	 */
+	int file_descriptor() const;
+
+	/*!
+	 * Get the most messages that can be waiting.
+	 *
+	 * \return channel capacity.
+	 */
+	size_t capacity() const;
+
+private:
+	static const size_t cache_line = 64;
+
+	size_t _mask;
+	std::unique_ptr<message_t[]> _ring;
+	wakeup _wakeup;
+	bool _armed;
+	bool _owed;
+
+	char _pad_front[cache_line];
+	std::atomic<size_t> _head; // next slot the producer writes
+	size_t _cached_tail;
+	char _pad_producer[cache_line];
+	std::atomic<size_t> _tail; // next slot the consumer reads
+	size_t _cached_head;
+	char _pad_consumer[cache_line];
+	std::atomic<bool> _parked;
+	char _pad_back[cache_line];
+
+	bool push(message_t& message);
+	bool pop(message_t& message);
+	void park();
+	void wait();
+
+	// No copy - private and not implemented
+	channel(channel const&);
+	channel& operator=(channel const&);
+};
+
+}
+
+#endif /* ZMQPP_CHANNEL_HPP_ */
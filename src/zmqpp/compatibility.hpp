@@ -36,6 +36,12 @@
 #define ZMQ_EXPERIMENTAL_LABELS
 #endif
 
+// the scalable epoll_poller needs linux, as do the cheaper eventfd wake ups
+#ifdef __linux__
+#define ZMQPP_HAVE_EPOLL
+#define ZMQPP_HAVE_EVENTFD
+#endif
+
 // currently if your not using gcc or it's a major version other than 4 you'll have to deal with it yourself
 #ifdef __GNUC__
 #if __GNUC__ == 4
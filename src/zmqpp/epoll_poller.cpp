@@ -0,0 +1,478 @@
+#include "compatibility.hpp"
+
+#ifdef ZMQPP_HAVE_EPOLL
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+
+#include <unistd.h>
+
+#include "exception.hpp"
+#include "socket.hpp"
+#include "epoll_poller.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+// Most epoll events collected per wait, any more are picked up on the next call
+const size_t max_fired = 256;
+
+}
+
+epoll_poller::epoll_poller(recheck_mode const& mode /* = recheck_mode::automatic */)
+	: _mode(mode)
+	, _epoll(epoll_create1(EPOLL_CLOEXEC))
+	, _entries()
+	, _free_slots()
+	, _pending()
+	, _ready()
+	, _fired(max_fired)
+	, _index()
+	, _fdindex()
+	, _size(0)
+{
+	if (_epoll < 0)
+	{
+		throw zmq_internal_exception();
+	}
+}
+
+epoll_poller::~epoll_poller()
+{
+	close(_epoll);
+}
+
+epoll_poller::handle epoll_poller::add(socket& socket, short const& event /* = POLL_IN */)
+{
+	int descriptor = 0;
+	size_t descriptor_size = sizeof(descriptor);
+	if (0 != zmq_getsockopt(socket, ZMQ_FD, &descriptor, &descriptor_size))
+	{
+		throw zmq_internal_exception();
+	}
+
+	entry item { socket, descriptor, event, poller::POLL_NONE, true, false, false };
+	handle added = add_entry(item);
+
+	// Registered regardless of the events wanted, it only says the socket events may have changed
+	epoll_event watch;
+	watch.events = EPOLLIN | EPOLLET;
+	watch.data.u64 = added._slot;
+
+	if (0 != epoll_ctl(_epoll, EPOLL_CTL_ADD, descriptor, &watch))
+	{
+		remove(added);
+		throw zmq_internal_exception();
+	}
+
+	_entries[added._slot].registered = true;
+	_index[socket] = added._slot;
+	queue(added._slot);
+
+	return added;
+}
+
+epoll_poller::handle epoll_poller::add(int const& descriptor, short const& event /* = POLL_IN | POLL_ERROR */)
+{
+	entry item { nullptr, descriptor, event, poller::POLL_NONE, true, false, false };
+	handle added = add_entry(item);
+
+	try
+	{
+		update_descriptor(added._slot);
+	}
+	catch(zmq_internal_exception&)
+	{
+		remove(added);
+		throw;
+	}
+
+	_fdindex[descriptor] = added._slot;
+
+	return added;
+}
+
+void epoll_poller::remove(socket const& socket)
+{
+	auto found = _index.find(socket);
+	if (_index.end() == found)
+	{
+		throw exception("this socket is not represented within this poller");
+	}
+
+	remove(handle((*found).second));
+}
+
+void epoll_poller::remove(int const& descriptor)
+{
+	auto found = _fdindex.find(descriptor);
+	if (_fdindex.end() == found)
+	{
+		throw exception("this file descriptor is not represented within this poller");
+	}
+
+	remove(handle((*found).second));
+}
+
+void epoll_poller::remove(handle const& item)
+{
+	entry& target = lookup(item);
+
+	// The descriptor may already be closed, in which case the kernel has dropped it anyway
+	if (target.registered)
+	{
+		epoll_ctl(_epoll, EPOLL_CTL_DEL, target.fd, nullptr);
+		target.registered = false;
+	}
+
+	// Only drop the lookup if it still points here, the same socket may have been added again
+	if (nullptr != target.socket)
+	{
+		auto found = _index.find(target.socket);
+		if ((_index.end() != found) && ((*found).second == item._slot))
+		{
+			_index.erase(found);
+		}
+	}
+	else
+	{
+		auto found = _fdindex.find(target.fd);
+		if ((_fdindex.end() != found) && ((*found).second == item._slot))
+		{
+			_fdindex.erase(found);
+		}
+	}
+
+	if (poller::POLL_NONE != target.revents)
+	{
+		_ready.erase(std::remove(_ready.begin(), _ready.end(), item), _ready.end());
+	}
+
+	target.used = false;
+	target.revents = poller::POLL_NONE;
+	_free_slots.push_back(item._slot);
+	--_size;
+}
+
+epoll_poller::handle epoll_poller::find(socket const& socket) const
+{
+	auto found = _index.find(socket);
+	if (_index.end() == found)
+	{
+		return handle();
+	}
+
+	return handle((*found).second);
+}
+
+epoll_poller::handle epoll_poller::find(int const& descriptor) const
+{
+	auto found = _fdindex.find(descriptor);
+	if (_fdindex.end() == found)
+	{
+		return handle();
+	}
+
+	return handle((*found).second);
+}
+
+void epoll_poller::check_for(socket const& socket, short const& event)
+{
+	auto found = _index.find(socket);
+	if (_index.end() == found)
+	{
+		throw exception("this socket is not represented within this poller");
+	}
+
+	check_for(handle((*found).second), event);
+}
+
+void epoll_poller::check_for(int const& descriptor, short const& event)
+{
+	auto found = _fdindex.find(descriptor);
+	if (_fdindex.end() == found)
+	{
+		throw exception("this file descriptor is not represented within this poller");
+	}
+
+	check_for(handle((*found).second), event);
+}
+
+void epoll_poller::check_for(handle const& item, short const& event)
+{
+	entry& target = lookup(item);
+	if (target.events == event)
+	{
+		return;
+	}
+
+	target.events = event;
+
+	if (nullptr != target.socket)
+	{
+		queue(item._slot);
+	}
+	else
+	{
+		update_descriptor(item._slot);
+	}
+}
+
+void epoll_poller::recheck(socket const& socket)
+{
+	auto found = _index.find(socket);
+	if (_index.end() == found)
+	{
+		throw exception("this socket is not represented within this poller");
+	}
+
+	queue((*found).second);
+}
+
+void epoll_poller::recheck(handle const& item)
+{
+	lookup(item);
+	queue(item._slot);
+}
+
+bool epoll_poller::poll(long timeout /* = WAIT_FOREVER */)
+{
+	// Anything reported last time may not signal again, so always look at it
+	for(size_t i = 0; i < _ready.size(); ++i)
+	{
+		entry& target = _entries[_ready[i]._slot];
+		target.revents = poller::POLL_NONE;
+		if (nullptr != target.socket)
+		{
+			queue(_ready[i]._slot);
+		}
+	}
+	_ready.clear();
+
+	// The caller may have used any socket since the last poll and swallowed its edge
+	if (recheck_mode::automatic == _mode)
+	{
+		for(auto it = _index.begin(); it != _index.end(); ++it)
+		{
+			queue((*it).second);
+		}
+	}
+
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout, 0L));
+	long remaining = timeout;
+
+	while(true)
+	{
+		for(size_t i = 0; i < _pending.size(); ++i)
+		{
+			_entries[_pending[i]].queued = false;
+			check_socket(_pending[i]);
+		}
+		_pending.clear();
+
+		int count = epoll_wait(_epoll, _fired.data(), static_cast<int>(_fired.size()), (_ready.empty()) ? remaining : 0);
+		if (count < 0)
+		{
+			if (EINTR != errno)
+			{
+				throw zmq_internal_exception();
+			}
+
+			// Interrupted by a signal, wait again for whatever is left of the timeout
+			count = 0;
+		}
+
+		for(int i = 0; i < count; ++i)
+		{
+			size_t slot = static_cast<size_t>(_fired[i].data.u64);
+			entry& target = _entries[slot];
+			if (!target.used)
+			{
+				continue;
+			}
+
+			if (nullptr != target.socket)
+			{
+				check_socket(slot);
+				continue;
+			}
+
+			short revents = poller::POLL_NONE;
+			if (_fired[i].events & EPOLLIN) { revents |= poller::POLL_IN; }
+			if (_fired[i].events & EPOLLOUT) { revents |= poller::POLL_OUT; }
+			if (_fired[i].events & (EPOLLERR | EPOLLHUP)) { revents |= poller::POLL_ERROR; }
+
+			if (poller::POLL_NONE == target.revents)
+			{
+				_ready.push_back(handle(slot));
+			}
+			target.revents |= revents;
+		}
+
+		if (!_ready.empty())
+		{
+			return true;
+		}
+
+		// Only signals that had nothing we care about or an interruption, wait out the rest of the timeout
+		if (poller::WAIT_FOREVER == timeout)
+		{
+			continue;
+		}
+
+		remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+		if (remaining <= 0)
+		{
+			return false;
+		}
+	}
+}
+
+short epoll_poller::events(socket const& socket) const
+{
+	auto found = _index.find(socket);
+	if (_index.end() == found)
+	{
+		throw exception("this socket is not represented within this poller");
+	}
+
+	return _entries[(*found).second].revents;
+}
+
+short epoll_poller::events(int const& descriptor) const
+{
+	auto found = _fdindex.find(descriptor);
+	if (_fdindex.end() == found)
+	{
+		throw exception("this file descriptor is not represented within this poller");
+	}
+
+	return _entries[(*found).second].revents;
+}
+
+short epoll_poller::events(handle const& item) const
+{
+	return lookup(item).revents;
+}
+
+size_t epoll_poller::size() const
+{
+	return _size;
+}
+
+std::vector<epoll_poller::handle> const& epoll_poller::ready() const
+{
+	return _ready;
+}
+
+epoll_poller::handle epoll_poller::add_entry(entry const& item)
+{
+	size_t slot = _entries.size();
+	if (!_free_slots.empty())
+	{
+		slot = _free_slots.back();
+		_free_slots.pop_back();
+
+		// a reused slot may still be queued from its last owner, which is harmless
+		bool queued = _entries[slot].queued;
+		_entries[slot] = item;
+		_entries[slot].queued = queued;
+	}
+	else
+	{
+		_entries.push_back(item);
+	}
+
+	++_size;
+	return handle(slot);
+}
+
+epoll_poller::entry& epoll_poller::lookup(handle const& item)
+{
+	if ((item._slot >= _entries.size()) || !_entries[item._slot].used)
+	{
+		throw exception("this handle is not represented within this poller");
+	}
+
+	return _entries[item._slot];
+}
+
+epoll_poller::entry const& epoll_poller::lookup(handle const& item) const
+{
+	if ((item._slot >= _entries.size()) || !_entries[item._slot].used)
+	{
+		throw exception("this handle is not represented within this poller");
+	}
+
+	return _entries[item._slot];
+}
+
+void epoll_poller::queue(size_t const& slot)
+{
+	if (!_entries[slot].queued)
+	{
+		_entries[slot].queued = true;
+		_pending.push_back(slot);
+	}
+}
+
+void epoll_poller::check_socket(size_t const& slot)
+{
+	entry& target = _entries[slot];
+	if (!target.used || (nullptr == target.socket))
+	{
+		return;
+	}
+
+	int events = 0;
+	size_t events_size = sizeof(events);
+	if (0 != zmq_getsockopt(target.socket, ZMQ_EVENTS, &events, &events_size))
+	{
+		throw zmq_internal_exception();
+	}
+
+	short revents = static_cast<short>(events) & target.events;
+	if ((poller::POLL_NONE != revents) && (poller::POLL_NONE == target.revents))
+	{
+		_ready.push_back(handle(slot));
+	}
+	target.revents |= revents;
+}
+
+void epoll_poller::update_descriptor(size_t const& slot)
+{
+	entry& target = _entries[slot];
+
+	// Errors and hang ups are always reported so stop watching entirely rather than spin
+	if (poller::POLL_NONE == target.events)
+	{
+		if (target.registered)
+		{
+			epoll_ctl(_epoll, EPOLL_CTL_DEL, target.fd, nullptr);
+			target.registered = false;
+		}
+
+		return;
+	}
+
+	epoll_event watch;
+	watch.events = 0;
+	watch.data.u64 = slot;
+	if (target.events & poller::POLL_IN) { watch.events |= EPOLLIN; }
+	if (target.events & poller::POLL_OUT) { watch.events |= EPOLLOUT; }
+
+	if (0 != epoll_ctl(_epoll, (target.registered) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, target.fd, &watch))
+	{
+		throw zmq_internal_exception();
+	}
+
+	target.registered = true;
+}
+
+}
+
+#endif // ZMQPP_HAVE_EPOLL
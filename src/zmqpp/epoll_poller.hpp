@@ -0,0 +1,292 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_EPOLL_POLLER_HPP_
+#define ZMQPP_EPOLL_POLLER_HPP_
+
+#include "compatibility.hpp"
+
+#ifdef ZMQPP_HAVE_EPOLL
+
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+
+#include "poller.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+
+/*!
+ * Polling wrapper for large numbers of mostly idle sockets.
+ *
+ * Has the same interface as poller but rather than passing every item to
+ * zmq_poll on each call, each socket's file descriptor is registered with
+ * epoll once and plain file descriptors are only looked at when epoll
+ * reports them.
+ *
+ * The 0mq file descriptor is edge triggered and only signals that the socket
+ * events may have changed, and using a socket can swallow that edge. By
+ * default every poll therefore reads the events of every socket before
+ * waiting, so code written against poller works unchanged.
+ *
+ * In manual recheck mode only sockets that signalled, were newly added, had
+ * check_for called, reported events on the previous poll or were passed to
+ * recheck are looked at, so the cost of a poll depends on the number of
+ * active sockets rather than the number monitored. In exchange any socket
+ * sent to or received from when it was not reported by the last poll must be
+ * passed to recheck before polling again, otherwise its wake up may be lost.
+ *
+ * A poll interrupted by a signal carries on waiting for the rest of its
+ * timeout.
+ *
+ * Only available on linux.
+ */
+class epoll_poller
+{
+public:
+	typedef poller::handle handle; /*!< Stable reference to a monitored item. */
+
+	/*!
+	 * How the socket events are kept up to date between polls.
+	 */
+	ZMQPP_COMPARABLE_ENUM recheck_mode {
+		automatic, /*!< every socket is checked on each poll, always safe */
+		manual     /*!< only active sockets are checked, the caller uses recheck */
+	};
+
+	/*!
+	 * Construct an empty polling model.
+	 *
+	 * \param mode manual to only check active sockets, see the class notes.
+	 */
+	epoll_poller(recheck_mode const& mode = recheck_mode::automatic);
+
+	/*!
+	 * Cleanup poller.
+	 *
+	 * Any sockets will need to be closed separately.
+	 */
+	~epoll_poller();
+
+	/*!
+	 * Add a socket to the polling model and set which events to monitor.
+	 *
+	 * \param socket the socket to monitor.
+	 * \param event the event flags to monitor on the socket.
+	 * \return a handle for the socket within this poller.
+	 */
+	handle add(socket_t& socket, short const& event = poller::POLL_IN);
+
+	/*!
+	 * Add a file descriptor to the polling model and set which events to monitor.
+	 *
+	 * \param descriptor the file descriptor to monitor.
+	 * \param event the event flags to monitor.
+	 * \return a handle for the file descriptor within this poller.
+	 */
+	handle add(int const& descriptor, short const& event = poller::POLL_IN | poller::POLL_ERROR);
+
+	/*!
+	 * Stop monitoring a socket.
+	 *
+	 * \param socket the socket to remove.
+	 */
+	void remove(socket_t const& socket);
+
+	/*!
+	 * Stop monitoring a file descriptor.
+	 *
+	 * \param descriptor the file descriptor to remove.
+	 */
+	void remove(int const& descriptor);
+
+	/*!
+	 * Stop monitoring a socket or file descriptor by handle.
+	 *
+	 * \param item handle returned by add.
+	 */
+	void remove(handle const& item);
+
+	/*!
+	 * Find the handle for a socket.
+	 *
+	 * \param socket the socket to find.
+	 * \return the handle, which is not valid if the socket is not in this poller.
+	 */
+	handle find(socket_t const& socket) const;
+
+	/*!
+	 * Find the handle for a file descriptor.
+	 *
+	 * \param descriptor the file descriptor to find.
+	 * \return the handle, which is not valid if the descriptor is not in this poller.
+	 */
+	handle find(int const& descriptor) const;
+
+	/*!
+	 * Update the monitored event flags for a given socket.
+	 *
+	 * \param socket the socket to update event flags.
+	 * \param event the event flags to monitor on the socket.
+	 */
+	void check_for(socket_t const& socket, short const& event);
+
+	/*!
+	 * Update the monitored event flags for a given file descriptor.
+	 *
+	 * \param descriptor the file descriptor to update event flags.
+	 * \param event the event flags to monitor.
+	 */
+	void check_for(int const& descriptor, short const& event);
+
+	/*!
+	 * Update the monitored event flags for a given handle.
+	 *
+	 * \param item handle returned by add.
+	 * \param event the event flags to monitor.
+	 */
+	void check_for(handle const& item, short const& event);
+
+	/*!
+	 * Make the next poll check the events of a socket.
+	 *
+	 * Needed in manual mode after using a socket that was not reported by
+	 * the last poll.
+	 *
+	 * \param socket the socket to check.
+	 */
+	void recheck(socket_t const& socket);
+
+	/*!
+	 * Make the next poll check the events of a socket by handle.
+	 *
+	 * \param item handle returned by add.
+	 */
+	void recheck(handle const& item);
+
+	/*!
+	 * Poll for monitored events.
+	 *
+	 * By default this method will block forever or until at least one of the monitored
+	 * sockets or file descriptors has events.
+	 *
+	 * If a timeout is set and was reached then this function returns false.
+	 *
+	 * \param timeout milliseconds to timeout.
+	 * \return true if there is an event.
+	 */
+	bool poll(long timeout = poller::WAIT_FOREVER);
+
+	/*!
+	 * Get the event flags triggered for a socket.
+	 *
+	 * \param socket the socket to get triggered event flags for.
+	 * \return the event flags.
+	 */
+	short events(socket_t const& socket) const;
+
+	/*!
+	 * Get the event flags triggered for a file descriptor.
+	 *
+	 * \param descriptor the file descriptor to get triggered event flags for.
+	 * \return the event flags.
+	 */
+	short events(int const& descriptor) const;
+
+	/*!
+	 * Get the event flags triggered for a handle.
+	 *
+	 * \param item handle returned by add.
+	 * \return the event flags.
+	 */
+	short events(handle const& item) const;
+
+	/*!
+	 * Check either a file descriptor, socket or handle for input events.
+	 *
+	 * \param watchable a file descriptor, socket or handle known to the poller.
+	 * \return true if there is input.
+	 */
+	template<typename Watched>
+	bool has_input(Watched const& watchable) const { return events(watchable) & poller::POLL_IN; }
+
+	/*!
+	 * Check either a file descriptor, socket or handle for output events.
+	 *
+	 * \param watchable a file descriptor, socket or handle known to the poller.
+	 * \return true if there is output.
+	 */
+	template<typename Watched>
+	bool has_output(Watched const& watchable) const { return events(watchable) & poller::POLL_OUT; }
+
+	/*!
+	 * Check a file descriptor for errors.
+	 *
+	 * \param watchable a file descriptor or handle known to the poller.
+	 * \return true if there is an error.
+	 */
+	template<typename Watched>
+	bool has_error(Watched const& watchable) const { return events(watchable) & poller::POLL_ERROR; }
+
+	/*!
+	 * Get the number of sockets and file descriptors being monitored.
+	 *
+	 * \return number of monitored items.
+	 */
+	size_t size() const;
+
+	/*!
+	 * Handles of every item with events from the last poll.
+	 *
+	 * Walking this is proportional to the number of active items only.
+	 *
+	 * \return handles in no particular order.
+	 */
+	std::vector<handle> const& ready() const;
+
+private:
+	struct entry
+	{
+		void* socket;
+		int fd;
+		short events;
+		short revents;
+		bool used;
+		bool queued;
+		bool registered;
+	};
+
+	recheck_mode _mode;
+	int _epoll;
+	std::vector<entry> _entries;
+	std::vector<size_t> _free_slots;
+	std::vector<size_t> _pending;
+	std::vector<handle> _ready;
+	std::vector<epoll_event> _fired;
+	std::unordered_map<void *, size_t> _index;
+	std::unordered_map<int, size_t> _fdindex;
+	size_t _size;
+
+	handle add_entry(entry const& item);
+	entry& lookup(handle const& item);
+	entry const& lookup(handle const& item) const;
+	void queue(size_t const& slot);
+	void check_socket(size_t const& slot);
+	void update_descriptor(size_t const& slot);
+
+	// No copy - private and not implemented
+	epoll_poller(epoll_poller const&);
+	epoll_poller& operator=(epoll_poller const&);
+};
+
+}
+
+#endif // ZMQPP_HAVE_EPOLL
+
+#endif /* ZMQPP_EPOLL_POLLER_HPP_ */
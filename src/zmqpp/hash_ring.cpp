@@ -0,0 +1,142 @@
+#include <algorithm>
+
+#include "exception.hpp"
+#include "hash_ring.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+// Final mix from MurmurHash3, spreads the bits of nearly equal inputs
+uint64_t mix(uint64_t value)
+{
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	value ^= value >> 33;
+
+	return value;
+}
+
+// Order by position then name so colliding points sort the same everywhere
+bool point_before(std::pair<uint64_t, std::string const*> const& lhs, std::pair<uint64_t, std::string const*> const& rhs)
+{
+	if (lhs.first != rhs.first)
+	{
+		return lhs.first < rhs.first;
+	}
+
+	return *lhs.second < *rhs.second;
+}
+
+bool point_below(std::pair<uint64_t, std::string const*> const& point, uint64_t const& position)
+{
+	return point.first < position;
+}
+
+}
+
+hash_ring::hash_ring(size_t const& virtual_nodes /* = 100 */)
+	: _virtual_nodes((virtual_nodes > 0) ? virtual_nodes : 1)
+	, _nodes()
+	, _ring()
+{
+}
+
+hash_ring::~hash_ring()
+{
+}
+
+bool hash_ring::add(std::string const& node)
+{
+	auto inserted = _nodes.insert(node);
+	if (!inserted.second)
+	{
+		return false;
+	}
+
+	std::string const* name = &(*inserted.first);
+	uint64_t base = hash(name->data(), name->size());
+
+	size_t middle = _ring.size();
+	_ring.reserve(_ring.size() + _virtual_nodes);
+	for(size_t i = 0; i < _virtual_nodes; ++i)
+	{
+		_ring.push_back(point(mix(base + (i + 1) * 0x9e3779b97f4a7c15ULL), name));
+	}
+
+	std::sort(_ring.begin() + middle, _ring.end(), &point_before);
+	std::inplace_merge(_ring.begin(), _ring.begin() + middle, _ring.end(), &point_before);
+
+	return true;
+}
+
+bool hash_ring::remove(std::string const& node)
+{
+	auto it = _nodes.find(node);
+	if (_nodes.end() == it)
+	{
+		return false;
+	}
+
+	std::string const* name = &(*it);
+	_ring.erase(std::remove_if(_ring.begin(), _ring.end(), [name](point const& entry) { return entry.second == name; }), _ring.end());
+	_nodes.erase(it);
+
+	return true;
+}
+
+bool hash_ring::contains(std::string const& node) const
+{
+	return _nodes.end() != _nodes.find(node);
+}
+
+std::string const& hash_ring::find(void const* key, size_t const& size) const
+{
+	if (_ring.empty())
+	{
+		throw exception("hash ring has no nodes");
+	}
+
+	auto it = std::lower_bound(_ring.begin(), _ring.end(), hash(key, size), &point_below);
+	if (_ring.end() == it)
+	{
+		it = _ring.begin();
+	}
+
+	return *(*it).second;
+}
+
+std::string const& hash_ring::find(std::string const& key) const
+{
+	return find(key.data(), key.size());
+}
+
+size_t hash_ring::size() const
+{
+	return _nodes.size();
+}
+
+bool hash_ring::empty() const
+{
+	return _nodes.empty();
+}
+
+uint64_t hash_ring::hash(void const* data, size_t const& size)
+{
+	// FNV-1a, mixed as it clusters short keys that differ in a single byte
+	uint64_t value = 0xcbf29ce484222325ULL;
+	unsigned char const* bytes = static_cast<unsigned char const*>(data);
+	for(size_t i = 0; i < size; ++i)
+	{
+		value ^= bytes[i];
+		value *= 0x100000001b3ULL;
+	}
+
+	return mix(value);
+}
+
+}
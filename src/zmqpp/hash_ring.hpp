@@ -0,0 +1,130 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_HASH_RING_HPP_
+#define ZMQPP_HASH_RING_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "compatibility.hpp"
+
+namespace zmqpp
+{
+
+/*!
+ * Consistent hash ring mapping keys onto a set of named nodes.
+ *
+ * Each node is placed at a number of virtual points around a 64 bit ring
+ * and a key belongs to the first point at or after its own hash. Adding a
+ * node only takes keys from the points it lands in front of, and removing
+ * one only hands its keys to the points behind, so everything else stays
+ * where it was. More virtual nodes spread the keys more evenly.
+ *
+ * The points are held in a sorted vector, finding a key is a binary search
+ * and changing the nodes rebuilds the vector, which suits sets of nodes
+ * that change far less often than keys are looked up.
+ *
+ * Hashes are stable between processes and runs so every holder of the same
+ * set of nodes maps keys the same way.
+ */
+class hash_ring
+{
+public:
+	/*!
+	 * Create an empty ring.
+	 *
+	 * \param virtual_nodes points placed on the ring for each node.
+	 */
+	hash_ring(size_t const& virtual_nodes = 100);
+
+	/*!
+	 * Cleanup the ring.
+	 */
+	~hash_ring();
+
+	/*!
+	 * Add a node to the ring.
+	 *
+	 * \param node the node name.
+	 * \return false if the node was already on the ring.
+	 */
+	bool add(std::string const& node);
+
+	/*!
+	 * Remove a node from the ring.
+	 *
+	 * \param node the node name.
+	 * \return false if the node was not on the ring.
+	 */
+	bool remove(std::string const& node);
+
+	/*!
+	 * Check if a node is on the ring.
+	 *
+	 * \param node the node name.
+	 * \return true if the node has been added.
+	 */
+	bool contains(std::string const& node) const;
+
+	/*!
+	 * Find the node a key belongs to.
+	 *
+	 * An exception is thrown if the ring is empty.
+	 *
+	 * \param key pointer to the key bytes.
+	 * \param size length of the key.
+	 * \return the owning node name, valid until that node is removed.
+	 */
+	std::string const& find(void const* key, size_t const& size) const;
+
+	/*!
+	 * Find the node a key belongs to.
+	 *
+	 * \param key the key.
+	 * \return the owning node name, valid until that node is removed.
+	 */
+	std::string const& find(std::string const& key) const;
+
+	/*!
+	 * Get the number of nodes on the ring.
+	 *
+	 * \return node count.
+	 */
+	size_t size() const;
+
+	/*!
+	 * Check if the ring has no nodes.
+	 *
+	 * \return true if empty.
+	 */
+	bool empty() const;
+
+	/*!
+	 * Hash bytes the way the ring does.
+	 *
+	 * \param data pointer to the bytes.
+	 * \param size number of bytes.
+	 * \return 64 bit hash.
+	 */
+	static uint64_t hash(void const* data, size_t const& size);
+
+private:
+	typedef std::pair<uint64_t, std::string const*> point;
+
+	size_t _virtual_nodes;
+	std::unordered_set<std::string> _nodes; // element addresses are stable, the ring points at them
+	std::vector<point> _ring;
+
+	// No copy - private and not implemented
+	hash_ring(hash_ring const&);
+	hash_ring& operator=(hash_ring const&);
+};
+
+}
+
+#endif /* ZMQPP_HASH_RING_HPP_ */
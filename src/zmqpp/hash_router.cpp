@@ -0,0 +1,126 @@
+#include <cstring>
+
+#include "exception.hpp"
+#include "socket.hpp"
+#include "hash_router.hpp"
+
+namespace zmqpp
+{
+
+const std::string hash_router::join_signal("\001", 1);
+const std::string hash_router::leave_signal("\002", 1);
+
+namespace
+{
+
+bool part_is(message& message, size_t const& part, std::string const& signal)
+{
+	return (signal.size() == message.size(part)) && (0 == std::memcmp(signal.data(), message.raw_data(part), signal.size()));
+}
+
+}
+
+hash_router::hash_router(socket& socket, size_t const& key_frame /* = 0 */, size_t const& virtual_nodes /* = 100 */)
+	: _socket(socket)
+	, _key_frame(key_frame)
+	, _ring(virtual_nodes)
+	, _stats()
+{
+	if (socket_type::router != socket.type())
+	{
+		throw exception("hash routing requires a router socket");
+	}
+}
+
+hash_router::~hash_router()
+{
+}
+
+bool hash_router::add_peer(std::string const& identity)
+{
+	if (!_ring.add(identity))
+	{
+		return false;
+	}
+
+	++_stats.joins;
+	return true;
+}
+
+bool hash_router::remove_peer(std::string const& identity)
+{
+	if (!_ring.remove(identity))
+	{
+		return false;
+	}
+
+	++_stats.leaves;
+	return true;
+}
+
+size_t hash_router::peers() const
+{
+	return _ring.size();
+}
+
+std::string const& hash_router::peer_for(std::string const& key) const
+{
+	return _ring.find(key);
+}
+
+bool hash_router::route(message& message, bool const& dont_block /* = false */)
+{
+	if (_key_frame >= message.parts())
+	{
+		throw exception("message has no key frame to route on");
+	}
+
+	std::string const& peer = _ring.find(message.raw_data(_key_frame), message.size(_key_frame));
+
+	// Once the identity frame is accepted 0mq takes the rest of the message
+	int flags = socket::SEND_MORE | ((dont_block) ? socket::DONT_WAIT : socket::NORMAL);
+	if (!_socket.send(peer, flags))
+	{
+		return false;
+	}
+
+	_socket.send(message);
+	++_stats.routed;
+
+	return true;
+}
+
+bool hash_router::receive(message& message, bool const& dont_block /* = false */)
+{
+	while(_socket.receive(message, dont_block))
+	{
+		if (2 == message.parts())
+		{
+			if (part_is(message, 1, join_signal))
+			{
+				add_peer(message.get(0));
+				message = message_t();
+				continue;
+			}
+
+			if (part_is(message, 1, leave_signal))
+			{
+				remove_peer(message.get(0));
+				message = message_t();
+				continue;
+			}
+		}
+
+		++_stats.received;
+		return true;
+	}
+
+	return false;
+}
+
+hash_router::statistics hash_router::stats() const
+{
+	return _stats;
+}
+
+}
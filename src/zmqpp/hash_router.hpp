@@ -0,0 +1,144 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_HASH_ROUTER_HPP_
+#define ZMQPP_HASH_ROUTER_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include "compatibility.hpp"
+#include "hash_ring.hpp"
+#include "message.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Sends messages with the same key to the same peer of a router socket.
+ *
+ * Peers are kept on a consistent hash ring by identity and each message is
+ * routed to the owner of the key in its key frame, so a peer keeps seeing
+ * the same keys for as long as it is connected and only the keys of a peer
+ * that joins or leaves move.
+ *
+ * Peers connect with dealer sockets and send join_signal to be added and
+ * leave_signal to be removed, receive handles both and returns everything
+ * else. Peers whose identities are known ahead of time can be added and
+ * removed directly instead. A router does not report disconnects, so a
+ * peer that goes away without leaving keeps its keys until it is removed.
+ *
+ * The message sent to a peer is the peer identity, which the router strips,
+ * then the message as given.
+ */
+class hash_router
+{
+public:
+	static const std::string join_signal;  /*!< sent by a peer to be added to the ring */
+	static const std::string leave_signal; /*!< sent by a peer to be removed from the ring */
+
+	/*!
+	 * Counters for the router.
+	 */
+	struct statistics
+	{
+		uint64_t routed;   /*!< messages sent to a peer */
+		uint64_t received; /*!< messages returned by receive */
+		uint64_t joins;    /*!< peers added */
+		uint64_t leaves;   /*!< peers removed */
+	};
+
+	/*!
+	 * Route on a router socket.
+	 *
+	 * \param socket the router, which must outlive the hash router.
+	 * \param key_frame index of the message part holding the key.
+	 * \param virtual_nodes points on the ring for each peer.
+	 */
+	hash_router(socket_t& socket, size_t const& key_frame = 0, size_t const& virtual_nodes = 100);
+
+	/*!
+	 * Cleanup the hash router.
+	 */
+	~hash_router();
+
+	/*!
+	 * Add a peer by identity.
+	 *
+	 * \param identity the peer identity.
+	 * \return false if the peer was already known.
+	 */
+	bool add_peer(std::string const& identity);
+
+	/*!
+	 * Remove a peer by identity.
+	 *
+	 * \param identity the peer identity.
+	 * \return false if the peer was not known.
+	 */
+	bool remove_peer(std::string const& identity);
+
+	/*!
+	 * Get the number of peers on the ring.
+	 *
+	 * \return peer count.
+	 */
+	size_t peers() const;
+
+	/*!
+	 * Find the peer a key is routed to.
+	 *
+	 * An exception is thrown if there are no peers.
+	 *
+	 * \param key the key.
+	 * \return the peer identity.
+	 */
+	std::string const& peer_for(std::string const& key) const;
+
+	/*!
+	 * Send a message to the peer owning its key.
+	 *
+	 * An exception is thrown if there are no peers or the message has no
+	 * key frame.
+	 *
+	 * \param message the message to route, emptied if it was sent.
+	 * \param dont_block true to return false instead of waiting.
+	 * \return true if the message was sent.
+	 */
+	bool route(message_t& message, bool const& dont_block = false);
+
+	/*!
+	 * Receive the next message from a peer, handling join and leave signals.
+	 *
+	 * \param message the message to fill, identity first, must be empty.
+	 * \param dont_block true to return false instead of waiting.
+	 * \return true if a message was received.
+	 */
+	bool receive(message_t& message, bool const& dont_block = false);
+
+	/*!
+	 * Get the router counters.
+	 *
+	 * \return the counters so far.
+	 */
+	statistics stats() const;
+
+private:
+	socket_t& _socket;
+	size_t _key_frame;
+	hash_ring _ring;
+	statistics _stats;
+
+	// No copy - private and not implemented
+	hash_router(hash_router const&);
+	hash_router& operator=(hash_router const&);
+};
+
+}
+
+#endif /* ZMQPP_HASH_ROUTER_HPP_ */
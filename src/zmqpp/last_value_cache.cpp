@@ -0,0 +1,202 @@
+#include <zmq.h>
+
+#include "exception.hpp"
+#include "socket.hpp"
+#include "last_value_cache.hpp"
+
+namespace zmqpp
+{
+
+last_value_cache::last_value_cache(socket& frontend, socket& backend, size_t const& batch_size /* = 256 */)
+	: _frontend(frontend)
+	, _backend(backend)
+	, _batch_size((batch_size > 0) ? batch_size : 1)
+	, _poller()
+	, _running(true)
+	, _cache()
+	, _topic()
+	, _updates(0)
+	, _subscriptions(0)
+	, _replayed(0)
+	, _topics(0)
+{
+	if ((socket_type::xsubscribe != frontend.type()) && (socket_type::subscribe != frontend.type()))
+	{
+		throw exception("last value cache frontend must be an xsubscribe or subscribe socket");
+	}
+
+	if (socket_type::xpublish != backend.type())
+	{
+		throw exception("last value cache backend must be an xpublish socket");
+	}
+
+	// Every topic is cached so upstream sees a single subscription to everything
+	if (socket_type::xsubscribe == frontend.type())
+	{
+		_frontend.send(std::string("\1", 1));
+	}
+	else
+	{
+		_frontend.subscribe("");
+	}
+
+#ifdef ZMQ_XPUB_VERBOSE
+	_backend.set(socket_option::xpub_verbose, 1);
+#endif
+
+	_poller.add(_frontend);
+	_poller.add(_backend);
+	_poller.add(_wakeup.file_descriptor());
+}
+
+last_value_cache::~last_value_cache()
+{
+}
+
+bool last_value_cache::poll(long timeout /* = poller::WAIT_FOREVER */)
+{
+	if (!_poller.poll(timeout))
+	{
+		return false;
+	}
+
+	if (_poller.has_input(_wakeup.file_descriptor()))
+	{
+		_wakeup.drain();
+	}
+
+	size_t handled = 0;
+
+	// Subscriptions first so a replay is never overtaken by a newer update it would then overwrite
+	if (_poller.has_input(_backend))
+	{
+		handled += subscribe();
+	}
+
+	if (_poller.has_input(_frontend))
+	{
+		handled += forward();
+	}
+
+	return handled > 0;
+}
+
+void last_value_cache::run()
+{
+	while(_running.load())
+	{
+		poll();
+	}
+}
+
+void last_value_cache::stop()
+{
+	_running.store(false);
+
+	_wakeup.signal();
+}
+
+bool last_value_cache::contains(std::string const& topic) const
+{
+	return _cache.end() != _cache.find(topic);
+}
+
+last_value_cache::statistics last_value_cache::stats() const
+{
+	statistics stats;
+	stats.updates = _updates.load();
+	stats.subscriptions = _subscriptions.load();
+	stats.replayed = _replayed.load();
+	stats.topics = _topics.load();
+
+	return stats;
+}
+
+size_t last_value_cache::forward()
+{
+	size_t forwarded = 0;
+
+	message_t update;
+	while((forwarded < _batch_size) && _frontend.receive(update, true))
+	{
+		_topic.assign(static_cast<char const*>(update.raw_data(0)), update.size(0));
+
+		auto it = _cache.find(_topic);
+		if (_cache.end() == it)
+		{
+			it = _cache.insert(std::make_pair(_topic, message_t())).first;
+			++_topics;
+		}
+
+		// Clearing keeps the part storage, so a steady topic stops allocating
+		message_t& value = (*it).second;
+		value.clear();
+		for(size_t i = 1; i < update.parts(); ++i)
+		{
+			if (0 != zmq_msg_copy(&value.raw_new_msg(), &update.raw_msg(i)))
+			{
+				throw zmq_internal_exception();
+			}
+		}
+
+		_backend.send(update);
+		update = message_t();
+
+		++forwarded;
+	}
+
+	_updates += forwarded;
+	return forwarded;
+}
+
+size_t last_value_cache::subscribe()
+{
+	size_t handled = 0;
+
+	while(_backend.receive(_topic, socket::DONT_WAIT))
+	{
+		++handled;
+
+		// Only subscribe frames matter, the frontend already takes everything
+		if (_topic.empty() || ('\1' != _topic[0]))
+		{
+			continue;
+		}
+
+		++_subscriptions;
+		replay(_topic.substr(1));
+	}
+
+	return handled;
+}
+
+size_t last_value_cache::replay(std::string const& prefix)
+{
+	size_t replayed = 0;
+
+	for(auto it = _cache.begin(); it != _cache.end(); ++it)
+	{
+		std::string const& topic = (*it).first;
+		if (0 != topic.compare(0, prefix.size(), prefix))
+		{
+			continue;
+		}
+
+		// A copy so the cached frames survive being sent
+		message_t value = (*it).second.copy();
+		bool more = value.parts() > 0;
+
+		_backend.send(topic, (more) ? socket::SEND_MORE : socket::NORMAL);
+		if (more)
+		{
+			_backend.send(value);
+		}
+
+		++replayed;
+	}
+
+	_replayed += replayed;
+	return replayed;
+}
+
+}
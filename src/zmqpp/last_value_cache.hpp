@@ -0,0 +1,143 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_LAST_VALUE_CACHE_HPP_
+#define ZMQPP_LAST_VALUE_CACHE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+#include "poller.hpp"
+#include "wakeup.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Forwards a feed and replays the latest message on each topic to new
+ * subscribers.
+ *
+ * The frontend is an xsubscribe (or subscribe) socket connected to the
+ * publishers and subscribes to everything, the backend an xpublish socket
+ * subscribers connect to. Every message is forwarded and also kept as the
+ * last value of its topic, the first frame. When a subscription arrives on
+ * the backend the cached values of all topics it matches are sent straight
+ * away, so a late joiner sees the current state without waiting for the
+ * next update.
+ *
+ * The cache holds each topic string once, as the key, and only the frames
+ * after it. Those are 0mq copies of the forwarded frames, which share the
+ * data rather than duplicate it for all but the smallest messages. Replays
+ * scan the whole cache, subscriptions are expected to be far rarer than
+ * updates.
+ *
+ * Where libzmq supports it the backend is made verbose so a subscription
+ * to a topic that already has subscribers is still seen. As an xpublish
+ * socket sends to every matching subscriber, those existing subscribers
+ * receive the replayed values again too.
+ *
+ * The cache uses the sockets from whichever thread calls run or poll, the
+ * sockets must not be used elsewhere meanwhile. Only stop and stats are
+ * safe to call from other threads.
+ */
+class last_value_cache
+{
+public:
+	/*!
+	 * Counters for the cache, safe to read from any thread.
+	 */
+	struct statistics
+	{
+		uint64_t updates;       /*!< messages forwarded from the frontend */
+		uint64_t subscriptions; /*!< subscribe requests seen on the backend */
+		uint64_t replayed;      /*!< cached messages sent for subscriptions */
+		uint64_t topics;        /*!< topics currently cached */
+	};
+
+	/*!
+	 * Create a cache between two sockets.
+	 *
+	 * \param frontend xsubscribe or subscribe socket connected to the publishers.
+	 * \param backend xpublish socket for subscribers.
+	 * \param batch_size most updates forwarded per poll.
+	 */
+	last_value_cache(socket_t& frontend, socket_t& backend, size_t const& batch_size = 256);
+
+	/*!
+	 * Cleanup the cache, the sockets are left open.
+	 */
+	~last_value_cache();
+
+	/*!
+	 * Wait for updates or subscriptions and handle them.
+	 *
+	 * \param timeout milliseconds to wait, or poller::WAIT_FOREVER.
+	 * \return true if anything was forwarded or replayed.
+	 */
+	bool poll(long timeout = poller::WAIT_FOREVER);
+
+	/*!
+	 * Forward and cache until stop is called.
+	 */
+	void run();
+
+	/*!
+	 * Make run return, safe to call from any thread.
+	 *
+	 * Stopping is final, any later run returns straight away.
+	 */
+	void stop();
+
+	/*!
+	 * Check if a topic has a cached value.
+	 *
+	 * Only safe from the thread that polls.
+	 *
+	 * \param topic the exact topic.
+	 * \return true if a value is cached.
+	 */
+	bool contains(std::string const& topic) const;
+
+	/*!
+	 * Get the counters, safe to call from any thread.
+	 *
+	 * \return the counters so far.
+	 */
+	statistics stats() const;
+
+private:
+	socket_t& _frontend;
+	socket_t& _backend;
+	size_t _batch_size;
+	poller _poller;
+	wakeup _wakeup;
+	std::atomic<bool> _running;
+	std::unordered_map<std::string, message_t> _cache;
+	std::string _topic;
+
+	std::atomic<uint64_t> _updates;
+	std::atomic<uint64_t> _subscriptions;
+	std::atomic<uint64_t> _replayed;
+	std::atomic<uint64_t> _topics;
+
+	size_t forward();
+	size_t subscribe();
+	size_t replay(std::string const& prefix);
+
+	// No copy - private and not implemented
+	last_value_cache(last_value_cache const&);
+	last_value_cache& operator=(last_value_cache const&);
+};
+
+}
+
+#endif /* ZMQPP_LAST_VALUE_CACHE_HPP_ */
@@ -3,6 +3,7 @@
  *      Author: Ben Gray (@benjamg)
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -40,19 +41,7 @@ message::message()
 
 message::~message()
 {
-	for(size_t i = 0; i < _parts.size(); ++i)
-	{
-		zmq_msg_t& msg = _parts[i].msg;
-
-#ifndef NDEBUG // unused assert variable in release
-		int result = zmq_msg_close(&msg);
-		assert(0 == result);
-#else
-		zmq_msg_close(&msg);
-#endif // NDEBUG
-
-	}
-	_parts.clear();
+	clear();
 }
 
 size_t message::parts() const
@@ -95,32 +84,49 @@ zmq_msg_t& message::raw_msg(size_t const& part /* = 0 */)
 
 zmq_msg_t& message::raw_new_msg()
 {
-	parts_type tmp(_parts.size() + 1);
+	zmq_msg_t& msg = new_part();
+	if( 0 != zmq_msg_init(&msg) )
+	{
+		_parts.pop_back();
+		throw zmq_internal_exception();
+	}
 
-	for(size_t i = 0; i < _parts.size(); ++i)
+	return msg;
+}
+
+// Grows the parts geometrically so building a message is amortised constant
+// time per part, zmq_msg_t must be moved with zmq_msg_move so we can't rely on
+// the vector doing this for us.
+zmq_msg_t& message::new_part()
+{
+	if (_parts.size() == _parts.capacity())
 	{
-		zmq_msg_t& dest = tmp[i].msg;
-		if( 0 != zmq_msg_init(&dest) )
-		{
-			throw zmq_internal_exception();
-		}
+		parts_type tmp;
+		tmp.reserve(std::max<size_t>(4, _parts.capacity() * 2));
+		tmp.resize(_parts.size());
 
-		zmq_msg_t& src = _parts[i].msg;
-		if( 0 != zmq_msg_move(&dest, &src) )
+		for(size_t i = 0; i < _parts.size(); ++i)
 		{
-			throw zmq_internal_exception();
+			zmq_msg_t& dest = tmp[i].msg;
+			if( 0 != zmq_msg_init(&dest) )
+			{
+				throw zmq_internal_exception();
+			}
+
+			zmq_msg_t& src = _parts[i].msg;
+			if( 0 != zmq_msg_move(&dest, &src) )
+			{
+				throw zmq_internal_exception();
+			}
+
+			tmp[i].sent = _parts[i].sent;
 		}
-	}
 
-	std::swap(tmp, _parts);
-
-	zmq_msg_t& msg = _parts.back().msg;
-	if( 0 != zmq_msg_init(&msg) )
-	{
-		throw zmq_internal_exception();
+		std::swap(tmp, _parts);
 	}
 
-	return msg;
+	_parts.resize(_parts.size() + 1);
+	return _parts.back().msg;
 }
 
 std::string message::get(size_t const& part /* = 0 */)
@@ -130,62 +136,38 @@ std::string message::get(size_t const& part /* = 0 */)
 
 
 // Move operators will take ownership of message parts without copying
-void message::move(void* part, size_t& size, release_function const& release)
+void message::move(void* part, size_t const& size, release_function const& release)
 {
-	parts_type tmp(_parts.size() + 1);
-
-	for(size_t i = 0; i < _parts.size(); ++i)
-	{
-		zmq_msg_t& dest = tmp[i].msg;
-		if( 0 != zmq_msg_init(&dest) )
-		{
-			throw zmq_internal_exception();
-		}
-
-		zmq_msg_t& src = _parts[i].msg;
-		if( 0 != zmq_msg_move(&dest, &src) )
-		{
-			throw zmq_internal_exception();
-		}
-	}
-
-	std::swap(tmp, _parts);
-
 	callback_releaser* hint = new callback_releaser();
 	hint->func = release;
 
-	zmq_msg_t& msg = _parts.back().msg;
-	if (0 != zmq_msg_init_data(&msg, part, size, &message::release_callback, hint))
+	try
 	{
-		throw zmq_internal_exception();
+		move(part, size, &message::release_callback, hint);
+	}
+	catch(...)
+	{
+		delete hint;
+		throw;
 	}
 }
 
-void message::add(void const* part, size_t const& size)
+void message::move(void* part, size_t const& size, zmq_free_fn* release, void* hint)
 {
-	parts_type tmp(_parts.size() + 1);
-
-	for(size_t i = 0; i < _parts.size(); ++i)
+	zmq_msg_t& msg = new_part();
+	if (0 != zmq_msg_init_data(&msg, part, size, release, hint))
 	{
-		zmq_msg_t& dest = tmp[i].msg;
-		if( 0 != zmq_msg_init(&dest) )
-		{
-			throw zmq_internal_exception();
-		}
-
-		zmq_msg_t& src = _parts[i].msg;
-		if( 0 != zmq_msg_move(&dest, &src) )
-		{
-			throw zmq_internal_exception();
-		}
+		_parts.pop_back();
+		throw zmq_internal_exception();
 	}
+}
 
-	std::swap(tmp, _parts);
-
-	zmq_msg_t& msg = _parts.back().msg;
-
+void message::add(void const* part, size_t const& size)
+{
+	zmq_msg_t& msg = new_part();
 	if( 0 != zmq_msg_init_size(&msg, size) )
 	{
+		_parts.pop_back();
 		throw zmq_internal_exception();
 	}
 
@@ -194,6 +176,25 @@ void message::add(void const* part, size_t const& size)
 	memcpy(msg_data, part, size);
 }
 
+void message::clear()
+{
+	for(size_t i = 0; i < _parts.size(); ++i)
+	{
+		zmq_msg_t& msg = _parts[i].msg;
+
+#ifndef NDEBUG // unused assert variable in release
+		int result = zmq_msg_close(&msg);
+		assert(0 == result);
+#else
+		zmq_msg_close(&msg);
+#endif // NDEBUG
+
+	}
+
+	_parts.clear();
+	_read_cursor = 0;
+}
+
 // Stream reader style
 void message::reset_read_cursor()
 {
@@ -427,13 +428,17 @@ message& message::operator<<(std::string const& string)
 }
 
 message::message(message&& source) noexcept
+	: _parts()
+	, _read_cursor(0)
 {
 	std::swap(_parts, source._parts);
+	std::swap(_read_cursor, source._read_cursor);
 }
 
 message& message::operator=(message&& source) noexcept
 {
 	std::swap(_parts, source._parts);
+	std::swap(_read_cursor, source._read_cursor);
 	return *this;
 }
 
@@ -90,13 +90,15 @@ public:
 	}
 
 	// Move operators will take ownership of message parts without copying
-	void move(void* part, size_t& size, release_function const& release);
+	// Warn: Each part moved this way needs a heap allocated copy of the release
+	// function, the templated version below avoids this.
+	void move(void* part, size_t const& size, release_function const& release);
 
 	// Raw move data operation, useful with data structures more than anything else
 	template<typename Object>
 	void move(Object *part)
 	{
-		move(part, sizeof(Object), &deleter_callback<Object>);
+		move(part, sizeof(Object), &deleter_callback<Object>, nullptr);
 	}
 
 	// Copy operators will take copies of any data
@@ -108,6 +110,10 @@ public:
 		*this << part;
 	}
 
+	// Close all parts leaving an empty message, the storage for the parts is
+	// kept so reusing the message for the next send or receive is cheap.
+	void clear();
+
 	// Stream reader style
 	void reset_read_cursor();
 
@@ -170,10 +176,13 @@ private:
 	message(message const&) noexcept;
 	message& operator=(message const&) noexcept;
 
+	void move(void* part, size_t const& size, zmq_free_fn* release, void* hint);
+	zmq_msg_t& new_part();
+
 	static void release_callback(void* data, void* hint);
 
 	template<typename Object>
-	static void deleter_callback(void* data)
+	static void deleter_callback(void* data, void* /* hint */)
 	{
 		delete static_cast<Object*>(data);
 	}
@@ -0,0 +1,231 @@
+#include <cstring>
+#include <exception>
+
+#include "context.hpp"
+#include "exception.hpp"
+#include "poller.hpp"
+#include "pipeline.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+std::atomic<uint64_t> pipelines(0);
+
+}
+
+pipeline::pipeline(context& context, work_function const& work,
+		size_t const& workers /* = std::thread::hardware_concurrency() */,
+		ordering const& order /* = ordering::unordered */)
+	: _context(context)
+	, _work(work)
+	, _order(order)
+	, _name("inproc://zmqpp-pipeline-" + std::to_string(++pipelines))
+	, _ventilator(context, socket_type::push)
+	, _sink(context, socket_type::pull)
+	, _running(true)
+	, _threads()
+	, _started(std::chrono::steady_clock::now())
+	, _next_task(0)
+	, _next_result(0)
+	, _held()
+	, _frame()
+	, _submitted(0)
+	, _processed(0)
+	, _failed(0)
+	, _delivered(0)
+	, _held_count(0)
+{
+	_ventilator.set(socket_option::linger, 0);
+	_ventilator.bind(_name + "-tasks");
+
+	_sink.set(socket_option::linger, 0);
+	_sink.bind(_name + "-results");
+
+	size_t count = (workers > 0) ? workers : 1;
+	for(size_t i = 0; i < count; ++i)
+	{
+		_threads.push_back(std::thread(&pipeline::run, this));
+	}
+}
+
+pipeline::~pipeline()
+{
+	_running.store(false);
+
+	// The wakeup is never drained so every worker sees it
+	_wakeup.signal();
+
+	for(size_t i = 0; i < _threads.size(); ++i)
+	{
+		_threads[i].join();
+	}
+}
+
+size_t pipeline::workers() const
+{
+	return _threads.size();
+}
+
+bool pipeline::submit(message& task, bool const& dont_block /* = false */)
+{
+	uint64_t sequence = _next_task;
+	bool more = task.parts() > 0;
+	int flags = ((more) ? socket::SEND_MORE : socket::NORMAL) | ((dont_block) ? socket::DONT_WAIT : socket::NORMAL);
+
+	// Once the first frame is accepted 0mq takes the rest of the message
+	if (!_ventilator.send_raw(reinterpret_cast<char const*>(&sequence), sizeof(sequence), flags))
+	{
+		return false;
+	}
+
+	if (more)
+	{
+		_ventilator.send(task);
+	}
+
+	++_next_task;
+	++_submitted;
+
+	return true;
+}
+
+bool pipeline::receive(message& result, bool const& dont_block /* = false */)
+{
+	uint64_t sequence;
+	return receive(result, sequence, dont_block);
+}
+
+bool pipeline::receive(message& result, uint64_t& sequence, bool const& dont_block /* = false */)
+{
+	while(true)
+	{
+		if (ordering::sequenced == _order)
+		{
+			auto it = _held.begin();
+			if ((_held.end() != it) && ((*it).first == _next_result))
+			{
+				sequence = (*it).first;
+				result = std::move((*it).second);
+				_held.erase(it);
+				--_held_count;
+
+				++_next_result;
+				++_delivered;
+				return true;
+			}
+		}
+
+		if (!_sink.receive(_frame, (dont_block) ? socket::DONT_WAIT : socket::NORMAL))
+		{
+			return false;
+		}
+
+		// Results only come from our own workers so the frame is always a sequence
+		std::memcpy(&sequence, _frame.data(), sizeof(sequence));
+
+		message_t received;
+		if (_sink.has_more_parts())
+		{
+			_sink.receive(received);
+		}
+
+		if ((ordering::unordered == _order) || (sequence == _next_result))
+		{
+			result = std::move(received);
+			++_next_result;
+			++_delivered;
+			return true;
+		}
+
+		_held.insert(std::make_pair(sequence, std::move(received)));
+		++_held_count;
+	}
+}
+
+pipeline::statistics pipeline::stats() const
+{
+	statistics stats;
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _started).count();
+	stats.submitted = _submitted.load();
+	stats.processed = _processed.load();
+	stats.failed = _failed.load();
+	stats.delivered = _delivered.load();
+	stats.queued = (stats.submitted > stats.processed) ? stats.submitted - stats.processed : 0;
+	stats.held = _held_count.load();
+
+	return stats;
+}
+
+void pipeline::run()
+{
+	socket tasks(_context, socket_type::pull);
+	tasks.set(socket_option::linger, 0);
+	tasks.connect(_name + "-tasks");
+
+	socket results(_context, socket_type::push);
+	results.set(socket_option::linger, 0);
+	results.connect(_name + "-results");
+
+	poller input;
+	input.add(tasks);
+	input.add(_wakeup.file_descriptor());
+
+	poller output;
+	output.add(results, poller::POLL_OUT);
+	output.add(_wakeup.file_descriptor());
+
+	std::string sequence;
+	while(_running.load())
+	{
+		input.poll(poller::WAIT_FOREVER);
+		if (input.has_input(_wakeup.file_descriptor()))
+		{
+			return;
+		}
+
+		while(_running.load() && tasks.receive(sequence, socket::DONT_WAIT))
+		{
+			message_t task;
+			if (tasks.has_more_parts())
+			{
+				tasks.receive(task);
+			}
+
+			message_t result;
+			try
+			{
+				_work(task, result);
+			}
+			catch(std::exception const&)
+			{
+				result = message_t();
+				++_failed;
+			}
+
+			// Counted before sending so a delivered result is always processed
+			++_processed;
+
+			// Wait for room without blocking in send, so stopping is never held up by a full sink
+			bool more = result.parts() > 0;
+			int flags = socket::DONT_WAIT | ((more) ? socket::SEND_MORE : socket::NORMAL);
+			while(!results.send(sequence, flags))
+			{
+				output.poll(poller::WAIT_FOREVER);
+				if (output.has_input(_wakeup.file_descriptor()))
+				{
+					return;
+				}
+			}
+
+			if (more)
+			{
+				results.send(result);
+			}
+		}
+	}
+}
+
+}
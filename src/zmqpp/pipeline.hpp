@@ -0,0 +1,169 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_PIPELINE_HPP_
+#define ZMQPP_PIPELINE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+#include "socket.hpp"
+#include "wakeup.hpp"
+
+namespace zmqpp
+{
+
+class context;
+typedef context context_t;
+typedef message message_t;
+
+/*!
+ * Fan out tasks to worker threads and gather their results.
+ *
+ * The pipeline binds a push socket, the ventilator, and a pull socket, the
+ * sink, on unique inproc endpoints and starts the workers, each of which
+ * owns a pull socket for tasks and a push socket for results. Every task is
+ * sent with an 8 byte sequence number frame in front which the worker keeps
+ * on its result, so the sink can hand results back in submission order when
+ * asked to.
+ *
+ * submit and receive use different sockets, so one thread may feed tasks
+ * while another takes results. If a single thread does both it must keep
+ * receiving, once the high water marks fill up submit blocks until results
+ * are taken.
+ *
+ * A work function that throws std::exception gives an empty result rather
+ * than losing the task, so sequenced delivery never stalls waiting for it.
+ * The failure is counted in the statistics.
+ */
+class pipeline
+{
+public:
+	/*!
+	 * Work run on a worker thread, fills in the result from the task.
+	 */
+	typedef std::function<void (message_t& task, message_t& result)> work_function;
+
+	/*!
+	 * Order results are received in.
+	 */
+	ZMQPP_COMPARABLE_ENUM ordering {
+		unordered, /*!< as soon as a worker finishes them */
+		sequenced  /*!< the order the tasks were submitted, early results are held */
+	};
+
+	/*!
+	 * Counters for each stage, throughput is a count over seconds.
+	 */
+	struct statistics
+	{
+		double seconds;      /*!< time since the pipeline started */
+		uint64_t submitted;  /*!< tasks sent by the ventilator */
+		uint64_t processed;  /*!< tasks finished by the workers */
+		uint64_t failed;     /*!< tasks whose work function threw */
+		uint64_t delivered;  /*!< results returned by receive */
+		uint64_t queued;     /*!< tasks submitted but not yet finished */
+		uint64_t held;       /*!< results waiting for earlier ones to arrive */
+	};
+
+	/*!
+	 * Start the workers.
+	 *
+	 * \param context the context to create all the sockets in.
+	 * \param work the function every worker runs on each task.
+	 * \param workers number of worker threads, defaults to one per core.
+	 * \param order the order receive returns results in.
+	 */
+	pipeline(context_t& context, work_function const& work,
+			size_t const& workers = std::thread::hardware_concurrency(),
+			ordering const& order = ordering::unordered);
+
+	/*!
+	 * Stop and join the workers, tasks not yet finished are dropped.
+	 */
+	~pipeline();
+
+	/*!
+	 * Get the number of worker threads.
+	 *
+	 * \return worker count.
+	 */
+	size_t workers() const;
+
+	/*!
+	 * Send a task to the workers.
+	 *
+	 * \param task the task to send, emptied if it was sent.
+	 * \param dont_block true to return false instead of waiting for room.
+	 * \return true if the task was sent.
+	 */
+	bool submit(message_t& task, bool const& dont_block = false);
+
+	/*!
+	 * Get the next result.
+	 *
+	 * \param result the message to fill, must be empty.
+	 * \param dont_block true to return false instead of waiting for a result.
+	 * \return true if a result was received.
+	 */
+	bool receive(message_t& result, bool const& dont_block = false);
+
+	/*!
+	 * Get the next result and the sequence number of its task.
+	 *
+	 * \param result the message to fill, must be empty.
+	 * \param sequence set to the task's sequence number, counting from zero in submit order.
+	 * \param dont_block true to return false instead of waiting for a result.
+	 * \return true if a result was received.
+	 */
+	bool receive(message_t& result, uint64_t& sequence, bool const& dont_block = false);
+
+	/*!
+	 * Get the counters for each stage, safe to call from any thread.
+	 *
+	 * \return the counters so far.
+	 */
+	statistics stats() const;
+
+private:
+	context_t& _context;
+	work_function _work;
+	ordering _order;
+	std::string _name;
+	socket _ventilator;
+	socket _sink;
+	wakeup _wakeup;
+	std::atomic<bool> _running;
+	std::vector<std::thread> _threads;
+	std::chrono::steady_clock::time_point _started;
+
+	uint64_t _next_task;
+	uint64_t _next_result;
+	std::map<uint64_t, message_t> _held;
+	std::string _frame;
+
+	std::atomic<uint64_t> _submitted;
+	std::atomic<uint64_t> _processed;
+	std::atomic<uint64_t> _failed;
+	std::atomic<uint64_t> _delivered;
+	std::atomic<uint64_t> _held_count;
+
+	void run();
+
+	// No copy - private and not implemented
+	pipeline(pipeline const&);
+	pipeline& operator=(pipeline const&);
+};
+
+}
+
+#endif /* ZMQPP_PIPELINE_HPP_ */
@@ -7,6 +7,9 @@
 #include "socket.hpp"
 #include "poller.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 #include <zmq.h>
 
 namespace zmqpp
@@ -20,8 +23,14 @@ const short poller::POLL_ERROR  = ZMQ_POLLERR;
 
 poller::poller()
 	: _items()
+	, _item_slots()
+	, _slots()
+	, _free_slots()
 	, _index()
 	, _fdindex()
+	, _spin_nanoseconds(0)
+	, _spin_iterations(0)
+	, _statistics()
 {
 
 }
@@ -29,26 +38,112 @@ poller::poller()
 poller::~poller()
 {
 	_items.clear();
+	_item_slots.clear();
+	_slots.clear();
+	_free_slots.clear();
 	_index.clear();
 	_fdindex.clear();
 }
 
-void poller::add(socket& socket, short const& event /* = POLL_IN */)
+poller::handle poller::add(socket& socket, short const& event /* = POLL_IN */)
 {
 	zmq_pollitem_t item { socket, 0, event, 0 };
 
-	size_t index = _items.size();
-	_items.push_back(item);
-	_index[socket] = index;
+	handle added = add_item(item);
+	_index[socket] = added._slot;
+
+	return added;
 }
 
-void poller::add(int const& descriptor, short const& event /* = POLL_IN */)
+poller::handle poller::add(int const& descriptor, short const& event /* = POLL_IN */)
 {
 	zmq_pollitem_t item { nullptr, descriptor, event, 0 };
 
-	size_t index = _items.size();
-	_items.push_back(item);
-	_fdindex[descriptor] = index;
+	handle added = add_item(item);
+	_fdindex[descriptor] = added._slot;
+
+	return added;
+}
+
+void poller::remove(socket const& socket)
+{
+	auto found = _index.find(socket);
+	if (_index.end() == found)
+	{
+		throw exception("this socket is not represented within this poller");
+	}
+
+	remove(handle((*found).second));
+}
+
+void poller::remove(int const& descriptor)
+{
+	auto found = _fdindex.find(descriptor);
+	if (_fdindex.end() == found)
+	{
+		throw exception("this file descriptor is not represented within this poller");
+	}
+
+	remove(handle((*found).second));
+}
+
+void poller::remove(handle const& item)
+{
+	size_t index = item_index(item);
+
+	// Only drop the lookup if it still points here, the same socket may have been added again
+	if (nullptr != _items[index].socket)
+	{
+		auto found = _index.find(_items[index].socket);
+		if ((_index.end() != found) && ((*found).second == item._slot))
+		{
+			_index.erase(found);
+		}
+	}
+	else
+	{
+		auto found = _fdindex.find(_items[index].fd);
+		if ((_fdindex.end() != found) && ((*found).second == item._slot))
+		{
+			_fdindex.erase(found);
+		}
+	}
+
+	size_t last = _items.size() - 1;
+	if (index != last)
+	{
+		_items[index] = _items[last];
+		_item_slots[index] = _item_slots[last];
+		_slots[_item_slots[index]] = index;
+	}
+
+	_items.pop_back();
+	_item_slots.pop_back();
+
+	_slots[item._slot] = handle::invalid;
+	_free_slots.push_back(item._slot);
+}
+
+poller::handle poller::find(socket const& socket) const
+{
+	auto found = _index.find(socket);
+	if (_index.end() == found)
+	{
+		return handle();
+	}
+
+	return handle((*found).second);
+}
+
+poller::handle poller::find(int const& descriptor) const
+{
+	auto found = _fdindex.find(descriptor);
+	if (_fdindex.end() == found)
+	{
+		return handle();
+	}
+
+	return handle((*found).second);
 }
 
 void poller::check_for(socket const& socket, short const& event)
@@ -59,7 +154,7 @@ void poller::check_for(socket const& socket, short const& event)
 		throw exception("this socket is not represented within this poller");
 	}
 
-	_items[(*found).second].events = event;
+	_items[_slots[(*found).second]].events = event;
 }
 
 void poller::check_for(int const& descriptor, short const& event)
@@ -70,11 +165,26 @@ void poller::check_for(int const& descriptor, short const& event)
 		throw exception("this socket is not represented within this poller");
 	}
 
-	_items[(*found).second].events = event;
+	_items[_slots[(*found).second]].events = event;
+}
+
+void poller::check_for(handle const& item, short const& event)
+{
+	_items[item_index(item)].events = event;
 }
 
 bool poller::poll(long timeout /* = WAIT_FOREVER */)
 {
+	++_statistics.polls;
+
+	if (((0 != _spin_nanoseconds) || (0 != _spin_iterations)) && (0 != timeout) && spin(timeout))
+	{
+		++_statistics.spin_hits;
+		return true;
+	}
+
+	++_statistics.blocking_polls;
+
 	int result = zmq_poll(_items.data(), _items.size(), timeout);
 	if (result < 0)
 	{
@@ -84,6 +194,22 @@ bool poller::poll(long timeout /* = WAIT_FOREVER */)
 	return (result > 0);
 }
 
+void poller::set_spin(uint64_t const& nanoseconds, uint64_t const& iterations /* = 0 */)
+{
+	_spin_nanoseconds = nanoseconds;
+	_spin_iterations = iterations;
+}
+
+poller::statistics const& poller::stats() const
+{
+	return _statistics;
+}
+
+void poller::reset_stats()
+{
+	_statistics = statistics();
+}
+
 short poller::events(socket const& socket) const
 {
 	auto found = _index.find(socket);
@@ -92,7 +218,7 @@ short poller::events(socket const& socket) const
 		throw exception("this socket is not represented within this poller");
 	}
 
-	return _items[(*found).second].revents;
+	return _items[_slots[(*found).second]].revents;
 }
 
 short poller::events(int const& descriptor) const
@@ -103,7 +229,133 @@ short poller::events(int const& descriptor) const
 		throw exception("this file descriptor is not represented within this poller");
 	}
 
-	return _items[(*found).second].revents;
+	return _items[_slots[(*found).second]].revents;
+}
+
+short poller::events(handle const& item) const
+{
+	return _items[item_index(item)].revents;
+}
+
+size_t poller::size() const
+{
+	return _items.size();
+}
+
+zmq_pollitem_t const& poller::raw_item(size_t const& index) const
+{
+	return _items[index];
+}
+
+poller::handle poller::raw_handle(size_t const& index) const
+{
+	return handle(_item_slots[index]);
+}
+
+poller::handle poller::add_item(zmq_pollitem_t const& item)
+{
+	size_t slot = _slots.size();
+	if (!_free_slots.empty())
+	{
+		slot = _free_slots.back();
+		_free_slots.pop_back();
+	}
+	else
+	{
+		_slots.push_back(0);
+	}
+
+	_slots[slot] = _items.size();
+	_items.push_back(item);
+	_item_slots.push_back(slot);
+
+	return handle(slot);
+}
+
+bool poller::spin(long& timeout)
+{
+	typedef std::chrono::steady_clock clock_type;
+
+	uint64_t budget = _spin_nanoseconds;
+	if (timeout > 0)
+	{
+		uint64_t limit = static_cast<uint64_t>(timeout) * 1000000;
+		budget = (0 == budget) ? limit : std::min(budget, limit);
+	}
+
+	clock_type::time_point start = clock_type::now();
+	uint64_t elapsed = 0;
+
+	for(uint64_t iteration = 0; (0 == _spin_iterations) || (iteration < _spin_iterations); ++iteration)
+	{
+		++_statistics.spin_iterations;
+
+		bool ready = false;
+		bool descriptors = false;
+		for(size_t i = 0; i < _items.size(); ++i)
+		{
+			zmq_pollitem_t& item = _items[i];
+			item.revents = POLL_NONE;
+
+			if (POLL_NONE == item.events)
+			{
+				continue;
+			}
+
+			if (nullptr == item.socket)
+			{
+				descriptors = true;
+				continue;
+			}
+
+			int events = 0;
+			size_t events_size = sizeof(events);
+			if (0 != zmq_getsockopt(item.socket, ZMQ_EVENTS, &events, &events_size))
+			{
+				throw zmq_internal_exception();
+			}
+
+			item.revents = static_cast<short>(events) & item.events;
+			ready |= (POLL_NONE != item.revents);
+		}
+
+		if (ready)
+		{
+			// A busy socket must not hide ready descriptors, so pick up
+			// their events without waiting
+			if (descriptors && (zmq_poll(_items.data(), _items.size(), 0) < 0))
+			{
+				throw zmq_internal_exception();
+			}
+
+			return true;
+		}
+
+		elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+		if ((0 != budget) && (elapsed >= budget))
+		{
+			break;
+		}
+	}
+
+	// What is left of the timeout goes to the blocking poll
+	if (timeout > 0)
+	{
+		long spent = static_cast<long>(elapsed / 1000000);
+		timeout = (spent < timeout) ? timeout - spent : 0;
+	}
+
+	return false;
+}
+
+size_t poller::item_index(handle const& item) const
+{
+	if ((item._slot >= _slots.size()) || (handle::invalid == _slots[item._slot]))
+	{
+		throw exception("this handle is not represented within this poller");
+	}
+
+	return _slots[item._slot];
 }
 
 }
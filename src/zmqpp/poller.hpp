@@ -8,6 +8,7 @@
 #ifndef ZMQPP_POLLER_HPP_
 #define ZMQPP_POLLER_HPP_
 
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 
@@ -23,10 +24,24 @@ typedef socket socket_t;
  * Polling wrapper.
  *
  * Allows access to polling for any number of sockets or file descriptors.
+ *
+ * Optionally the poller can busy spin on the socket events for a while
+ * before blocking in zmq_poll, trading cpu time for lower wake up latency.
  */
 class poller
 {
 public:
+	/*!
+	 * Counters for how each poll was satisfied.
+	 */
+	struct statistics
+	{
+		uint64_t polls;           /*!< calls to poll */
+		uint64_t spin_hits;       /*!< polls that found events while spinning */
+		uint64_t blocking_polls;  /*!< polls that fell through to zmq_poll */
+		uint64_t spin_iterations; /*!< passes over the sockets while spinning */
+	};
+
 	static const long WAIT_FOREVER; /*!< Block forever flag, default setting. */
 
 	static const short POLL_NONE;   /*!< No polling flags set. */
@@ -34,6 +49,51 @@ public:
 	static const short POLL_OUT;    /*!< Monitor output flag. */
 	static const short POLL_ERROR;  /*!< Monitor error flag.\n Only for file descriptors. */
 
+	/*!
+	 * Stable reference to a monitored socket or file descriptor.
+	 *
+	 * Returned by add and valid until that item is removed, even if other items
+	 * are removed and the poll items are reordered. Using a handle avoids
+	 * looking up the socket or file descriptor on each call.
+	 */
+	class handle
+	{
+	public:
+		/*!
+		 * Construct a handle that refers to nothing.
+		 */
+		handle() : _slot(invalid) { }
+
+		/*!
+		 * Check if this handle refers to an item.
+		 *
+		 * \return true unless default constructed or returned by a failed find.
+		 */
+		bool valid() const { return invalid != _slot; }
+
+		/*!
+		 * Get the slot number of this handle.
+		 *
+		 * Slots are small integers that are reused after an item is removed,
+		 * they are suitable for indexing side tables kept alongside the poller.
+		 *
+		 * \return the slot number.
+		 */
+		size_t slot() const { return _slot; }
+
+		bool operator==(handle const& other) const { return _slot == other._slot; }
+		bool operator!=(handle const& other) const { return _slot != other._slot; }
+
+	private:
+		static const size_t invalid = static_cast<size_t>(-1);
+		size_t _slot;
+
+		explicit handle(size_t const& slot) : _slot(slot) { }
+
+		friend class poller;
+		friend class epoll_poller;
+	};
+
 	/*!
 	 * Construct an empty polling model.
 	 */
@@ -51,16 +111,58 @@ public:
 	 *
 	 * \param socket the socket to monitor.
 	 * \param event the event flags to monitor on the socket.
+	 * \return a handle for the socket within this poller.
 	 */
-	void add(socket_t& socket, short const& event = POLL_IN);
+	handle add(socket_t& socket, short const& event = POLL_IN);
 
 	/*!
 	 * Add a file descriptor to the polling model and set which events to monitor.
 	 *
 	 * \param descriptor the file descriptor to monitor.
 	 * \param event the event flags to monitor.
+	 * \return a handle for the file descriptor within this poller.
+	 */
+	handle add(int const& descriptor, short const& event = POLL_IN | POLL_ERROR );
+
+	/*!
+	 * Stop monitoring a socket.
+	 *
+	 * The last poll item is moved into the gap so this is constant time, any
+	 * handle other than the one for this socket remains valid.
+	 *
+	 * \param socket the socket to remove.
+	 */
+	void remove(socket_t const& socket);
+
+	/*!
+	 * Stop monitoring a file descriptor.
+	 *
+	 * \param descriptor the file descriptor to remove.
+	 */
+	void remove(int const& descriptor);
+
+	/*!
+	 * Stop monitoring a socket or file descriptor by handle.
+	 *
+	 * \param item handle returned by add.
 	 */
-	void add(int const& descriptor, short const& event = POLL_IN | POLL_ERROR );
+	void remove(handle const& item);
+
+	/*!
+	 * Find the handle for a socket.
+	 *
+	 * \param socket the socket to find.
+	 * \return the handle, which is not valid if the socket is not in this poller.
+	 */
+	handle find(socket_t const& socket) const;
+
+	/*!
+	 * Find the handle for a file descriptor.
+	 *
+	 * \param descriptor the file descriptor to find.
+	 * \return the handle, which is not valid if the descriptor is not in this poller.
+	 */
+	handle find(int const& descriptor) const;
 
 	/*!
 	 * Update the monitored event flags for a given socket.
@@ -78,6 +180,14 @@ public:
 	 */
 	void check_for(int const& descriptor, short const& event);
 
+	/*!
+	 * Update the monitored event flags for a given handle.
+	 *
+	 * \param item handle returned by add.
+	 * \param event the event flags to monitor.
+	 */
+	void check_for(handle const& item, short const& event);
+
 	/*!
 	 * Poll for monitored events.
 	 *
@@ -91,6 +201,34 @@ public:
 	 */
 	bool poll(long timeout = WAIT_FOREVER);
 
+	/*!
+	 * Busy spin before blocking in poll.
+	 *
+	 * While spinning each socket's events are read directly, file descriptors
+	 * are checked by a zero timeout zmq_poll when a socket is found ready or
+	 * by the blocking zmq_poll once spinning gives up. The spin
+	 * stops when either budget runs out or the poll timeout is reached. Polls
+	 * with a zero timeout never spin.
+	 *
+	 * Setting both budgets to zero, the default, disables spinning.
+	 *
+	 * \param nanoseconds longest time to spin for, zero for no time limit.
+	 * \param iterations most passes over the sockets, zero for no limit.
+	 */
+	void set_spin(uint64_t const& nanoseconds, uint64_t const& iterations = 0);
+
+	/*!
+	 * Get the counters for how polls were satisfied.
+	 *
+	 * \return the counters since construction or the last reset.
+	 */
+	statistics const& stats() const;
+
+	/*!
+	 * Reset all the poll counters to zero.
+	 */
+	void reset_stats();
+
 	/*!
 	 * Get the event flags triggered for a socket.
 	 *
@@ -107,6 +245,14 @@ public:
 	 */
 	short events(int const& descriptor) const;
 
+	/*!
+	 * Get the event flags triggered for a handle.
+	 *
+	 * \param item handle returned by add.
+	 * \return the event flags.
+	 */
+	short events(handle const& item) const;
+
 	/*!
 	 * Check either a file descriptor or socket for input events.
 	 *
@@ -143,10 +289,47 @@ public:
 	template<typename Watched>
 	bool has_error(Watched const& watchable) const { return events(watchable) & POLL_ERROR; }
 
+	/*!
+	 * Get the number of sockets and file descriptors being monitored.
+	 *
+	 * \return number of monitored items.
+	 */
+	size_t size() const;
+
+	/*!
+	 * Access to the raw zmq poll item.
+	 *
+	 * Items are in the order they were added until one is removed, at which
+	 * point the last item takes its place. This allows the results of a poll to
+	 * be walked without looking up each socket or file descriptor.
+	 *
+	 * \param index position of the item, must be less than size().
+	 * \return the zmq poll item including the triggered revents.
+	 */
+	zmq_pollitem_t const& raw_item(size_t const& index) const;
+
+	/*!
+	 * Get the handle of a raw item.
+	 *
+	 * \param index position of the item, must be less than size().
+	 * \return the handle for that item.
+	 */
+	handle raw_handle(size_t const& index) const;
+
 private:
 	std::vector<zmq_pollitem_t> _items;
+	std::vector<size_t> _item_slots;
+	std::vector<size_t> _slots;
+	std::vector<size_t> _free_slots;
 	std::unordered_map<void *, size_t> _index;
 	std::unordered_map<int, size_t> _fdindex;
+	uint64_t _spin_nanoseconds;
+	uint64_t _spin_iterations;
+	statistics _statistics;
+
+	handle add_item(zmq_pollitem_t const& item);
+	bool spin(long& timeout);
+	size_t item_index(handle const& item) const;
 };
 
 }
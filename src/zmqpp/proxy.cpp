@@ -0,0 +1,236 @@
+#include <cerrno>
+
+#include <zmq.h>
+
+#include "exception.hpp"
+#include "socket.hpp"
+#include "proxy.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+int receive_frame(zmq_msg_t& frame, void* socket, int const& flags)
+{
+#if (ZMQ_VERSION_MAJOR == 3) and (ZMQ_VERSION_MINOR == 0)
+	return zmq_recvmsg(socket, &frame, flags);
+#else
+	return zmq_msg_recv(&frame, socket, flags);
+#endif
+}
+
+int send_frame(zmq_msg_t& frame, void* socket, int const& flags)
+{
+#if (ZMQ_VERSION_MAJOR == 3) and (ZMQ_VERSION_MINOR == 0)
+	return zmq_sendmsg(socket, &frame, flags);
+#else
+	return zmq_msg_send(&frame, socket, flags);
+#endif
+}
+
+bool valid_pair(socket_type const& frontend, socket_type const& backend)
+{
+	// router to router or dealer to dealer would lose or invent the envelopes
+	if (socket_type::router == frontend)
+	{
+		return socket_type::dealer == backend;
+	}
+
+	if (socket_type::dealer == frontend)
+	{
+		return socket_type::router == backend;
+	}
+
+	if (socket_type::xsubscribe == frontend)
+	{
+		return socket_type::xpublish == backend;
+	}
+
+	if (socket_type::pull == frontend)
+	{
+		return socket_type::push == backend;
+	}
+
+	return false;
+}
+
+}
+
+proxy::proxy(socket& frontend, socket& backend, size_t const& batch_size /* = 256 */)
+	: _frontend(frontend)
+	, _backend(backend)
+	, _capture(nullptr)
+	, _batch_size(batch_size)
+	, _bidirectional(socket_type::pull != frontend.type())
+	, _poller()
+	, _running(true)
+{
+	if (!valid_pair(frontend.type(), backend.type()))
+	{
+		throw exception("proxy sockets must be router and dealer, xsubscribe and xpublish or pull and push");
+	}
+
+	if (0 == batch_size)
+	{
+		throw exception("proxy batch size must be at least one");
+	}
+
+	for(int i = 0; i < 2; ++i)
+	{
+		_counters[i].messages.store(0);
+		_counters[i].frames.store(0);
+		_counters[i].bytes.store(0);
+		_counters[i].batches.store(0);
+	}
+
+	_poller.add(_frontend);
+	if (_bidirectional)
+	{
+		_poller.add(_backend);
+	}
+	_poller.add(_wakeup.file_descriptor());
+}
+
+proxy::~proxy()
+{
+}
+
+void proxy::set_capture(socket* capture)
+{
+	_capture = capture;
+}
+
+bool proxy::poll(long timeout /* = poller::WAIT_FOREVER */)
+{
+	if (!_poller.poll(timeout))
+	{
+		return false;
+	}
+
+	if (_poller.has_input(_wakeup.file_descriptor()))
+	{
+		_wakeup.drain();
+	}
+
+	size_t forwarded = 0;
+	if (_poller.has_input(_frontend))
+	{
+		forwarded += forward(_frontend, _backend, _counters[static_cast<int>(direction::frontend_to_backend)]);
+	}
+
+	if (_bidirectional && _poller.has_input(_backend))
+	{
+		forwarded += forward(_backend, _frontend, _counters[static_cast<int>(direction::backend_to_frontend)]);
+	}
+
+	return forwarded > 0;
+}
+
+void proxy::run()
+{
+	while(_running.load())
+	{
+		poll();
+	}
+}
+
+void proxy::stop()
+{
+	_running.store(false);
+
+	_wakeup.signal();
+}
+
+proxy::statistics proxy::stats(direction const& way) const
+{
+	counters const& totals = _counters[static_cast<int>(way)];
+
+	statistics result;
+	result.messages = totals.messages.load();
+	result.frames = totals.frames.load();
+	result.bytes = totals.bytes.load();
+	result.batches = totals.batches.load();
+
+	return result;
+}
+
+size_t proxy::forward(socket& from, socket& to, counters& totals)
+{
+	void* source = static_cast<void*>(from);
+	void* sink = static_cast<void*>(to);
+	void* capture = (nullptr != _capture) ? static_cast<void*>(*_capture) : nullptr;
+
+	zmq_msg_t frame;
+	zmq_msg_init(&frame);
+
+	size_t messages = 0;
+	uint64_t frames = 0;
+	uint64_t bytes = 0;
+
+	while(messages < _batch_size)
+	{
+		if (receive_frame(frame, source, ZMQ_DONTWAIT) < 0)
+		{
+			if (EAGAIN == zmq_errno())
+			{
+				break;
+			}
+
+			zmq_msg_close(&frame);
+			throw zmq_internal_exception();
+		}
+
+		// The rest of a message is always available once its first frame has arrived
+		bool more = true;
+		bool capturing = (nullptr != capture);
+		while(more)
+		{
+			int has_more = 0;
+			size_t has_more_size = sizeof(has_more);
+			zmq_getsockopt(source, ZMQ_RCVMORE, &has_more, &has_more_size);
+			more = (0 != has_more);
+
+			++frames;
+			bytes += zmq_msg_size(&frame);
+
+			if (capturing)
+			{
+				// Shares the frame data rather than copying it
+				zmq_msg_t copy;
+				zmq_msg_init(&copy);
+				zmq_msg_copy(&copy, &frame);
+				if (send_frame(copy, capture, ZMQ_DONTWAIT | (more ? ZMQ_SNDMORE : 0)) < 0)
+				{
+					// Only the first frame can be refused, skip the rest of the message
+					zmq_msg_close(&copy);
+					capturing = false;
+				}
+			}
+
+			if ((send_frame(frame, sink, more ? ZMQ_SNDMORE : 0) < 0)
+				|| (more && (receive_frame(frame, source, 0) < 0)))
+			{
+				zmq_msg_close(&frame);
+				throw zmq_internal_exception();
+			}
+		}
+
+		++messages;
+	}
+
+	zmq_msg_close(&frame);
+
+	if (messages > 0)
+	{
+		totals.messages.fetch_add(messages, std::memory_order_relaxed);
+		totals.frames.fetch_add(frames, std::memory_order_relaxed);
+		totals.bytes.fetch_add(bytes, std::memory_order_relaxed);
+		totals.batches.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return messages;
+}
+
+}
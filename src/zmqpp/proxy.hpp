@@ -0,0 +1,137 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_PROXY_HPP_
+#define ZMQPP_PROXY_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#include "compatibility.hpp"
+#include "poller.hpp"
+#include "wakeup.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+
+/*!
+ * Forwards messages between a frontend and a backend socket.
+ *
+ * Supported pairs are router and dealer (in either order), xsubscribe
+ * frontend with xpublish backend, and pull frontend with push backend.
+ * Frames are moved from one socket to the other as raw 0mq messages so no
+ * zmqpp::message is built and the frame data is never copied.
+ *
+ * Each time a socket is readable up to the batch size of messages are
+ * drained from it before polling again. A capture socket, if set, gets a
+ * copy of every frame going either way; frames it cannot take straight away
+ * are dropped rather than holding up the proxy.
+ *
+ * The proxy uses the sockets from whichever thread calls run or poll, the
+ * sockets must not be used elsewhere meanwhile. Only stop and stats are
+ * safe to call from other threads.
+ */
+class proxy
+{
+public:
+	/*!
+	 * Which way a message went through the proxy.
+	 */
+	ZMQPP_COMPARABLE_ENUM direction {
+		frontend_to_backend = 0,  /*!< received on the frontend, sent on the backend */
+		backend_to_frontend = 1   /*!< received on the backend, sent on the frontend */
+	};
+
+	/*!
+	 * Traffic counters for one direction, updated once per batch.
+	 */
+	struct statistics
+	{
+		uint64_t messages; /*!< whole messages forwarded */
+		uint64_t frames;   /*!< frames forwarded */
+		uint64_t bytes;    /*!< frame data forwarded */
+		uint64_t batches;  /*!< times the receiving socket was drained */
+	};
+
+	/*!
+	 * Create a proxy between two sockets.
+	 *
+	 * \param frontend the socket clients talk to.
+	 * \param backend the socket workers or publishers talk to.
+	 * \param batch_size most messages forwarded from one socket per poll.
+	 */
+	proxy(socket_t& frontend, socket_t& backend, size_t const& batch_size = 256);
+
+	/*!
+	 * Cleanup the proxy, the sockets are left open.
+	 */
+	~proxy();
+
+	/*!
+	 * Send a copy of every frame to a capture socket.
+	 *
+	 * \param capture socket to copy frames to, or nullptr to stop capturing.
+	 */
+	void set_capture(socket_t* capture);
+
+	/*!
+	 * Wait for messages and forward a batch from each readable socket.
+	 *
+	 * \param timeout milliseconds to wait, or poller::WAIT_FOREVER.
+	 * \return true if any messages were forwarded.
+	 */
+	bool poll(long timeout = poller::WAIT_FOREVER);
+
+	/*!
+	 * Forward messages until stop is called.
+	 */
+	void run();
+
+	/*!
+	 * Make run return, safe to call from any thread.
+	 *
+	 * Stopping is final, any later run returns straight away.
+	 */
+	void stop();
+
+	/*!
+	 * Get the counters for one direction, safe to call from any thread.
+	 *
+	 * \param way which direction to report.
+	 * \return the counters so far.
+	 */
+	statistics stats(direction const& way) const;
+
+private:
+	struct counters
+	{
+		std::atomic<uint64_t> messages;
+		std::atomic<uint64_t> frames;
+		std::atomic<uint64_t> bytes;
+		std::atomic<uint64_t> batches;
+	};
+
+	socket_t& _frontend;
+	socket_t& _backend;
+	socket_t* _capture;
+	size_t _batch_size;
+	bool _bidirectional;
+	poller _poller;
+	wakeup _wakeup;
+	std::atomic<bool> _running;
+	counters _counters[2];
+
+	size_t forward(socket_t& from, socket_t& to, counters& totals);
+
+	// No copy - private and not implemented
+	proxy(proxy const&);
+	proxy& operator=(proxy const&);
+};
+
+}
+
+#endif /* ZMQPP_PROXY_HPP_ */
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <chrono>
+
+#include "exception.hpp"
+#include "socket.hpp"
+#include "reactor.hpp"
+
+namespace zmqpp
+{
+
+reactor::reactor()
+	: _poller()
+	, _timers()
+	, _handlers()
+	, _removed()
+	, _dispatching(false)
+{
+
+}
+
+reactor::~reactor()
+{
+	_handlers.clear();
+	_removed.clear();
+}
+
+poller::handle reactor::add(socket& socket, handler const& callable, short const& event /* = POLL_IN */)
+{
+	poller::handle item = _poller.add(socket, event);
+	store(item, callable);
+
+	return item;
+}
+
+poller::handle reactor::add(int const& descriptor, handler const& callable, short const& event /* = POLL_IN | POLL_ERROR */)
+{
+	poller::handle item = _poller.add(descriptor, event);
+	store(item, callable);
+
+	return item;
+}
+
+void reactor::remove(socket const& socket)
+{
+	poller::handle item = _poller.find(socket);
+	if (!item.valid())
+	{
+		throw exception("this socket is not represented within this reactor");
+	}
+
+	remove(item);
+}
+
+void reactor::remove(int const& descriptor)
+{
+	poller::handle item = _poller.find(descriptor);
+	if (!item.valid())
+	{
+		throw exception("this file descriptor is not represented within this reactor");
+	}
+
+	remove(item);
+}
+
+void reactor::remove(poller::handle const& item)
+{
+	if (!item.valid() || (item.slot() >= _handlers.size()) || !_handlers[item.slot()].active)
+	{
+		throw exception("this handle is not represented within this reactor");
+	}
+
+	_handlers[item.slot()].active = false;
+
+	// Removing from the poller reorders the items being walked, so wait until dispatch is done
+	if (_dispatching)
+	{
+		_removed.push_back(item);
+		return;
+	}
+
+	_poller.remove(item);
+	_handlers[item.slot()].callable = nullptr;
+}
+
+void reactor::check_for(socket const& socket, short const& event)
+{
+	_poller.check_for(socket, event);
+}
+
+void reactor::check_for(int const& descriptor, short const& event)
+{
+	_poller.check_for(descriptor, event);
+}
+
+void reactor::check_for(poller::handle const& item, short const& event)
+{
+	_poller.check_for(item, event);
+}
+
+bool reactor::poll(long timeout /* = WAIT_FOREVER */)
+{
+	timer_wheel::clock_type::time_point deadline = timer_wheel::clock_type::now() + std::chrono::milliseconds(std::max(timeout, 0L));
+	long remaining = timeout;
+
+	while(true)
+	{
+		long wait = remaining;
+		long next = _timers.next_timeout();
+		if ((next >= 0) && ((poller::WAIT_FOREVER == wait) || (next < wait)))
+		{
+			wait = next;
+		}
+
+		bool events = _poller.poll(wait);
+		if (events)
+		{
+			dispatch();
+		}
+
+		size_t fired = _timers.expire();
+		if (events || (fired > 0))
+		{
+			return true;
+		}
+
+		// Woken only to move far off timers along the wheel
+		if (poller::WAIT_FOREVER == timeout)
+		{
+			continue;
+		}
+
+		remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - timer_wheel::clock_type::now()).count();
+		if (remaining <= 0)
+		{
+			return false;
+		}
+	}
+}
+
+void reactor::dispatch()
+{
+	_dispatching = true;
+
+	try
+	{
+		// only items that existed before dispatch can have events
+		size_t items = _poller.size();
+		for(size_t i = 0; i < items; ++i)
+		{
+			short revents = _poller.raw_item(i).revents;
+			if (poller::POLL_NONE == revents)
+			{
+				continue;
+			}
+
+			entry& target = _handlers[_poller.raw_handle(i).slot()];
+			if (target.active)
+			{
+				target.callable(revents);
+			}
+		}
+	}
+	catch(...)
+	{
+		_dispatching = false;
+		flush_removed();
+		throw;
+	}
+
+	_dispatching = false;
+	flush_removed();
+}
+
+void reactor::store(poller::handle const& item, handler const& callable)
+{
+	if (item.slot() >= _handlers.size())
+	{
+		_handlers.resize(item.slot() + 1);
+	}
+
+	_handlers[item.slot()].callable = callable;
+	_handlers[item.slot()].active = true;
+}
+
+void reactor::flush_removed()
+{
+	for(size_t i = 0; i < _removed.size(); ++i)
+	{
+		_poller.remove(_removed[i]);
+		_handlers[_removed[i].slot()].callable = nullptr;
+	}
+
+	_removed.clear();
+}
+
+}
@@ -0,0 +1,182 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_REACTOR_HPP_
+#define ZMQPP_REACTOR_HPP_
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "compatibility.hpp"
+#include "poller.hpp"
+#include "timer_wheel.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+
+/*!
+ * Callback dispatching event loop.
+ *
+ * A reactor wraps a poller and keeps a handler for each socket or file
+ * descriptor added to it. Each call to poll waits for events and then calls
+ * the handler of every item that has triggered.
+ *
+ * Dispatching walks the poll items directly so there is no per socket lookup
+ * no matter how many sockets are registered.
+ *
+ * The reactor also owns a timer wheel, the poll timeout is shortened to the
+ * next timer and due timers fire after the handlers.
+ */
+class reactor
+{
+public:
+	/*!
+	 * Function called when a monitored socket or file descriptor has events.
+	 *
+	 * The handler is passed the events that were triggered.
+	 */
+	typedef std::function<void (short const& events)> handler;
+
+	/*!
+	 * Construct an empty reactor.
+	 */
+	reactor();
+
+	/*!
+	 * Cleanup reactor.
+	 *
+	 * Any sockets will need to be closed separately.
+	 */
+	~reactor();
+
+	/*!
+	 * Add a socket to the reactor.
+	 *
+	 * Handlers may add more sockets or file descriptors while being called.
+	 *
+	 * \param socket the socket to monitor.
+	 * \param callable the handler to call when the socket has events.
+	 * \param event the event flags to monitor on the socket.
+	 * \return the poller handle for the socket.
+	 */
+	poller::handle add(socket_t& socket, handler const& callable, short const& event = poller::POLL_IN);
+
+	/*!
+	 * Add a file descriptor to the reactor.
+	 *
+	 * \param descriptor the file descriptor to monitor.
+	 * \param callable the handler to call when the file descriptor has events.
+	 * \param event the event flags to monitor.
+	 * \return the poller handle for the file descriptor.
+	 */
+	poller::handle add(int const& descriptor, handler const& callable, short const& event = poller::POLL_IN | poller::POLL_ERROR);
+
+	/*!
+	 * Remove a socket and its handler from the reactor.
+	 *
+	 * If called from within a handler the removal takes effect once the
+	 * current dispatch has finished, the removed handler is not called again.
+	 *
+	 * \param socket the socket to remove.
+	 */
+	void remove(socket_t const& socket);
+
+	/*!
+	 * Remove a file descriptor and its handler from the reactor.
+	 *
+	 * \param descriptor the file descriptor to remove.
+	 */
+	void remove(int const& descriptor);
+
+	/*!
+	 * Remove a socket or file descriptor and its handler by handle.
+	 *
+	 * \param item handle returned by add.
+	 */
+	void remove(poller::handle const& item);
+
+	/*!
+	 * Update the monitored event flags for a given socket.
+	 *
+	 * \param socket the socket to update event flags.
+	 * \param event the event flags to monitor on the socket.
+	 */
+	void check_for(socket_t const& socket, short const& event);
+
+	/*!
+	 * Update the monitored event flags for a given file descriptor.
+	 *
+	 * \param descriptor the file descriptor to update event flags.
+	 * \param event the event flags to monitor.
+	 */
+	void check_for(int const& descriptor, short const& event);
+
+	/*!
+	 * Update the monitored event flags for a given handle.
+	 *
+	 * \param item handle returned by add.
+	 * \param event the event flags to monitor.
+	 */
+	void check_for(poller::handle const& item, short const& event);
+
+	/*!
+	 * Poll for events and call the handlers of everything that triggered.
+	 *
+	 * By default this method will block forever or until at least one of the
+	 * monitored sockets or file descriptors has events or a timer fires.
+	 *
+	 * \param timeout milliseconds to timeout.
+	 * \return true if any handlers or timers were called.
+	 */
+	bool poll(long timeout = poller::WAIT_FOREVER);
+
+	/*!
+	 * Access the underlying poller.
+	 *
+	 * Useful for checking events after a poll, items should only be added
+	 * through the reactor.
+	 *
+	 * \return the poller used by the reactor.
+	 */
+	poller& get_poller() { return _poller; }
+
+	/*!
+	 * Access the timers fired by this reactor.
+	 *
+	 * Timers can be added and cancelled from within handlers and timer
+	 * callbacks.
+	 *
+	 * \return the reactor's timer wheel.
+	 */
+	timer_wheel& timers() { return _timers; }
+
+private:
+	struct entry
+	{
+		handler callable;
+		bool active;
+	};
+
+	poller _poller;
+	timer_wheel _timers;
+	std::deque<entry> _handlers; // by poller slot, deque so adding from a handler never moves the running one
+	std::vector<poller::handle> _removed;
+	bool _dispatching;
+
+	void store(poller::handle const& item, handler const& callable);
+	void flush_removed();
+	void dispatch();
+
+	// No copy - private and not implemented
+	reactor(reactor const&);
+	reactor& operator=(reactor const&);
+};
+
+}
+
+#endif /* ZMQPP_REACTOR_HPP_ */
@@ -0,0 +1,397 @@
+#include <cstdint>
+
+#include "exception.hpp"
+#include "reactor.hpp"
+#include "reactor_pool.hpp"
+#include "wakeup.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+// Pool and index of the pool thread we are running on, if any
+thread_local reactor_pool const* pool_of_thread = nullptr;
+thread_local size_t index_of_thread = 0;
+
+/*
+ * Unbounded multiple producer, single consumer queue.
+ *
+ * Producers swap themselves in as the head so pushing never waits on other
+ * producers, only the owning thread pops.
+ */
+template<typename Type>
+class mpsc_queue
+{
+public:
+	mpsc_queue()
+		: _head(new node())
+		, _tail(_head.load())
+	{
+
+	}
+
+	~mpsc_queue()
+	{
+		Type discard;
+		while(pop(discard)) { }
+		delete _tail;
+	}
+
+	void push(Type const& value)
+	{
+		node* item = new node();
+		item->value = value;
+
+		node* previous = _head.exchange(item);
+		previous->next.store(item);
+	}
+
+	bool pop(Type& value)
+	{
+		node* next = _tail->next.load();
+		if (nullptr == next)
+		{
+			return false;
+		}
+
+		value = std::move(next->value);
+		next->value = Type();
+
+		delete _tail;
+		_tail = next;
+		return true;
+	}
+
+private:
+	struct node
+	{
+		node() : next(nullptr), value() { }
+
+		std::atomic<node*> next;
+		Type value;
+	};
+
+	std::atomic<node*> _head;
+	node* _tail;
+};
+
+/*
+ * Chase-Lev work stealing deque.
+ *
+ * The owning thread pushes and pops at the bottom, any other thread may steal
+ * from the top. Grown rings are kept until destruction as a thief may still
+ * be reading from an old one.
+ */
+template<typename Type>
+class steal_deque
+{
+public:
+	steal_deque()
+		: _top(0)
+		, _bottom(0)
+		, _ring(nullptr)
+		, _rings()
+	{
+		_rings.push_back(std::unique_ptr<ring>(new ring(64)));
+		_ring.store(_rings.back().get());
+	}
+
+	~steal_deque()
+	{
+		Type* item = nullptr;
+		while(nullptr != (item = pop()))
+		{
+			delete item;
+		}
+	}
+
+	void push(Type* item)
+	{
+		int64_t bottom = _bottom.load();
+		int64_t top = _top.load();
+		ring* current = _ring.load();
+
+		if (bottom - top >= static_cast<int64_t>(current->capacity))
+		{
+			_rings.push_back(std::unique_ptr<ring>(new ring(current->capacity * 2)));
+			ring* grown = _rings.back().get();
+			for(int64_t i = top; i < bottom; ++i)
+			{
+				grown->put(i, current->get(i));
+			}
+
+			_ring.store(grown);
+			current = grown;
+		}
+
+		current->put(bottom, item);
+		_bottom.store(bottom + 1);
+	}
+
+	Type* pop()
+	{
+		int64_t bottom = _bottom.load() - 1;
+		ring* current = _ring.load();
+		_bottom.store(bottom);
+
+		int64_t top = _top.load();
+		if (top > bottom)
+		{
+			_bottom.store(bottom + 1);
+			return nullptr;
+		}
+
+		Type* item = current->get(bottom);
+		if (top == bottom)
+		{
+			// last item, race any thieves for it
+			if (!_top.compare_exchange_strong(top, top + 1))
+			{
+				item = nullptr;
+			}
+
+			_bottom.store(bottom + 1);
+		}
+
+		return item;
+	}
+
+	Type* steal()
+	{
+		int64_t top = _top.load();
+		int64_t bottom = _bottom.load();
+		if (top >= bottom)
+		{
+			return nullptr;
+		}
+
+		Type* item = _ring.load()->get(top);
+		if (!_top.compare_exchange_strong(top, top + 1))
+		{
+			return nullptr;
+		}
+
+		return item;
+	}
+
+	bool empty() const
+	{
+		return _top.load() >= _bottom.load();
+	}
+
+private:
+	struct ring
+	{
+		explicit ring(size_t const& size)
+			: capacity(size)
+			, items(new std::atomic<Type*>[size])
+		{
+
+		}
+
+		Type* get(int64_t const& index) const { return items[index & (capacity - 1)].load(); }
+		void put(int64_t const& index, Type* item) { items[index & (capacity - 1)].store(item); }
+
+		size_t capacity;
+		std::unique_ptr<std::atomic<Type*>[]> items;
+	};
+
+	std::atomic<int64_t> _top;
+	std::atomic<int64_t> _bottom;
+	std::atomic<ring*> _ring;
+	std::vector<std::unique_ptr<ring>> _rings;
+};
+
+}
+
+/*
+ * Everything owned by a single pool thread.
+ */
+class reactor_pool::worker
+{
+public:
+	worker()
+		: loop()
+		, jobs()
+		, tasks()
+		, signalled(false)
+		, idle(false)
+		, thread()
+		, wake()
+	{
+	}
+
+	// Wake the thread unless a wake up is already pending
+	void signal()
+	{
+		if (!signalled.exchange(true))
+		{
+			wake.signal();
+		}
+	}
+
+	void drain(std::atomic<bool> const& running)
+	{
+		wake.drain();
+
+		// cleared before the queue is read so a push after this point signals again
+		signalled.store(false);
+
+		// once stopped whatever is still queued is dropped with the worker
+		job work;
+		while(running.load() && jobs.pop(work))
+		{
+			work(loop);
+		}
+	}
+
+	reactor loop;
+	mpsc_queue<job> jobs;
+	steal_deque<task> tasks;
+	std::atomic<bool> signalled;
+	std::atomic<bool> idle;
+	std::thread thread;
+	wakeup wake;
+};
+
+const size_t reactor_pool::not_in_pool = static_cast<size_t>(-1);
+
+reactor_pool::reactor_pool(size_t const& threads /* = std::thread::hardware_concurrency() */)
+	: _workers()
+	, _next(0)
+	, _running(true)
+{
+	size_t count = (threads > 0) ? threads : 1;
+	for(size_t i = 0; i < count; ++i)
+	{
+		_workers.push_back(std::unique_ptr<worker>(new worker()));
+	}
+
+	// Only start once every worker exists as they steal from each other
+	for(size_t i = 0; i < count; ++i)
+	{
+		_workers[i]->thread = std::thread(&reactor_pool::run, this, i);
+	}
+}
+
+reactor_pool::~reactor_pool()
+{
+	stop();
+}
+
+size_t reactor_pool::size() const
+{
+	return _workers.size();
+}
+
+void reactor_pool::post(size_t const& thread, job const& work)
+{
+	if (thread >= _workers.size())
+	{
+		throw exception("reactor pool thread index out of range");
+	}
+
+	_workers[thread]->jobs.push(work);
+	_workers[thread]->signal();
+}
+
+void reactor_pool::submit(task const& work)
+{
+	size_t index = current();
+	if (not_in_pool == index)
+	{
+		// The deque can only be pushed to by its owner so hand it over first
+		post(_next++ % _workers.size(), [this, work](reactor&) { submit(work); });
+		return;
+	}
+
+	_workers[index]->tasks.push(new task(work));
+	wake_idle();
+}
+
+void reactor_pool::stop()
+{
+	if (!_running.exchange(false))
+	{
+		return;
+	}
+
+	for(size_t i = 0; i < _workers.size(); ++i)
+	{
+		_workers[i]->signal();
+	}
+
+	for(size_t i = 0; i < _workers.size(); ++i)
+	{
+		_workers[i]->thread.join();
+	}
+}
+
+size_t reactor_pool::current() const
+{
+	return (this == pool_of_thread) ? index_of_thread : not_in_pool;
+}
+
+void reactor_pool::run(size_t const& index)
+{
+	pool_of_thread = this;
+	index_of_thread = index;
+
+	worker& self = *_workers[index];
+	self.loop.add(self.wake.file_descriptor(), [this, &self](short const&) { self.drain(_running); });
+
+	while(_running.load())
+	{
+		task* work = take(index);
+		if (nullptr == work)
+		{
+			// Flag as idle before the last look so a submit either sees it or we see the task
+			self.idle.store(true);
+			work = take(index);
+			if (nullptr == work)
+			{
+				self.loop.poll();
+			}
+			self.idle.store(false);
+		}
+
+		if (nullptr != work)
+		{
+			(*work)();
+			delete work;
+
+			// Keep sockets serviced between tasks
+			self.loop.poll(0);
+		}
+	}
+
+	pool_of_thread = nullptr;
+}
+
+reactor_pool::task* reactor_pool::take(size_t const& index)
+{
+	task* work = _workers[index]->tasks.pop();
+
+	for(size_t i = 1; (nullptr == work) && (i < _workers.size()); ++i)
+	{
+		work = _workers[(index + i) % _workers.size()]->tasks.steal();
+	}
+
+	return work;
+}
+
+void reactor_pool::wake_idle()
+{
+	for(size_t i = 0; i < _workers.size(); ++i)
+	{
+		if (_workers[i]->idle.load() && !_workers[i]->signalled.load())
+		{
+			_workers[i]->signal();
+			return;
+		}
+	}
+}
+
+}
@@ -0,0 +1,128 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_REACTOR_POOL_HPP_
+#define ZMQPP_REACTOR_POOL_HPP_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "compatibility.hpp"
+
+namespace zmqpp
+{
+
+class reactor;
+
+/*!
+ * Pool of threads each running their own reactor.
+ *
+ * 0mq sockets must only be used from one thread, so each pool thread owns a
+ * reactor and any sockets created on it. Work that touches sockets is posted
+ * to a specific thread through a lock free queue, the thread is woken through
+ * a pipe registered with its reactor.
+ *
+ * Cpu bound tasks that do not touch sockets are submitted to the pool as a
+ * whole. Each thread keeps its own work stealing deque and idle threads take
+ * work from busy ones, so handlers can spread load across every core without
+ * moving any sockets.
+ *
+ * Jobs, tasks and handlers must not throw, an exception escaping a pool
+ * thread terminates the process as it would for any other std::thread.
+ */
+class reactor_pool
+{
+public:
+	/*!
+	 * Work run on a specific pool thread, passed that thread's reactor.
+	 */
+	typedef std::function<void (reactor&)> job;
+
+	/*!
+	 * Cpu bound work that may be run on any pool thread.
+	 */
+	typedef std::function<void ()> task;
+
+	static const size_t not_in_pool; /*!< Returned by current when not called on a pool thread. */
+
+	/*!
+	 * Start a pool of reactor threads.
+	 *
+	 * \param threads number of threads, defaults to one per core.
+	 */
+	reactor_pool(size_t const& threads = std::thread::hardware_concurrency());
+
+	/*!
+	 * Stop and join all the pool threads.
+	 *
+	 * Sockets created on the pool threads should be closed by posted jobs
+	 * before this point.
+	 */
+	~reactor_pool();
+
+	/*!
+	 * Get the number of threads in the pool.
+	 *
+	 * \return thread count.
+	 */
+	size_t size() const;
+
+	/*!
+	 * Run a job on a specific thread.
+	 *
+	 * Safe to call from any thread. Jobs posted to the same thread run in the
+	 * order they were posted, create and add sockets to the reactor here.
+	 *
+	 * \param thread index of the thread, less than size().
+	 * \param work the job to run.
+	 */
+	void post(size_t const& thread, job const& work);
+
+	/*!
+	 * Run a cpu bound task on whichever thread gets to it first.
+	 *
+	 * Safe to call from any thread. When called from a pool thread the task
+	 * goes onto that thread's own deque, otherwise the threads take turns.
+	 *
+	 * \param work the task to run.
+	 */
+	void submit(task const& work);
+
+	/*!
+	 * Stop all the threads and wait for them to finish.
+	 *
+	 * Jobs and tasks already running are finished, those not yet started are
+	 * dropped. Must not be called from a pool thread.
+	 */
+	void stop();
+
+	/*!
+	 * Get the index of the pool thread this is called from.
+	 *
+	 * \return the thread index or not_in_pool.
+	 */
+	size_t current() const;
+
+private:
+	class worker;
+
+	std::vector<std::unique_ptr<worker>> _workers;
+	std::atomic<size_t> _next;
+	std::atomic<bool> _running;
+
+	void run(size_t const& index);
+	task* take(size_t const& index);
+	void wake_idle();
+
+	// No copy - private and not implemented
+	reactor_pool(reactor_pool const&);
+	reactor_pool& operator=(reactor_pool const&);
+};
+
+}
+
+#endif /* ZMQPP_REACTOR_POOL_HPP_ */
@@ -0,0 +1,265 @@
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include "exception.hpp"
+#include "socket.hpp"
+#include "rpc_client.hpp"
+
+namespace zmqpp
+{
+
+rpc_client::rpc_client(socket& socket, size_t const& window /* = 64 */,
+		std::chrono::milliseconds const& timeout /* = std::chrono::milliseconds(1000) */)
+	: _socket(socket)
+	, _window(window)
+	, _timeout(timeout.count())
+	, _poller()
+	, _timers()
+	, _next_id(0)
+	, _in_flight(0)
+	, _requests()
+	, _waiting()
+	, _frame()
+	, _finished(0)
+	, _stats()
+{
+	if (socket_type::dealer != socket.type())
+	{
+		throw exception("rpc clients require a dealer socket");
+	}
+
+	if (0 == window)
+	{
+		throw exception("rpc client window must allow at least one request");
+	}
+
+	_poller.add(_socket);
+}
+
+rpc_client::~rpc_client()
+{
+}
+
+void rpc_client::call(message& request, callback const& handler,
+		std::chrono::milliseconds const& timeout /* = std::chrono::milliseconds(0) */)
+{
+	if (0 == request.parts())
+	{
+		throw std::invalid_argument("sending requires messages have at least one part");
+	}
+
+	uint64_t id = _next_id++;
+	long milliseconds = (timeout.count() > 0) ? timeout.count() : _timeout;
+
+	// References into an unordered_map survive later inserts
+	rpc_client::request& entry = _requests[id];
+	entry.handler = handler;
+	entry.timer = _timers.add(milliseconds, [this, id]() { expire(id); });
+	entry.sent = false;
+
+	++_stats.requests;
+
+	// Anything already waiting goes first so requests leave in call order
+	if ((_in_flight < _window) && _waiting.empty() && send(id, request))
+	{
+		entry.sent = true;
+		return;
+	}
+
+	entry.message = std::move(request);
+	_waiting.push_back(id);
+	++_stats.queued;
+}
+
+std::future<message> rpc_client::call(message& request,
+		std::chrono::milliseconds const& timeout /* = std::chrono::milliseconds(0) */)
+{
+	std::shared_ptr<std::promise<message_t>> promise = std::make_shared<std::promise<message_t>>();
+	std::future<message_t> future = promise->get_future();
+
+	call(request, [promise](status const& outcome, message_t& reply) {
+		if (status::replied == outcome)
+		{
+			promise->set_value(std::move(reply));
+		}
+		else
+		{
+			promise->set_exception(std::make_exception_ptr(exception("request timed out")));
+		}
+	}, timeout);
+
+	return future;
+}
+
+size_t rpc_client::poll(long timeout /* = poller::WAIT_FOREVER */)
+{
+	long next = _timers.next_timeout();
+	if ((next >= 0) && ((timeout < 0) || (next < timeout)))
+	{
+		timeout = next;
+	}
+
+	_poller.poll(timeout);
+
+	return process();
+}
+
+size_t rpc_client::process()
+{
+	_finished = 0;
+
+	receive();
+	_timers.expire();
+	fill_window();
+
+	return _finished;
+}
+
+long rpc_client::timeout() const
+{
+	return _timers.next_timeout();
+}
+
+size_t rpc_client::in_flight() const
+{
+	return _in_flight;
+}
+
+size_t rpc_client::queued() const
+{
+	return _requests.size() - _in_flight;
+}
+
+rpc_client::statistics rpc_client::stats() const
+{
+	return _stats;
+}
+
+bool rpc_client::send(uint64_t const& id, message& message)
+{
+	// The id only has to mean something to this client so byte order does not matter.
+	// Never block, with the server gone the dealer fills up and timeouts must still fire.
+	if (!_socket.send_raw(reinterpret_cast<char const*>(&id), sizeof(id), socket::SEND_MORE | socket::DONT_WAIT))
+	{
+		return false;
+	}
+
+	// Once the first frame is accepted 0mq takes the rest of the message
+	_socket.send_raw("", 0, socket::SEND_MORE);
+	_socket.send(message);
+
+	++_in_flight;
+	return true;
+}
+
+void rpc_client::fill_window()
+{
+	while((_in_flight < _window) && !_waiting.empty())
+	{
+		uint64_t id = _waiting.front();
+
+		// Requests that timed out while waiting are already gone
+		auto it = _requests.find(id);
+		if (_requests.end() == it)
+		{
+			_waiting.pop_front();
+			continue;
+		}
+
+		// The socket is full, try again on the next process
+		if (!send(id, (*it).second.message))
+		{
+			break;
+		}
+
+		_waiting.pop_front();
+		(*it).second.sent = true;
+	}
+}
+
+void rpc_client::receive()
+{
+	while(_socket.receive(_frame, socket::DONT_WAIT))
+	{
+		if ((sizeof(uint64_t) != _frame.size()) || !_socket.has_more_parts())
+		{
+			++_stats.malformed;
+			discard();
+			continue;
+		}
+
+		uint64_t id;
+		std::memcpy(&id, _frame.data(), sizeof(id));
+
+		_socket.receive(_frame);
+		if (!_frame.empty() || !_socket.has_more_parts())
+		{
+			++_stats.malformed;
+			discard();
+			continue;
+		}
+
+		message_t reply;
+		_socket.receive(reply);
+
+		auto it = _requests.find(id);
+		if ((_requests.end() == it) || !(*it).second.sent)
+		{
+			++_stats.late;
+			continue;
+		}
+
+		--_in_flight;
+		++_stats.replies;
+
+		// Taken out of the map first as the handler is free to make new calls
+		rpc_client::request entry = std::move((*it).second);
+		_requests.erase(it);
+		_timers.cancel(entry.timer);
+
+		finish(entry, status::replied, reply);
+	}
+}
+
+void rpc_client::expire(uint64_t const& id)
+{
+	auto it = _requests.find(id);
+	if (_requests.end() == it)
+	{
+		return;
+	}
+
+	if ((*it).second.sent)
+	{
+		--_in_flight;
+	}
+
+	++_stats.timeouts;
+
+	rpc_client::request entry = std::move((*it).second);
+	_requests.erase(it);
+
+	message_t empty;
+	finish(entry, status::timed_out, empty);
+}
+
+void rpc_client::finish(request& entry, status const& outcome, message& reply)
+{
+	++_finished;
+
+	if (entry.handler)
+	{
+		entry.handler(outcome, reply);
+	}
+}
+
+void rpc_client::discard()
+{
+	while(_socket.has_more_parts())
+	{
+		_socket.receive(_frame);
+	}
+}
+
+}
@@ -0,0 +1,198 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_RPC_CLIENT_HPP_
+#define ZMQPP_RPC_CLIENT_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <string>
+#include <unordered_map>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+#include "poller.hpp"
+#include "timer_wheel.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Pipelined request client over a dealer socket.
+ *
+ * A request socket only allows one request on the wire at a time, so each
+ * call costs a full round trip. The rpc client sends up to a window of
+ * requests without waiting, each prefixed with an 8 byte correlation id and
+ * an empty delimiter frame, and matches the replies back to their callers in
+ * whatever order they arrive. Calls beyond the window, or made while the
+ * socket cannot take any more messages, wait locally until a reply or
+ * timeout frees a slot. Calls never block on the socket.
+ *
+ * The envelope is the one a reply socket keeps and returns, so reply
+ * servers, router servers that echo the envelope and the broker all work
+ * unchanged.
+ *
+ * Every request has a timeout that starts when call is made. Nothing runs
+ * in the background, replies and timeouts are only handled inside poll or
+ * process, so a future must not be waited on from the thread that polls.
+ * Replies that arrive after their request timed out are dropped.
+ *
+ * Requests still outstanding when the client is destroyed are abandoned,
+ * their callbacks are never called and their futures report a broken
+ * promise.
+ */
+class rpc_client
+{
+public:
+	/*!
+	 * How a request finished.
+	 */
+	ZMQPP_COMPARABLE_ENUM status {
+		replied,  /*!< a reply arrived, it is in the message */
+		timed_out /*!< no reply before the timeout, the message is empty */
+	};
+
+	typedef std::function<void (status const&, message_t&)> callback; /*!< Function called when a request finishes. */
+
+	/*!
+	 * Counters for the client.
+	 */
+	struct statistics
+	{
+		uint64_t requests;  /*!< calls made */
+		uint64_t replies;   /*!< requests that got a reply */
+		uint64_t timeouts;  /*!< requests that timed out */
+		uint64_t late;      /*!< replies dropped as their request had timed out */
+		uint64_t malformed; /*!< messages dropped as they had no valid envelope */
+		uint64_t queued;    /*!< calls that had to wait for the window */
+	};
+
+	/*!
+	 * Create a client on a dealer socket.
+	 *
+	 * \param socket the connected dealer, which must outlive the client.
+	 * \param window most requests sent and waiting for a reply.
+	 * \param timeout default time a request waits for its reply.
+	 */
+	rpc_client(socket_t& socket, size_t const& window = 64,
+			std::chrono::milliseconds const& timeout = std::chrono::milliseconds(1000));
+
+	/*!
+	 * Cleanup the client, outstanding requests are abandoned.
+	 */
+	~rpc_client();
+
+	/*!
+	 * Make a request and get its reply through a callback.
+	 *
+	 * \param request the request to send, emptied.
+	 * \param handler called from poll or process when the request finishes.
+	 * \param timeout time to wait for the reply, or zero for the default.
+	 */
+	void call(message_t& request, callback const& handler,
+			std::chrono::milliseconds const& timeout = std::chrono::milliseconds(0));
+
+	/*!
+	 * Make a request and get its reply through a future.
+	 *
+	 * If the request times out the future throws a zmqpp::exception.
+	 *
+	 * \param request the request to send, emptied.
+	 * \param timeout time to wait for the reply, or zero for the default.
+	 * \return future for the reply.
+	 */
+	std::future<message_t> call(message_t& request,
+			std::chrono::milliseconds const& timeout = std::chrono::milliseconds(0));
+
+	/*!
+	 * Wait for replies and finish any requests that have replies or have
+	 * timed out.
+	 *
+	 * The wait is cut short when the next request is due to time out.
+	 *
+	 * \param timeout milliseconds to wait, or poller::WAIT_FOREVER.
+	 * \return the number of requests finished.
+	 */
+	size_t poll(long timeout = poller::WAIT_FOREVER);
+
+	/*!
+	 * Finish requests without waiting, for use when the socket is watched
+	 * by another poller.
+	 *
+	 * \return the number of requests finished.
+	 */
+	size_t process();
+
+	/*!
+	 * Get how long until process next needs calling for a timeout.
+	 *
+	 * \return milliseconds to wait, zero if overdue or -1 if nothing is outstanding.
+	 */
+	long timeout() const;
+
+	/*!
+	 * Get the number of requests sent and waiting for a reply.
+	 *
+	 * \return in flight request count.
+	 */
+	size_t in_flight() const;
+
+	/*!
+	 * Get the number of requests waiting for the window.
+	 *
+	 * \return queued request count.
+	 */
+	size_t queued() const;
+
+	/*!
+	 * Get the client counters.
+	 *
+	 * \return the counters so far.
+	 */
+	statistics stats() const;
+
+private:
+	struct request
+	{
+		message_t message; // only held until sent
+		callback handler;
+		timer_wheel::timer_id timer;
+		bool sent;
+	};
+
+	socket_t& _socket;
+	size_t _window;
+	long _timeout;
+	poller _poller;
+	timer_wheel _timers;
+	uint64_t _next_id;
+	size_t _in_flight;
+	std::unordered_map<uint64_t, request> _requests;
+	std::deque<uint64_t> _waiting;
+	std::string _frame;
+	size_t _finished; // requests finished by the current process
+	statistics _stats;
+
+	bool send(uint64_t const& id, message_t& message);
+	void fill_window();
+	void receive();
+	void expire(uint64_t const& id);
+	void finish(request& entry, status const& outcome, message_t& reply);
+	void discard();
+
+	// No copy - private and not implemented
+	rpc_client(rpc_client const&);
+	rpc_client& operator=(rpc_client const&);
+};
+
+}
+
+#endif /* ZMQPP_RPC_CLIENT_HPP_ */
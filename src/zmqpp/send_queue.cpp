@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <chrono>
+
+#include "exception.hpp"
+#include "socket.hpp"
+#include "send_queue.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+// Waiting producers recheck at least this often in case a wake up was missed
+const std::chrono::milliseconds recheck_interval(10);
+
+}
+
+send_queue::send_queue(socket& socket, size_t const& capacity /* = 1024 */)
+	: _socket(socket)
+	, _mask(0)
+	, _cells()
+	, _enqueue(0)
+	, _dequeue(0)
+	, _running(true)
+	, _sleeping(false)
+	, _signalled(false)
+	, _blocked(false)
+	, _mutex()
+	, _space()
+	, _waiting(0)
+	, _sent(0)
+	, _rejected(0)
+	, _hwm_stalls(0)
+	, _thread()
+{
+	size_t size = 2;
+	while(size < capacity)
+	{
+		size <<= 1;
+	}
+
+	_mask = size - 1;
+	_cells.reset(new cell[size]);
+	for(size_t i = 0; i < size; ++i)
+	{
+		_cells[i].sequence.store(i);
+	}
+
+	_thread = std::thread(&send_queue::run, this);
+}
+
+send_queue::~send_queue()
+{
+	_running.store(false);
+	signal();
+	_thread.join();
+
+	{
+		// Waiting producers still use our members, let them all leave first
+		std::unique_lock<std::mutex> lock(_mutex);
+		while(_waiting.load() > 0)
+		{
+			_space.notify_all();
+			_space.wait_for(lock, recheck_interval);
+		}
+	}
+}
+
+bool send_queue::try_send(message& message)
+{
+	if (push(message))
+	{
+		return true;
+	}
+
+	_rejected.fetch_add(1);
+	return false;
+}
+
+bool send_queue::send(message& message, long timeout /* = WAIT_FOREVER */)
+{
+	if (push(message))
+	{
+		return true;
+	}
+
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout, 0L));
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_waiting.fetch_add(1);
+
+	bool queued = false;
+	while(_running.load() && !(queued = push(message)))
+	{
+		std::chrono::steady_clock::time_point wake = std::chrono::steady_clock::now() + recheck_interval;
+		if (poller::WAIT_FOREVER != timeout)
+		{
+			if (std::chrono::steady_clock::now() >= deadline)
+			{
+				break;
+			}
+
+			wake = std::min(wake, deadline);
+		}
+
+		_space.wait_until(lock, wake);
+	}
+
+	// The destructor waits for the last producer to leave
+	if (!_running.load())
+	{
+		_space.notify_all();
+	}
+
+	_waiting.fetch_sub(1);
+	return queued;
+}
+
+bool send_queue::blocked() const
+{
+	return _blocked.load();
+}
+
+size_t send_queue::capacity() const
+{
+	return _mask + 1;
+}
+
+send_queue::statistics send_queue::stats() const
+{
+	statistics snapshot;
+	snapshot.sent = _sent.load();
+	snapshot.rejected = _rejected.load();
+	snapshot.hwm_stalls = _hwm_stalls.load();
+
+	return snapshot;
+}
+
+bool send_queue::push(message& message)
+{
+	size_t position = _enqueue.load(std::memory_order_relaxed);
+	cell* target = nullptr;
+
+	while(true)
+	{
+		target = &_cells[position & _mask];
+		size_t sequence = target->sequence.load(std::memory_order_acquire);
+		intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+		if (0 == difference)
+		{
+			if (_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		else
+		{
+			position = _enqueue.load(std::memory_order_relaxed);
+		}
+	}
+
+	// swapped so the caller is left holding the cell's empty message
+	target->value = std::move(message);
+	target->sequence.store(position + 1, std::memory_order_release);
+
+	// Pairs with the owner storing _sleeping then loading _enqueue, without a
+	// full fence the relaxed claim above can be seen after this load
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (_sleeping.load())
+	{
+		signal();
+	}
+
+	return true;
+}
+
+bool send_queue::pop(message& message)
+{
+	cell& target = _cells[_dequeue & _mask];
+	if (target.sequence.load(std::memory_order_acquire) != _dequeue + 1)
+	{
+		return false;
+	}
+
+	message = std::move(target.value);
+	target.sequence.store(_dequeue + _mask + 1, std::memory_order_release);
+	++_dequeue;
+
+	return true;
+}
+
+void send_queue::signal()
+{
+	if (!_signalled.exchange(true))
+	{
+		_wakeup.signal();
+	}
+}
+
+void send_queue::run()
+{
+	poller poller;
+	poller::handle wake = poller.add(_wakeup.file_descriptor());
+	poller::handle output = poller.add(_socket, poller::POLL_NONE);
+
+	message pending;
+	bool have_pending = false;
+
+	while(_running.load())
+	{
+		bool progress = false;
+		if (!have_pending)
+		{
+			have_pending = pop(pending);
+			progress = have_pending;
+		}
+
+		while(have_pending && _socket.send(pending, true))
+		{
+			_sent.fetch_add(1, std::memory_order_relaxed);
+			have_pending = pop(pending);
+			progress = true;
+		}
+
+		if (progress && (_waiting.load() > 0))
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_space.notify_all();
+		}
+
+		if (have_pending)
+		{
+			if (!_blocked.exchange(true))
+			{
+				_hwm_stalls.fetch_add(1);
+			}
+
+			poller.check_for(output, poller::POLL_OUT);
+		}
+		else
+		{
+			_blocked.store(false);
+			poller.check_for(output, poller::POLL_NONE);
+
+			// Flag as sleeping before the last look so a producer either sees it or we see the message
+			_sleeping.store(true);
+			if (_enqueue.load() != _dequeue)
+			{
+				_sleeping.store(false);
+				continue;
+			}
+		}
+
+		poller.poll();
+		_sleeping.store(false);
+
+		if (poller.has_input(wake) || poller.has_error(wake))
+		{
+			_wakeup.drain();
+			_signalled.store(false);
+		}
+	}
+}
+
+}
@@ -0,0 +1,157 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_SEND_QUEUE_HPP_
+#define ZMQPP_SEND_QUEUE_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+#include "poller.hpp"
+#include "wakeup.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Thread safe front end for sending on a single socket.
+ *
+ * Sockets must only be used from one thread. A send queue takes over a
+ * socket and runs its own thread which is then the only user of that socket.
+ * Any number of threads can queue messages through a bounded lock free queue
+ * and the owner thread sends everything waiting each time it wakes.
+ *
+ * When the queue is full, because the socket has reached its high water
+ * mark or the owner thread cannot keep up, try_send fails and send waits.
+ * This is the backpressure signal to producers.
+ */
+class send_queue
+{
+public:
+	/*!
+	 * Counters for the queue, all approximate while messages are in flight.
+	 */
+	struct statistics
+	{
+		uint64_t sent;       /*!< messages handed to the socket */
+		uint64_t rejected;   /*!< try_send calls refused as the queue was full */
+		uint64_t hwm_stalls; /*!< times the socket stopped accepting messages */
+	};
+
+	/*!
+	 * Take over a socket and start the owner thread.
+	 *
+	 * The socket must not be used by any other thread until the send queue
+	 * is destroyed.
+	 *
+	 * \param socket the socket to send on.
+	 * \param capacity most messages waiting, rounded up to a power of two.
+	 */
+	send_queue(socket_t& socket, size_t const& capacity = 1024);
+
+	/*!
+	 * Stop the owner thread.
+	 *
+	 * Messages that have not been handed to the socket are dropped, after
+	 * this the socket can be used from the destroying thread again. Any
+	 * producers waiting in send are woken and have returned false before
+	 * this finishes.
+	 */
+	~send_queue();
+
+	/*!
+	 * Queue a message without waiting.
+	 *
+	 * Safe to call from any thread.
+	 *
+	 * \param message the message to queue, emptied on success.
+	 * \return true if queued, false if the queue is full and the message is unchanged.
+	 */
+	bool try_send(message_t& message);
+
+	/*!
+	 * Queue a message, waiting for room if needed.
+	 *
+	 * Safe to call from any thread.
+	 *
+	 * \param message the message to queue, emptied on success.
+	 * \param timeout milliseconds to wait for room.
+	 * \return true if queued, false on timeout or when the queue is being
+	 * destroyed, and the message is unchanged.
+	 */
+	bool send(message_t& message, long timeout = poller::WAIT_FOREVER);
+
+	/*!
+	 * Check if the socket is refusing messages.
+	 *
+	 * \return true while the socket is at its high water mark.
+	 */
+	bool blocked() const;
+
+	/*!
+	 * Get the most messages that can be waiting.
+	 *
+	 * \return queue capacity.
+	 */
+	size_t capacity() const;
+
+	/*!
+	 * Get the queue counters.
+	 *
+	 * \return a snapshot of the counters.
+	 */
+	statistics stats() const;
+
+private:
+	struct cell
+	{
+		std::atomic<size_t> sequence;
+		message_t value;
+	};
+
+	socket_t& _socket;
+	size_t _mask;
+	std::unique_ptr<cell[]> _cells;
+	std::atomic<size_t> _enqueue;
+	size_t _dequeue;
+
+	std::atomic<bool> _running;
+	std::atomic<bool> _sleeping;
+	std::atomic<bool> _signalled;
+	std::atomic<bool> _blocked;
+	wakeup _wakeup;
+
+	std::mutex _mutex;
+	std::condition_variable _space;
+	std::atomic<size_t> _waiting;
+
+	std::atomic<uint64_t> _sent;
+	std::atomic<uint64_t> _rejected;
+	std::atomic<uint64_t> _hwm_stalls;
+
+	std::thread _thread;
+
+	bool push(message_t& message);
+	bool pop(message_t& message);
+	void signal();
+	void run();
+
+	// No copy - private and not implemented
+	send_queue(send_queue const&);
+	send_queue& operator=(send_queue const&);
+};
+
+}
+
+#endif /* ZMQPP_SEND_QUEUE_HPP_ */
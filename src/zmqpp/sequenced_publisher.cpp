@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#include "exception.hpp"
+#include "inet.hpp"
+#include "socket.hpp"
+#include "sequenced_publisher.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+uint64_t new_epoch()
+{
+	// The clock covers a random device that only gives out a fixed sequence
+	std::random_device random;
+	uint64_t epoch = (static_cast<uint64_t>(random()) << 32) ^ random();
+	epoch ^= static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+
+	return (0 == epoch) ? 1 : epoch;
+}
+
+}
+
+sequenced_publisher::sequenced_publisher(socket& socket, size_t const& history /* = 0 */)
+	: _socket(socket)
+	, _epoch(new_epoch())
+	, _history(history)
+	, _topics()
+	, _stats()
+{
+	if ((socket_type::publish != socket.type()) && (socket_type::xpublish != socket.type()))
+	{
+		throw exception("sequenced publishers require a publish or xpublish socket");
+	}
+}
+
+sequenced_publisher::~sequenced_publisher()
+{
+}
+
+uint64_t sequenced_publisher::send(std::string const& topic, message& body)
+{
+	topic_state& state = _topics[topic];
+	uint64_t sequence = ++state.sequence;
+
+	if (_history > 0)
+	{
+		if (state.history.size() == _history)
+		{
+			state.history.pop_front();
+		}
+
+		state.history.push_back(body.copy());
+	}
+
+	bool more = body.parts() > 0;
+	send_header(_socket, topic, sequence, more);
+	if (more)
+	{
+		_socket.send(body);
+	}
+
+	++_stats.sent;
+
+	return sequence;
+}
+
+uint64_t sequenced_publisher::send(std::string const& topic, std::string const& body)
+{
+	message message;
+	message << body;
+
+	return send(topic, message);
+}
+
+size_t sequenced_publisher::replay(socket& router)
+{
+	size_t served = 0;
+
+	message request;
+	while(router.receive(request, true))
+	{
+		if ((4 != request.parts()) || (sizeof(uint64_t) != request.size(2)) || (sizeof(uint64_t) != request.size(3)))
+		{
+			++_stats.malformed;
+			request = message_t();
+			continue;
+		}
+
+		uint64_t first, last;
+		std::memcpy(&first, request.raw_data(2), sizeof(first));
+		std::memcpy(&last, request.raw_data(3), sizeof(last));
+		first = ntohll(first);
+		last = ntohll(last);
+
+		std::string identity = request.get(0);
+		std::string topic = request.get(1);
+		request = message_t();
+
+		++_stats.requests;
+		++served;
+
+		if (last < first)
+		{
+			continue;
+		}
+
+		auto it = _topics.find(topic);
+		if (_topics.end() == it)
+		{
+			_stats.unavailable += last - first + 1;
+			continue;
+		}
+
+		topic_state& state = (*it).second;
+		uint64_t oldest = state.sequence - state.history.size() + 1;
+		uint64_t from = std::max(first, oldest);
+		uint64_t to = std::min(last, state.sequence);
+
+		if (from > to)
+		{
+			_stats.unavailable += last - first + 1;
+			continue;
+		}
+
+		_stats.unavailable += (last - first) - (to - from);
+
+		for(uint64_t sequence = from; sequence <= to; ++sequence)
+		{
+			// A copy shares the stored frames so the history keeps them
+			message_t body = state.history[sequence - oldest].copy();
+			bool more = body.parts() > 0;
+
+			router.send(identity, socket::SEND_MORE);
+			send_header(router, topic, sequence, more);
+			if (more)
+			{
+				router.send(body);
+			}
+
+			++_stats.replayed;
+		}
+	}
+
+	return served;
+}
+
+uint64_t sequenced_publisher::sequence(std::string const& topic) const
+{
+	auto it = _topics.find(topic);
+	if (_topics.end() == it)
+	{
+		return 0;
+	}
+
+	return (*it).second.sequence;
+}
+
+uint64_t sequenced_publisher::epoch() const
+{
+	return _epoch;
+}
+
+sequenced_publisher::statistics sequenced_publisher::stats() const
+{
+	return _stats;
+}
+
+void sequenced_publisher::send_header(socket& socket, std::string const& topic, uint64_t const& sequence, bool const& more)
+{
+	uint64_t network[2] = { htonll(sequence), htonll(_epoch) };
+
+	socket.send(topic, socket::SEND_MORE);
+	socket.send_raw(reinterpret_cast<char const*>(network), sizeof(network), (more) ? socket::SEND_MORE : socket::NORMAL);
+}
+
+}
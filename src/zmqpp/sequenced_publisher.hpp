@@ -0,0 +1,139 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_SEQUENCED_PUBLISHER_HPP_
+#define ZMQPP_SEQUENCED_PUBLISHER_HPP_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Publisher that numbers the messages on each topic.
+ *
+ * Every message goes out as a topic frame, a 16 byte frame holding the
+ * sequence number and the publisher's epoch, both 8 byte network order, and
+ * then the body parts. Sequences start at one and count up separately for
+ * each topic, so a sequenced_subscriber can spot messages dropped by a high
+ * water mark on the way. The epoch is picked at random for each publisher so
+ * subscribers can tell a restarted publisher from lost or stale messages.
+ *
+ * With a history size set the last messages on each topic are kept, as
+ * shared copies of the 0mq frames rather than copies of the data, and can be
+ * resent to subscribers that ask for them on a router socket.
+ */
+class sequenced_publisher
+{
+public:
+	/*!
+	 * Counters for the publisher.
+	 */
+	struct statistics
+	{
+		uint64_t sent;        /*!< messages published */
+		uint64_t requests;    /*!< replay requests served */
+		uint64_t replayed;    /*!< messages resent for replay requests */
+		uint64_t unavailable; /*!< requested messages no longer in the history */
+		uint64_t malformed;   /*!< replay requests dropped as unreadable */
+	};
+
+	/*!
+	 * Create a publisher on a publish or xpublish socket.
+	 *
+	 * \param socket the socket to publish on, which must outlive the publisher.
+	 * \param history messages kept per topic for replay, zero to keep none.
+	 */
+	sequenced_publisher(socket_t& socket, size_t const& history = 0);
+
+	/*!
+	 * Cleanup the publisher, the history is dropped.
+	 */
+	~sequenced_publisher();
+
+	/*!
+	 * Publish a message on a topic.
+	 *
+	 * \param topic the topic, sent as the first frame so subscriptions match it.
+	 * \param body the message parts to follow the sequence number, emptied.
+	 * \return the sequence number the message was sent with.
+	 */
+	uint64_t send(std::string const& topic, message_t& body);
+
+	/*!
+	 * Publish a single part message on a topic.
+	 *
+	 * \param topic the topic.
+	 * \param body the message content.
+	 * \return the sequence number the message was sent with.
+	 */
+	uint64_t send(std::string const& topic, std::string const& body);
+
+	/*!
+	 * Answer the replay requests waiting on a router socket.
+	 *
+	 * A request is a topic frame followed by the first and last sequence
+	 * wanted, both 8 byte network order. Each message still in the history
+	 * is sent back to the requester in the same form it was published.
+	 *
+	 * \param router the router socket subscribers send requests to.
+	 * \return the number of requests served.
+	 */
+	size_t replay(socket_t& router);
+
+	/*!
+	 * Get the last sequence number sent on a topic.
+	 *
+	 * \param topic the topic to check.
+	 * \return the sequence number, or zero if nothing has been sent.
+	 */
+	uint64_t sequence(std::string const& topic) const;
+
+	/*!
+	 * Get the epoch sent with every message.
+	 *
+	 * \return the epoch, never zero.
+	 */
+	uint64_t epoch() const;
+
+	/*!
+	 * Get the publisher counters.
+	 *
+	 * \return the counters so far.
+	 */
+	statistics stats() const;
+
+private:
+	struct topic_state
+	{
+		uint64_t sequence;
+		std::deque<message_t> history; // the last sent bodies, oldest first
+	};
+
+	socket_t& _socket;
+	uint64_t _epoch;
+	size_t _history;
+	std::unordered_map<std::string, topic_state> _topics;
+	statistics _stats;
+
+	void send_header(socket_t& socket, std::string const& topic, uint64_t const& sequence, bool const& more);
+
+	// No copy - private and not implemented
+	sequenced_publisher(sequenced_publisher const&);
+	sequenced_publisher& operator=(sequenced_publisher const&);
+};
+
+}
+
+#endif /* ZMQPP_SEQUENCED_PUBLISHER_HPP_ */
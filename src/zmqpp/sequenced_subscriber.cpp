@@ -0,0 +1,191 @@
+#include <cstring>
+
+#include "exception.hpp"
+#include "inet.hpp"
+#include "socket.hpp"
+#include "sequenced_subscriber.hpp"
+
+namespace zmqpp
+{
+
+sequenced_subscriber::sequenced_subscriber(socket& socket)
+	: _socket(socket)
+	, _recovery(nullptr)
+	, _gap_handler()
+	, _sequences()
+	, _frame()
+	, _stats()
+{
+	if ((socket_type::subscribe != socket.type()) && (socket_type::xsubscribe != socket.type()))
+	{
+		throw exception("sequenced subscribers require a subscribe or xsubscribe socket");
+	}
+}
+
+sequenced_subscriber::~sequenced_subscriber()
+{
+}
+
+void sequenced_subscriber::set_gap_handler(gap_handler const& handler)
+{
+	_gap_handler = handler;
+}
+
+void sequenced_subscriber::set_recovery(socket* recovery)
+{
+	if ((nullptr != recovery) && (socket_type::dealer != recovery->type()))
+	{
+		throw exception("recovery requests require a dealer socket");
+	}
+
+	_recovery = recovery;
+}
+
+bool sequenced_subscriber::receive(std::string& topic, uint64_t& sequence, message& body, bool const& dont_block /* = false */)
+{
+	uint64_t epoch = 0;
+	while(read(_socket, topic, sequence, epoch, body, dont_block))
+	{
+		// The topic string is only copied the first time it is seen
+		auto it = _sequences.find(topic);
+		if (_sequences.end() == it)
+		{
+			topic_state state = { epoch, sequence };
+			_sequences.insert(std::make_pair(topic, state));
+			++_stats.received;
+			return true;
+		}
+
+		topic_state& state = (*it).second;
+		uint64_t& last = state.sequence;
+
+		// A restarted publisher counts again from one, whatever arrives first
+		if (epoch != state.epoch)
+		{
+			state.epoch = epoch;
+			last = 0;
+			++_stats.resets;
+		}
+
+		if (sequence == last + 1)
+		{
+			last = sequence;
+			++_stats.received;
+			return true;
+		}
+
+		if (sequence <= last)
+		{
+			++_stats.stale;
+			body = message_t();
+			continue;
+		}
+
+		uint64_t first_missing = last + 1;
+		uint64_t last_missing = sequence - 1;
+		last = sequence;
+
+		++_stats.gaps;
+		_stats.missed += last_missing - first_missing + 1;
+		++_stats.received;
+
+		if (nullptr != _recovery)
+		{
+			request(topic, first_missing, last_missing);
+		}
+
+		if (_gap_handler)
+		{
+			_gap_handler(topic, first_missing, last_missing);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+bool sequenced_subscriber::recover(std::string& topic, uint64_t& sequence, message& body, bool const& dont_block /* = false */)
+{
+	if (nullptr == _recovery)
+	{
+		throw exception("no recovery socket has been set");
+	}
+
+	uint64_t epoch = 0;
+	if (!read(*_recovery, topic, sequence, epoch, body, dont_block))
+	{
+		return false;
+	}
+
+	++_stats.recovered;
+	return true;
+}
+
+uint64_t sequenced_subscriber::sequence(std::string const& topic) const
+{
+	auto it = _sequences.find(topic);
+	if (_sequences.end() == it)
+	{
+		return 0;
+	}
+
+	return (*it).second.sequence;
+}
+
+sequenced_subscriber::statistics sequenced_subscriber::stats() const
+{
+	return _stats;
+}
+
+bool sequenced_subscriber::read(socket& socket, std::string& topic, uint64_t& sequence, uint64_t& epoch, message& body, bool const& dont_block)
+{
+	while(socket.receive(topic, (dont_block) ? socket::DONT_WAIT : socket::NORMAL))
+	{
+		bool valid = socket.has_more_parts();
+		if (valid)
+		{
+			socket.receive(_frame);
+			valid = (2 * sizeof(uint64_t) == _frame.size());
+		}
+
+		if (!valid)
+		{
+			++_stats.malformed;
+			while(socket.has_more_parts())
+			{
+				socket.receive(_frame);
+			}
+			continue;
+		}
+
+		uint64_t network[2];
+		std::memcpy(network, _frame.data(), sizeof(network));
+		sequence = ntohll(network[0]);
+		epoch = ntohll(network[1]);
+
+		if (socket.has_more_parts())
+		{
+			socket.receive(body);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+void sequenced_subscriber::request(std::string const& topic, uint64_t const& first, uint64_t const& last)
+{
+	uint64_t range[2] = { htonll(first), htonll(last) };
+
+	// Never hold up the subscriber, a request that cannot go now is just lost
+	if (_recovery->send(topic, socket::SEND_MORE | socket::DONT_WAIT))
+	{
+		_recovery->send_raw(reinterpret_cast<char const*>(&range[0]), sizeof(uint64_t), socket::SEND_MORE);
+		_recovery->send_raw(reinterpret_cast<char const*>(&range[1]), sizeof(uint64_t));
+		++_stats.requests;
+	}
+}
+
+}
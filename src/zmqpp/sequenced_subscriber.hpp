@@ -0,0 +1,157 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_SEQUENCED_SUBSCRIBER_HPP_
+#define ZMQPP_SEQUENCED_SUBSCRIBER_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Subscriber that checks the sequence numbers of a sequenced_publisher.
+ *
+ * Each topic's sequence is expected to go up by one with every message.
+ * When it jumps the messages in between were lost, the gap is counted and
+ * passed to the gap handler if one is set. The first message seen on a
+ * topic only sets where counting starts, as the publisher may have been
+ * running long before the subscriber joined.
+ *
+ * A change of epoch means the publisher restarted, the topic is reset and
+ * counted from zero so anything before the first message of the new epoch
+ * is reported as a gap.
+ *
+ * With a recovery socket set, a dealer connected to the router the
+ * publisher replays from, a request for each gap is sent on it and the
+ * resent messages are read back with recover. Recovered messages do not
+ * change the expected sequence and anything the publisher no longer had
+ * stays lost.
+ *
+ * The fast path costs one lookup of the topic and no allocation once the
+ * topic string has been seen.
+ */
+class sequenced_subscriber
+{
+public:
+	/*!
+	 * Function called with each gap, the topic then the first and last missing sequence.
+	 */
+	typedef std::function<void (std::string const&, uint64_t const&, uint64_t const&)> gap_handler;
+
+	/*!
+	 * Counters for the subscriber.
+	 */
+	struct statistics
+	{
+		uint64_t received;   /*!< messages received in or ahead of sequence */
+		uint64_t gaps;       /*!< jumps in sequence detected */
+		uint64_t missed;     /*!< messages lost in those gaps */
+		uint64_t stale;      /*!< messages at or behind the expected sequence, dropped */
+		uint64_t resets;     /*!< topics restarted by a new publisher epoch */
+		uint64_t requests;   /*!< replay requests sent */
+		uint64_t recovered;  /*!< messages read back through recover */
+		uint64_t malformed;  /*!< messages without a valid sequence frame, dropped */
+	};
+
+	/*!
+	 * Create a subscriber on a subscribe or xsubscribe socket.
+	 *
+	 * \param socket the socket to receive on, which must outlive the subscriber.
+	 */
+	sequenced_subscriber(socket_t& socket);
+
+	/*!
+	 * Cleanup the subscriber.
+	 */
+	~sequenced_subscriber();
+
+	/*!
+	 * Call a function with each gap found.
+	 *
+	 * \param handler function to call, or an empty function to stop.
+	 */
+	void set_gap_handler(gap_handler const& handler);
+
+	/*!
+	 * Ask for missing messages on a dealer socket.
+	 *
+	 * \param recovery the dealer to send requests on, or nullptr to stop.
+	 */
+	void set_recovery(socket_t* recovery);
+
+	/*!
+	 * Receive the next message in sequence.
+	 *
+	 * Stale and malformed messages are dropped and the next one tried.
+	 *
+	 * \param topic set to the message topic.
+	 * \param sequence set to the message sequence number.
+	 * \param body the message to fill with the body parts, must be empty.
+	 * \param dont_block true to return false instead of waiting for a message.
+	 * \return true if a message was received.
+	 */
+	bool receive(std::string& topic, uint64_t& sequence, message_t& body, bool const& dont_block = false);
+
+	/*!
+	 * Receive a message resent for a replay request.
+	 *
+	 * \param topic set to the message topic.
+	 * \param sequence set to the message sequence number.
+	 * \param body the message to fill with the body parts, must be empty.
+	 * \param dont_block true to return false instead of waiting for a message.
+	 * \return true if a message was received.
+	 */
+	bool recover(std::string& topic, uint64_t& sequence, message_t& body, bool const& dont_block = false);
+
+	/*!
+	 * Get the last sequence number received on a topic.
+	 *
+	 * \param topic the topic to check.
+	 * \return the sequence number, or zero if nothing has been received.
+	 */
+	uint64_t sequence(std::string const& topic) const;
+
+	/*!
+	 * Get the subscriber counters.
+	 *
+	 * \return the counters so far.
+	 */
+	statistics stats() const;
+
+private:
+	socket_t& _socket;
+	socket_t* _recovery;
+	struct topic_state
+	{
+		uint64_t epoch;
+		uint64_t sequence;
+	};
+
+	gap_handler _gap_handler;
+	std::unordered_map<std::string, topic_state> _sequences;
+	std::string _frame;
+	statistics _stats;
+
+	bool read(socket_t& socket, std::string& topic, uint64_t& sequence, uint64_t& epoch, message_t& body, bool const& dont_block);
+	void request(std::string const& topic, uint64_t const& first, uint64_t const& last);
+
+	// No copy - private and not implemented
+	sequenced_subscriber(sequenced_subscriber const&);
+	sequenced_subscriber& operator=(sequenced_subscriber const&);
+};
+
+}
+
+#endif /* ZMQPP_SEQUENCED_SUBSCRIBER_HPP_ */
@@ -0,0 +1,612 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "exception.hpp"
+#include "shm_channel.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+// How many times a full ring is retried before the sender starts yielding, then sleeping
+const int spin_attempts = 64;
+const int yield_attempts = 64;
+const std::chrono::microseconds full_sleep(50);
+
+// Written last by the receiver so a sender never uses a half built segment
+const uint64_t ready_magic = 0x7a6d717070736d31ULL;
+
+// Records are a length and part count followed by each part as a size and
+// its data, everything padded to 8 bytes. A zero length marks the rest of
+// the ring as unused, the next record starts back at the beginning.
+const size_t record_header = 8;
+const size_t part_header = 8;
+
+std::string segment_name(std::string const& name)
+{
+	return "/zmqpp-" + name;
+}
+
+size_t padded(size_t const& size)
+{
+	return (size + 7) & ~static_cast<size_t>(7);
+}
+
+}
+
+struct shm_channel::header
+{
+	std::atomic<uint64_t> magic;
+	uint64_t capacity;
+	char pad_front[48];
+	std::atomic<uint64_t> head; // next byte the sender writes
+	char pad_sender[56];
+	std::atomic<uint64_t> tail; // next byte the receiver reads
+	char pad_receiver[56];
+	std::atomic<uint32_t> parked;
+	char pad_back[60];
+	char wakeup[256]; // path of the fifo, in a directory only the owner can enter
+};
+
+shm_channel::shm_channel(std::string const& name, role const& end, size_t const& capacity /* = 1 << 20 */)
+	: _name(name)
+	, _role(end)
+	, _header(nullptr)
+	, _ring(nullptr)
+	, _mapped(0)
+	, _mask(0)
+	, _wakeup(-1)
+	, _created(false)
+	, _position(0)
+	, _cached(0)
+	, _pending(0)
+	, _armed(false)
+	, _owed(false)
+{
+	if (name.empty() || (std::string::npos != name.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_")))
+	{
+		throw exception("shared memory channel names must be letters, digits, dash or underscore");
+	}
+
+	try
+	{
+		if (role::receiver == end)
+		{
+			create(capacity);
+		}
+		else
+		{
+			open();
+		}
+	}
+	catch(...)
+	{
+		cleanup();
+		throw;
+	}
+}
+
+shm_channel::~shm_channel()
+{
+	cleanup();
+}
+
+bool shm_channel::send(message& message, bool const& dont_block /* = false */)
+{
+	if (role::sender != _role)
+	{
+		throw exception("only the sending end of a shared memory channel can send");
+	}
+
+	if (message.parts() == 0)
+	{
+		throw std::invalid_argument("sending requires messages have at least one part");
+	}
+
+	size_t size = record_header;
+	for(size_t i = 0; i < message.parts(); ++i)
+	{
+		size += part_header + padded(message.size(i));
+	}
+
+	char* record = reserve(size, dont_block);
+	if (nullptr == record)
+	{
+		return false;
+	}
+
+	uint32_t* fields = reinterpret_cast<uint32_t*>(record);
+	fields[0] = static_cast<uint32_t>(size);
+	fields[1] = static_cast<uint32_t>(message.parts());
+
+	char* part = record + record_header;
+	for(size_t i = 0; i < message.parts(); ++i)
+	{
+		uint64_t part_size = message.size(i);
+		std::memcpy(part, &part_size, sizeof(part_size));
+		std::memcpy(part + part_header, message.raw_data(i), part_size);
+		part += part_header + padded(part_size);
+	}
+
+	publish();
+
+	message = message_t();
+	return true;
+}
+
+bool shm_channel::send(std::string const& string, bool const& dont_block /* = false */)
+{
+	void* part = claim(string.size(), dont_block);
+	if (nullptr == part)
+	{
+		return false;
+	}
+
+	std::memcpy(part, string.data(), string.size());
+	commit();
+
+	return true;
+}
+
+void* shm_channel::claim(size_t const& size, bool const& dont_block /* = false */)
+{
+	if (role::sender != _role)
+	{
+		throw exception("only the sending end of a shared memory channel can send");
+	}
+
+	size_t total = record_header + part_header + padded(size);
+	char* record = reserve(total, dont_block);
+	if (nullptr == record)
+	{
+		return nullptr;
+	}
+
+	uint32_t* fields = reinterpret_cast<uint32_t*>(record);
+	fields[0] = static_cast<uint32_t>(total);
+	fields[1] = 1;
+
+	uint64_t part_size = size;
+	std::memcpy(record + record_header, &part_size, sizeof(part_size));
+
+	return record + record_header + part_header;
+}
+
+void shm_channel::commit()
+{
+	if (0 == _pending)
+	{
+		throw exception("nothing has been claimed to commit");
+	}
+
+	publish();
+}
+
+bool shm_channel::receive(message& message, bool const& dont_block /* = false */)
+{
+	if (message.parts() > 0)
+	{
+		throw exception("receiving can only be done to empty messages");
+	}
+
+	uint32_t const* fields = next(dont_block);
+	if (nullptr == fields)
+	{
+		return false;
+	}
+
+	char const* part = reinterpret_cast<char const*>(fields) + record_header;
+	for(uint32_t i = 0; i < fields[1]; ++i)
+	{
+		uint64_t part_size = 0;
+		std::memcpy(&part_size, part, sizeof(part_size));
+		message.add(part + part_header, part_size);
+		part += part_header + padded(part_size);
+	}
+
+	_pending = fields[0];
+	release();
+
+	return true;
+}
+
+bool shm_channel::receive(std::string& string, bool const& dont_block /* = false */)
+{
+	void const* data = nullptr;
+	size_t size = 0;
+	if (!peek(data, size, dont_block))
+	{
+		return false;
+	}
+
+	string.assign(static_cast<char const*>(data), size);
+	release();
+
+	return true;
+}
+
+bool shm_channel::peek(void const*& data, size_t& size, bool const& dont_block /* = false */)
+{
+	uint32_t const* fields = next(dont_block);
+	if (nullptr == fields)
+	{
+		return false;
+	}
+
+	char const* part = reinterpret_cast<char const*>(fields) + record_header;
+
+	uint64_t part_size = 0;
+	std::memcpy(&part_size, part, sizeof(part_size));
+
+	data = part + part_header;
+	size = part_size;
+	_pending = fields[0];
+
+	return true;
+}
+
+void shm_channel::release()
+{
+	if (0 == _pending)
+	{
+		throw exception("nothing has been peeked at to release");
+	}
+
+	_position += _pending;
+	_pending = 0;
+	_header->tail.store(_position, std::memory_order_release);
+}
+
+int shm_channel::file_descriptor() const
+{
+	return _wakeup;
+}
+
+size_t shm_channel::capacity() const
+{
+	return _mask + 1;
+}
+
+size_t shm_channel::max_message_size() const
+{
+	// Half the ring always has room contiguously once it has drained, wherever the wrap falls
+	return (_mask + 1) / 2;
+}
+
+void shm_channel::remove(std::string const& name)
+{
+	std::string segment = segment_name(name);
+
+	int descriptor = shm_open(segment.c_str(), O_RDWR, 0);
+	if (descriptor < 0)
+	{
+		return;
+	}
+
+	// Only a finished segment says where its fifo is
+	struct stat status;
+	if ((0 == fstat(descriptor, &status)) && (static_cast<size_t>(status.st_size) >= sizeof(header)))
+	{
+		void* memory = mmap(nullptr, sizeof(header), PROT_READ, MAP_SHARED, descriptor, 0);
+		if (MAP_FAILED != memory)
+		{
+			header const* stale = static_cast<header const*>(memory);
+			if ((ready_magic == stale->magic.load(std::memory_order_acquire)) && (nullptr != std::memchr(stale->wakeup, 0, sizeof(stale->wakeup))))
+			{
+				std::string fifo(stale->wakeup);
+				unlink(fifo.c_str());
+				rmdir(fifo.substr(0, fifo.rfind('/')).c_str());
+			}
+			munmap(memory, sizeof(header));
+		}
+	}
+
+	close(descriptor);
+	shm_unlink(segment.c_str());
+}
+
+void shm_channel::create(size_t const& capacity)
+{
+	size_t size = 4096;
+	while(size < capacity)
+	{
+		size <<= 1;
+	}
+
+	// Exclusive so a second receiver can never take over a live channel
+	int descriptor = shm_open(segment_name(_name).c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (descriptor < 0)
+	{
+		if (EEXIST == errno)
+		{
+			throw exception("shared memory channel name is already in use");
+		}
+		throw zmq_internal_exception();
+	}
+	_created = true;
+
+	_mapped = sizeof(header) + size;
+	if (0 != ftruncate(descriptor, _mapped))
+	{
+		close(descriptor);
+		throw zmq_internal_exception();
+	}
+
+	void* memory = mmap(nullptr, _mapped, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (MAP_FAILED == memory)
+	{
+		throw zmq_internal_exception();
+	}
+
+	// A fresh segment is zero filled which is all the indexes and flag need
+	_header = static_cast<header*>(memory);
+	_ring = static_cast<char*>(memory) + sizeof(header);
+	_mask = size - 1;
+
+	// The fifo goes in a fresh private directory, nobody else can have
+	// created or replaced it and its path cannot be guessed
+	char const* runtime = std::getenv("XDG_RUNTIME_DIR");
+	std::string directory = ((nullptr != runtime) && ('\0' != runtime[0])) ? runtime : "/tmp";
+	directory += "/zmqpp-" + _name + "-XXXXXX";
+	if (nullptr == mkdtemp(&directory[0]))
+	{
+		throw zmq_internal_exception();
+	}
+	_directory = directory;
+
+	std::string fifo = directory + "/wakeup";
+	if (fifo.size() >= sizeof(_header->wakeup))
+	{
+		throw exception("shared memory channel wake up path is too long");
+	}
+
+	if (0 != mkfifo(fifo.c_str(), S_IRUSR | S_IWUSR))
+	{
+		throw zmq_internal_exception();
+	}
+
+	// Read write so neither end needs the other to have opened it first
+	_wakeup = ::open(fifo.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (_wakeup < 0)
+	{
+		throw zmq_internal_exception();
+	}
+
+	std::memcpy(_header->wakeup, fifo.c_str(), fifo.size() + 1);
+	_header->capacity = size;
+	_header->magic.store(ready_magic, std::memory_order_release);
+}
+
+void shm_channel::open()
+{
+	int descriptor = shm_open(segment_name(_name).c_str(), O_RDWR, 0);
+	if (descriptor < 0)
+	{
+		throw zmq_internal_exception();
+	}
+
+	struct stat status;
+	if (0 != fstat(descriptor, &status))
+	{
+		close(descriptor);
+		throw zmq_internal_exception();
+	}
+
+	if (static_cast<size_t>(status.st_size) <= sizeof(header))
+	{
+		close(descriptor);
+		throw exception("shared memory channel is not ready");
+	}
+
+	_mapped = status.st_size;
+	void* memory = mmap(nullptr, _mapped, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (MAP_FAILED == memory)
+	{
+		throw zmq_internal_exception();
+	}
+
+	_header = static_cast<header*>(memory);
+	if ((ready_magic != _header->magic.load(std::memory_order_acquire)) || (sizeof(header) + _header->capacity != _mapped)
+		|| (nullptr == std::memchr(_header->wakeup, 0, sizeof(_header->wakeup))))
+	{
+		throw exception("shared memory channel is not ready");
+	}
+
+	_ring = static_cast<char*>(memory) + sizeof(header);
+	_mask = _header->capacity - 1;
+	_position = _header->head.load(std::memory_order_relaxed);
+	_cached = _header->tail.load(std::memory_order_acquire);
+
+	_wakeup = ::open(_header->wakeup, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (_wakeup < 0)
+	{
+		throw zmq_internal_exception();
+	}
+}
+
+void shm_channel::cleanup()
+{
+	if (nullptr != _header)
+	{
+		munmap(_header, _mapped);
+		_header = nullptr;
+	}
+
+	if (_wakeup >= 0)
+	{
+		close(_wakeup);
+		_wakeup = -1;
+	}
+
+	// Only what this receiver created, a name already in use is left alone
+	if (!_directory.empty())
+	{
+		unlink((_directory + "/wakeup").c_str());
+		rmdir(_directory.c_str());
+		_directory.clear();
+	}
+
+	if (_created)
+	{
+		shm_unlink(segment_name(_name).c_str());
+		_created = false;
+	}
+}
+
+char* shm_channel::reserve(size_t const& size, bool const& dont_block)
+{
+	// Record lengths are stored in 32 bits, which also bounds the part count
+	if ((size > max_message_size()) || (size > std::numeric_limits<uint32_t>::max()))
+	{
+		throw exception("message is too large for the shared memory channel");
+	}
+
+	size_t capacity = _mask + 1;
+	size_t offset = _position & _mask;
+	size_t contiguous = capacity - offset;
+
+	// A record that would run off the end skips the rest of the ring
+	size_t needed = (contiguous < size) ? contiguous + size : size;
+
+	for(int attempt = 0; capacity - (_position - _cached) < needed; ++attempt)
+	{
+		_cached = _header->tail.load(std::memory_order_acquire);
+		if (capacity - (_position - _cached) >= needed)
+		{
+			break;
+		}
+
+		if (dont_block)
+		{
+			return nullptr;
+		}
+
+		if (attempt < spin_attempts)
+		{
+			continue;
+		}
+
+		if (attempt < spin_attempts + yield_attempts)
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			std::this_thread::sleep_for(full_sleep);
+		}
+	}
+
+	if (contiguous < size)
+	{
+		*reinterpret_cast<uint32_t*>(_ring + offset) = 0;
+		_position += contiguous;
+		offset = 0;
+	}
+
+	_pending = size;
+	return _ring + offset;
+}
+
+void shm_channel::publish()
+{
+	_position += _pending;
+	_pending = 0;
+	_header->head.store(_position);
+
+	// Only a parked receiver needs a system call to wake it
+	if (_header->parked.load() && _header->parked.exchange(0))
+	{
+		char byte = 0;
+		while((write(_wakeup, &byte, 1) < 0) && (EINTR == errno)) { }
+	}
+}
+
+uint32_t const* shm_channel::next(bool const& dont_block)
+{
+	if (role::receiver != _role)
+	{
+		throw exception("only the receiving end of a shared memory channel can receive");
+	}
+
+	while(true)
+	{
+		if (_position == _cached)
+		{
+			_cached = _header->head.load();
+		}
+
+		if (_position == _cached)
+		{
+			// Park before the last look so the sender either sees us parked or we see its record
+			park();
+
+			_cached = _header->head.load();
+			if (_position == _cached)
+			{
+				if (dont_block)
+				{
+					return nullptr;
+				}
+
+				wait();
+				continue;
+			}
+		}
+
+		size_t offset = _position & _mask;
+		uint32_t const* fields = reinterpret_cast<uint32_t const*>(_ring + offset);
+		if (0 != fields[0])
+		{
+			return fields;
+		}
+
+		_position += (_mask + 1) - offset;
+	}
+}
+
+void shm_channel::park()
+{
+	// The sender cleared our last park so it has written, or is about to write, a wake up
+	if (_armed && (0 == _header->parked.load()))
+	{
+		_owed = true;
+	}
+
+	// Keep trying on later parks if the wake up had not arrived yet
+	if (_owed)
+	{
+		char byte = 0;
+		_owed = (read(_wakeup, &byte, 1) <= 0);
+	}
+
+	_header->parked.store(1);
+	_armed = true;
+}
+
+void shm_channel::wait()
+{
+	pollfd item;
+	item.fd = _wakeup;
+	item.events = POLLIN;
+	item.revents = 0;
+
+	while((::poll(&item, 1, -1) < 0) && (EINTR == errno)) { }
+}
+
+}
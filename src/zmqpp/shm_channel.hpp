@@ -0,0 +1,217 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_SHM_CHANNEL_HPP_
+#define ZMQPP_SHM_CHANNEL_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+
+namespace zmqpp
+{
+
+typedef message message_t;
+
+/*!
+ * Single producer, single consumer message channel between two processes on
+ * the same host.
+ *
+ * Messages are written into a ring buffer held in a POSIX shared memory
+ * segment, so a message costs one copy into the ring on send and one copy
+ * out on receive rather than the several copies and system calls of an ipc
+ * socket. Either copy can be avoided; the sender can build a single part
+ * message directly in the ring with claim and commit, and the receiver can
+ * read the first part in place with peek and release.
+ *
+ * The receiver owns the segment, it is created when the receiver is
+ * constructed and removed when the receiver is destroyed. Constructing a
+ * receiver fails if the name is already in use, a segment left behind by a
+ * receiver that did not clean up can be removed with remove. The sender
+ * must be constructed after the receiver.
+ *
+ * As with channel the receiver is only woken when it has parked, which it
+ * does whenever a receive finds the ring empty. The wake up goes through a
+ * fifo in a private directory, under XDG_RUNTIME_DIR if set or /tmp, whose
+ * path is kept in the segment. Its descriptor can be added to a poller or
+ * reactor. Once it reports input keep calling receive without blocking
+ * until it returns false.
+ *
+ * Exactly one process, and one thread within it, may send and one may
+ * receive at a time.
+ */
+class shm_channel
+{
+public:
+	/*!
+	 * Which end of the channel this object is.
+	 */
+	ZMQPP_COMPARABLE_ENUM role {
+		sender,   /*!< opens an existing segment and writes to it */
+		receiver  /*!< creates the segment and reads from it */
+	};
+
+	/*!
+	 * Create or open a channel by name.
+	 *
+	 * \param name name of the channel, letters, digits, dash and underscore only.
+	 * \param end which end of the channel this is.
+	 * \param capacity ring size in bytes for the receiver, rounded up to a
+	 * power of two; the sender uses whatever size the receiver chose.
+	 */
+	shm_channel(std::string const& name, role const& end, size_t const& capacity = 1 << 20);
+
+	/*!
+	 * Unmap the channel, the receiver also removes the segment and fifo.
+	 */
+	~shm_channel();
+
+	/*!
+	 * Remove a segment and fifo left behind by a receiver that did not
+	 * clean up, so the name can be used again.
+	 *
+	 * Must not be called while the receiver is still running.
+	 *
+	 * \param name name of the channel.
+	 */
+	static void remove(std::string const& name);
+
+	/*!
+	 * Send a message to the receiver, copying each part into the ring.
+	 *
+	 * If the ring is full this waits for room unless dont_block is set.
+	 *
+	 * \param message message to send, emptied on success.
+	 * \param dont_block return rather than wait when the ring is full.
+	 * \return true if sent, false if the ring was full and the message is unchanged.
+	 */
+	bool send(message_t& message, bool const& dont_block = false);
+
+	/*!
+	 * Send a single part message.
+	 *
+	 * \param string the message content.
+	 * \param dont_block return rather than wait when the ring is full.
+	 * \return true if sent, false if the ring was full.
+	 */
+	bool send(std::string const& string, bool const& dont_block = false);
+
+	/*!
+	 * Reserve room in the ring for a single part message of a known size.
+	 *
+	 * The returned memory should be filled in and then handed over with
+	 * commit. Nothing else may be sent in between.
+	 *
+	 * \param size size of the message part in bytes.
+	 * \param dont_block return rather than wait when the ring is full.
+	 * \return where to write the part, or nullptr if the ring was full.
+	 */
+	void* claim(size_t const& size, bool const& dont_block = false);
+
+	/*!
+	 * Hand the message reserved by the last claim over to the receiver.
+	 */
+	void commit();
+
+	/*!
+	 * Receive the next message, copying each part out of the ring.
+	 *
+	 * If the ring is empty this waits for a message unless dont_block is set.
+	 *
+	 * \param message empty message to receive into.
+	 * \param dont_block return rather than wait when the ring is empty.
+	 * \return true if a message was received, false if the ring was empty.
+	 */
+	bool receive(message_t& message, bool const& dont_block = false);
+
+	/*!
+	 * Receive the first part of the next message as a string.
+	 *
+	 * \param string string to receive into.
+	 * \param dont_block return rather than wait when the ring is empty.
+	 * \return true if a message was received, false if the ring was empty.
+	 */
+	bool receive(std::string& string, bool const& dont_block = false);
+
+	/*!
+	 * Look at the first part of the next message where it sits in the ring.
+	 *
+	 * The data stays valid until release is called, which must be done
+	 * before anything else is received.
+	 *
+	 * \param data set to the start of the part.
+	 * \param size set to the size of the part.
+	 * \param dont_block return rather than wait when the ring is empty.
+	 * \return true if a message is waiting, false if the ring was empty.
+	 */
+	bool peek(void const*& data, size_t& size, bool const& dont_block = false);
+
+	/*!
+	 * Drop the message looked at by the last peek, freeing its room.
+	 */
+	void release();
+
+	/*!
+	 * Get the descriptor that becomes readable when a parked receiver has
+	 * messages waiting.
+	 *
+	 * \return file descriptor suitable for poller::add.
+	 */
+	int file_descriptor() const;
+
+	/*!
+	 * Get the size of the ring in bytes.
+	 *
+	 * \return ring capacity.
+	 */
+	size_t capacity() const;
+
+	/*!
+	 * Get the largest message, including framing, that fits in the ring.
+	 *
+	 * Messages over 4 GiB are always refused, however large the ring.
+	 *
+	 * \return largest message size in bytes.
+	 */
+	size_t max_message_size() const;
+
+private:
+	struct header;
+
+	std::string _name;
+	role _role;
+	header* _header;
+	char* _ring;
+	size_t _mapped;
+	size_t _mask;
+	int _wakeup;
+	std::string _directory; // private directory holding our fifo, receiver only
+	bool _created;
+
+	uint64_t _position;   // our own index, head for the sender and tail for the receiver
+	uint64_t _cached;     // last seen index of the other end
+	uint64_t _pending;    // bytes claimed or peeked but not yet committed or released
+
+	bool _armed;
+	bool _owed;
+
+	void create(size_t const& capacity);
+	void open();
+	void cleanup();
+	char* reserve(size_t const& size, bool const& dont_block);
+	void publish();
+	uint32_t const* next(bool const& dont_block);
+	void park();
+	void wait();
+
+	// No copy - private and not implemented
+	shm_channel(shm_channel const&);
+	shm_channel& operator=(shm_channel const&);
+};
+
+}
+
+#endif /* ZMQPP_SHM_CHANNEL_HPP_ */
@@ -120,6 +120,8 @@ bool socket::send(message& other, bool const& dont_block /* = false */)
 			// so we should only ever get this error on the first part
 			if((0 == i) && (EAGAIN == zmq_errno()))
 			{
+				// nothing was sent so hand the message back intact for a retry
+				std::swap(local, other);
 				return false;
 			}
 
@@ -132,6 +134,10 @@ bool socket::send(message& other, bool const& dont_block /* = false */)
 		local.sent(i);
 	}
 
+	// hand back the now empty part storage so the caller can reuse it
+	local.clear();
+	std::swap(local, other);
+
 	return true;
 }
 
@@ -294,6 +300,9 @@ void socket::set(socket_option const& option, int const& value)
 	case socket_option::send_timeout:
 #if (ZMQ_VERSION_MAJOR > 3) or ((ZMQ_VERSION_MAJOR == 3) and (ZMQ_VERSION_MINOR >= 1))
 	case socket_option::ipv4_only:
+#endif
+#ifdef ZMQ_XPUB_VERBOSE
+	case socket_option::xpub_verbose:
 #endif
 		zmq_setsockopt(_socket, static_cast<int>(option), &value, sizeof(value));
 		break;
@@ -305,10 +314,15 @@ void socket::set(socket_option const& option, int const& value)
 #if (ZMQ_VERSION_MAJOR > 3) or ((ZMQ_VERSION_MAJOR == 3) and (ZMQ_VERSION_MINOR >= 1))
 void socket::set(socket_option const& option, bool const& value)
 {
+	int int_value = (value) ? 1 : 0;
+
 	switch(option)
 	{
 	case socket_option::ipv4_only:
-		zmq_setsockopt(_socket, static_cast<int>(option), &value, sizeof(value));
+#ifdef ZMQ_XPUB_VERBOSE
+	case socket_option::xpub_verbose:
+#endif
+		zmq_setsockopt(_socket, static_cast<int>(option), &int_value, sizeof(int_value));
 		break;
 	default:
 		throw exception("attempting to set a non boolean option with a boolean value");
@@ -123,7 +123,7 @@ public:
 	 * Sends the message over the connection, this may be a multipart message.
 	 *
 	 * If dont_block is true and we are unable to add a new message then this
-	 * function will return false.
+	 * function will return false and the message is left unchanged.
 	 *
 	 * \param message message to send
 	 * \param dont_block boolean to dictate if we wait while sending.
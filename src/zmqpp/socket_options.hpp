@@ -44,6 +44,9 @@ enum class socket_option {
 #ifdef ZMQ_EXPERIMENTAL_LABELS
     receive_label           = ZMQ_RCVLABEL,          /*!< Received label part - get only */
 #endif
+#ifdef ZMQ_XPUB_VERBOSE
+    xpub_verbose            = ZMQ_XPUB_VERBOSE,      /*!< Pass on every subscription, not just new topics - set only */
+#endif
 };
 
 }
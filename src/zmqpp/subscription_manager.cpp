@@ -0,0 +1,136 @@
+#include "exception.hpp"
+#include "socket.hpp"
+#include "subscription_manager.hpp"
+
+namespace zmqpp
+{
+
+subscription_manager::subscription_manager(socket& socket)
+	: _socket(socket)
+	, _raw(socket_type::xsubscribe == socket.type())
+	, _references()
+	, _pending()
+	, _frame()
+	, _stats()
+{
+	if (!_raw && (socket_type::subscribe != socket.type()))
+	{
+		throw exception("subscriptions can only be managed for subscribe or xsubscribe sockets");
+	}
+}
+
+subscription_manager::~subscription_manager()
+{
+}
+
+void subscription_manager::add(std::string const& topic)
+{
+	size_t& references = _references[topic];
+	if (++references > 1)
+	{
+		++_stats.coalesced;
+		return;
+	}
+
+	// An unsubscribe still waiting for a flush just cancels out
+	auto it = _pending.find(topic);
+	if (_pending.end() != it)
+	{
+		_pending.erase(it);
+		++_stats.coalesced;
+		return;
+	}
+
+	_pending[topic] = true;
+}
+
+void subscription_manager::remove(std::string const& topic)
+{
+	auto reference = _references.find(topic);
+	if (_references.end() == reference)
+	{
+		return;
+	}
+
+	if (--(*reference).second > 0)
+	{
+		++_stats.coalesced;
+		return;
+	}
+
+	_references.erase(reference);
+
+	auto it = _pending.find(topic);
+	if (_pending.end() != it)
+	{
+		_pending.erase(it);
+		++_stats.coalesced;
+		return;
+	}
+
+	_pending[topic] = false;
+}
+
+size_t subscription_manager::flush()
+{
+	if (_pending.empty())
+	{
+		return 0;
+	}
+
+	size_t applied = 0;
+	for(auto it = _pending.begin(); it != _pending.end(); ++it)
+	{
+		apply((*it).first, (*it).second);
+		++applied;
+	}
+
+	_pending.clear();
+
+	++_stats.flushes;
+	_stats.updates += applied;
+
+	return applied;
+}
+
+size_t subscription_manager::resubscribe()
+{
+	// The socket replays what it has already been sent on reconnect
+	return flush();
+}
+
+bool subscription_manager::subscribed(std::string const& topic) const
+{
+	return _references.end() != _references.find(topic);
+}
+
+size_t subscription_manager::topics() const
+{
+	return _references.size();
+}
+
+size_t subscription_manager::pending() const
+{
+	return _pending.size();
+}
+
+subscription_manager::statistics subscription_manager::stats() const
+{
+	return _stats;
+}
+
+void subscription_manager::apply(std::string const& topic, bool const& subscribe)
+{
+	if (!_raw)
+	{
+		_socket.set(subscribe ? socket_option::subscribe : socket_option::unsubscribe, topic);
+		return;
+	}
+
+	// The frame buffer is reused so a large flush does not allocate per topic
+	_frame.assign(1, subscribe ? '\1' : '\0');
+	_frame.append(topic);
+	_socket.send(_frame);
+}
+
+}
@@ -0,0 +1,170 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_SUBSCRIPTION_MANAGER_HPP_
+#define ZMQPP_SUBSCRIPTION_MANAGER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "compatibility.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+
+/*!
+ * Reference counted subscriptions applied to a socket in bulk.
+ *
+ * Topics can be added and removed any number of times, the manager counts
+ * references and only stages a change when a topic's count moves between
+ * zero and one. Changes that cancel each other out before the next flush
+ * never reach the socket at all.
+ *
+ * For subscribe sockets a flush sets the subscribe or unsubscribe option
+ * once per changed topic. For xsubscribe sockets the subscription messages
+ * are sent directly, one after the other without waiting, so libzmq passes
+ * them upstream together. Both socket types remember their subscriptions
+ * and send them again when they reconnect, so nothing needs to be resent
+ * after the upstream publisher restarts.
+ */
+class subscription_manager
+{
+public:
+	/*!
+	 * Counters for the manager.
+	 */
+	struct statistics
+	{
+		uint64_t flushes;   /*!< flushes that had changes to apply */
+		uint64_t updates;   /*!< subscribe or unsubscribe operations applied to the socket */
+		uint64_t coalesced; /*!< calls absorbed by reference counts or cancelled before a flush */
+	};
+
+	/*!
+	 * Manage the subscriptions of a subscribe or xsubscribe socket.
+	 *
+	 * \param socket the socket, which must outlive the manager.
+	 */
+	subscription_manager(socket_t& socket);
+
+	/*!
+	 * Cleanup the manager, unflushed changes are discarded.
+	 */
+	~subscription_manager();
+
+	/*!
+	 * Add a reference to a topic.
+	 *
+	 * \param topic the topic to subscribe to.
+	 */
+	void add(std::string const& topic);
+
+	/*!
+	 * Add a reference to each topic in a range.
+	 *
+	 * \param topics_begin the starting iterator for topics.
+	 * \param topics_end the final iterator for topics.
+	 */
+	template<typename InputIterator>
+	void add(InputIterator const& topics_begin, InputIterator const& topics_end)
+	{
+		for(InputIterator it = topics_begin; it != topics_end; ++it)
+		{
+			add(*it);
+		}
+	}
+
+	/*!
+	 * Remove a reference to a topic.
+	 *
+	 * Removing a topic that has no references is ignored.
+	 *
+	 * \param topic the topic to unsubscribe from.
+	 */
+	void remove(std::string const& topic);
+
+	/*!
+	 * Remove a reference to each topic in a range.
+	 *
+	 * \param topics_begin the starting iterator for topics.
+	 * \param topics_end the final iterator for topics.
+	 */
+	template<typename InputIterator>
+	void remove(InputIterator const& topics_begin, InputIterator const& topics_end)
+	{
+		for(InputIterator it = topics_begin; it != topics_end; ++it)
+		{
+			remove(*it);
+		}
+	}
+
+	/*!
+	 * Apply all staged changes to the socket.
+	 *
+	 * \return the number of subscribe or unsubscribe operations applied.
+	 */
+	size_t flush();
+
+	/*!
+	 * Bring the socket up to date after the upstream publisher restarted.
+	 *
+	 * Subscribe and xsubscribe sockets both replay their subscriptions on
+	 * reconnect, sending them again would subscribe twice, so this only
+	 * flushes any staged changes.
+	 *
+	 * \return the number of subscribe or unsubscribe operations applied.
+	 */
+	size_t resubscribe();
+
+	/*!
+	 * Check if a topic has any references.
+	 *
+	 * \param topic the topic to look for.
+	 * \return true if the topic is, or will be after the next flush, subscribed.
+	 */
+	bool subscribed(std::string const& topic) const;
+
+	/*!
+	 * Get the number of distinct topics with references.
+	 *
+	 * \return topic count.
+	 */
+	size_t topics() const;
+
+	/*!
+	 * Get the number of changes waiting for a flush.
+	 *
+	 * \return staged change count.
+	 */
+	size_t pending() const;
+
+	/*!
+	 * Get the manager counters.
+	 *
+	 * \return the counters so far.
+	 */
+	statistics stats() const;
+
+private:
+	socket_t& _socket;
+	bool _raw;
+	std::unordered_map<std::string, size_t> _references;
+	std::unordered_map<std::string, bool> _pending; // true to subscribe, false to unsubscribe
+	std::string _frame;
+	statistics _stats;
+
+	void apply(std::string const& topic, bool const& subscribe);
+
+	// No copy - private and not implemented
+	subscription_manager(subscription_manager const&);
+	subscription_manager& operator=(subscription_manager const&);
+};
+
+}
+
+#endif /* ZMQPP_SUBSCRIPTION_MANAGER_HPP_ */
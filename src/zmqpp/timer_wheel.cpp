@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <limits>
+
+#include "timer_wheel.hpp"
+
+namespace zmqpp
+{
+
+const size_t timer_wheel::levels;
+const size_t timer_wheel::level_bits;
+const size_t timer_wheel::slots;
+const size_t timer_wheel::none;
+const size_t timer_wheel::firing;
+
+timer_wheel::timer_wheel(clock_type::time_point const& start /* = clock_type::now() */)
+	: _start(start)
+	, _now(0)
+	, _target(0)
+	, _running(none)
+	, _count(0)
+	, _heads(levels * slots + 1, none)
+	, _entries()
+	, _free()
+{
+	for(size_t level = 0; level < levels; ++level)
+	{
+		_occupied[level] = 0;
+	}
+}
+
+timer_wheel::~timer_wheel()
+{
+	_entries.clear();
+	_heads.clear();
+	_free.clear();
+}
+
+timer_wheel::timer_id timer_wheel::add(long const& milliseconds, callback const& callable, clock_type::time_point const& now /* = clock_type::now() */)
+{
+	return schedule(milliseconds, callable, false, now);
+}
+
+timer_wheel::timer_id timer_wheel::add_repeating(long const& milliseconds, callback const& callable, clock_type::time_point const& now /* = clock_type::now() */)
+{
+	return schedule(std::max(milliseconds, 1L), callable, true, now);
+}
+
+bool timer_wheel::cancel(timer_id const& id)
+{
+	if (!id.valid() || (id._index >= _entries.size()))
+	{
+		return false;
+	}
+
+	entry& timer = _entries[id._index];
+	if (!timer.active || (timer.generation != id._generation))
+	{
+		return false;
+	}
+
+	// The running callback is still on the stack, it is released once it returns
+	if (id._index == _running)
+	{
+		timer.active = false;
+		return true;
+	}
+
+	unlink(id._index);
+	release(id._index);
+	return true;
+}
+
+size_t timer_wheel::size() const
+{
+	return _count;
+}
+
+long timer_wheel::next_timeout(clock_type::time_point const& now /* = clock_type::now() */) const
+{
+	uint64_t due = std::numeric_limits<uint64_t>::max();
+
+	for(size_t level = 0; level < levels; ++level)
+	{
+		if (0 == _occupied[level])
+		{
+			continue;
+		}
+
+		// Find the first occupied slot after the current one, wrapping around
+		uint64_t block = _now >> (level_bits * level);
+		size_t position = (block + 1) & (slots - 1);
+		uint64_t rotated = _occupied[level];
+		if (0 != position)
+		{
+			rotated = (rotated >> position) | (rotated << (slots - position));
+		}
+
+		uint64_t offset = __builtin_ctzll(rotated);
+		due = std::min(due, (block + 1 + offset) << (level_bits * level));
+	}
+
+	if (std::numeric_limits<uint64_t>::max() == due)
+	{
+		return -1;
+	}
+
+	uint64_t elapsed = elapsed_microseconds(now);
+	if (due * 1000 <= elapsed)
+	{
+		return 0;
+	}
+
+	return static_cast<long>((due * 1000 - elapsed + 999) / 1000);
+}
+
+size_t timer_wheel::expire(clock_type::time_point const& now /* = clock_type::now() */)
+{
+	uint64_t target = elapsed_microseconds(now) / 1000;
+	if (0 == _count)
+	{
+		_now = std::max(_now, target);
+		return 0;
+	}
+
+	size_t fired = 0;
+	_target = target;
+
+	while(_now < target)
+	{
+		// Nothing due in the first level so skip to the next point something may cascade down
+		if (0 == _occupied[0])
+		{
+			uint64_t skip = _now | (slots - 1);
+			if (skip >= target)
+			{
+				_now = target;
+				break;
+			}
+
+			_now = skip;
+		}
+
+		++_now;
+
+		if (0 == (_now & (slots - 1)))
+		{
+			size_t level = 1;
+			while((level < levels - 1) && (0 == ((_now >> (level_bits * level)) & (slots - 1))))
+			{
+				++level;
+			}
+
+			// Higher levels first so their timers land in the correct lower slots
+			for(; level > 0; --level)
+			{
+				cascade(level);
+			}
+		}
+
+		fired += fire(_now & (slots - 1));
+	}
+
+	return fired;
+}
+
+timer_wheel::timer_id timer_wheel::schedule(long const& milliseconds, callback const& callable, bool const& repeat, clock_type::time_point const& now)
+{
+	size_t index = _entries.size();
+	if (!_free.empty())
+	{
+		index = _free.back();
+		_free.pop_back();
+	}
+	else
+	{
+		_entries.push_back(entry());
+	}
+
+	uint64_t delay = static_cast<uint64_t>(std::max(milliseconds, 0L));
+
+	entry& timer = _entries[index];
+	timer.callable = callable;
+	timer.interval = (repeat) ? delay : 0;
+	timer.previous = none;
+	timer.next = none;
+	timer.list = none;
+	timer.active = true;
+
+	// Round the current time up so a timer never fires early
+	timer.expires = std::max((elapsed_microseconds(now) + 999) / 1000 + delay, _now + 1);
+
+	place(index);
+	++_count;
+
+	return timer_id(index, timer.generation);
+}
+
+uint64_t timer_wheel::elapsed_microseconds(clock_type::time_point const& now) const
+{
+	if (now <= _start)
+	{
+		return 0;
+	}
+
+	return std::chrono::duration_cast<std::chrono::microseconds>(now - _start).count();
+}
+
+void timer_wheel::place(size_t const& index)
+{
+	uint64_t expires = _entries[index].expires;
+	uint64_t delta = expires - _now;
+
+	size_t level = 0;
+	while((level < levels - 1) && (delta >= (static_cast<uint64_t>(1) << (level_bits * (level + 1)))))
+	{
+		++level;
+	}
+
+	// Beyond the range of the wheel, park it in the furthest top level slot and place it again from there
+	if (delta >= (static_cast<uint64_t>(1) << (level_bits * levels)))
+	{
+		expires = _now + ((slots - 1) << (level_bits * level));
+	}
+
+	size_t slot = (expires >> (level_bits * level)) & (slots - 1);
+	link(index, level * slots + slot);
+}
+
+void timer_wheel::link(size_t const& index, size_t const& list)
+{
+	entry& timer = _entries[index];
+	timer.list = list;
+	timer.previous = none;
+	timer.next = _heads[list];
+
+	if (none != timer.next)
+	{
+		_entries[timer.next].previous = index;
+	}
+
+	_heads[list] = index;
+
+	if (list < firing)
+	{
+		_occupied[list / slots] |= static_cast<uint64_t>(1) << (list % slots);
+	}
+}
+
+void timer_wheel::unlink(size_t const& index)
+{
+	entry& timer = _entries[index];
+	size_t list = timer.list;
+	if (none == list)
+	{
+		return;
+	}
+
+	if (none != timer.previous)
+	{
+		_entries[timer.previous].next = timer.next;
+	}
+	else
+	{
+		_heads[list] = timer.next;
+	}
+
+	if (none != timer.next)
+	{
+		_entries[timer.next].previous = timer.previous;
+	}
+
+	timer.list = none;
+	timer.previous = none;
+	timer.next = none;
+
+	if ((list < firing) && (none == _heads[list]))
+	{
+		_occupied[list / slots] &= ~(static_cast<uint64_t>(1) << (list % slots));
+	}
+}
+
+void timer_wheel::release(size_t const& index)
+{
+	entry& timer = _entries[index];
+	timer.callable = nullptr;
+	timer.active = false;
+	++timer.generation;
+
+	_free.push_back(index);
+	--_count;
+}
+
+void timer_wheel::cascade(size_t const& level)
+{
+	size_t list = level * slots + ((_now >> (level_bits * level)) & (slots - 1));
+
+	size_t index = _heads[list];
+	_heads[list] = none;
+	_occupied[level] &= ~(static_cast<uint64_t>(1) << (list % slots));
+
+	while(none != index)
+	{
+		size_t next = _entries[index].next;
+		_entries[index].list = none;
+		place(index);
+		index = next;
+	}
+}
+
+size_t timer_wheel::fire(size_t const& slot)
+{
+	size_t index = _heads[slot];
+	if (none == index)
+	{
+		return 0;
+	}
+
+	_heads[slot] = none;
+	_occupied[0] &= ~(static_cast<uint64_t>(1) << slot);
+
+	// Moved to their own list so callbacks can cancel timers that have not run yet
+	while(none != index)
+	{
+		size_t next = _entries[index].next;
+		link(index, firing);
+		index = next;
+	}
+
+	size_t fired = 0;
+	while(none != _heads[firing])
+	{
+		index = _heads[firing];
+		unlink(index);
+
+		_running = index;
+		try
+		{
+			_entries[index].callable();
+		}
+		catch(...)
+		{
+			_running = none;
+			finish(index);
+
+			// Anything that did not get to run goes out on the next call
+			while(none != _heads[firing])
+			{
+				size_t remaining = _heads[firing];
+				unlink(remaining);
+				_entries[remaining].expires = _now + 1;
+				place(remaining);
+			}
+
+			throw;
+		}
+
+		_running = none;
+		++fired;
+		finish(index);
+	}
+
+	return fired;
+}
+
+void timer_wheel::finish(size_t const& index)
+{
+	entry& timer = _entries[index];
+	if (!timer.active || (0 == timer.interval))
+	{
+		release(index);
+		return;
+	}
+
+	// Keep to the original schedule but skip any firings that were missed
+	uint64_t missed = (_target - timer.expires) / timer.interval;
+	timer.expires += timer.interval * (missed + 1);
+	place(index);
+}
+
+}
@@ -0,0 +1,192 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_TIMER_WHEEL_HPP_
+#define ZMQPP_TIMER_WHEEL_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "compatibility.hpp"
+
+namespace zmqpp
+{
+
+/*!
+ * Hierarchical timer wheel with millisecond resolution.
+ *
+ * Adding and cancelling timers is constant time no matter how many are
+ * pending, which makes it cheap to keep a heartbeat or timeout per peer.
+ * Timers live on four levels of 64 slots, the first covering the next 64ms,
+ * and move down a level as their expiry comes into range.
+ *
+ * Nothing happens in the background, call next_timeout to find out how long
+ * to wait and expire to fire the timers that are due. The reactor does both
+ * around each poll.
+ */
+class timer_wheel
+{
+public:
+	typedef std::chrono::steady_clock clock_type; /*!< Clock all timer times are taken from. */
+	typedef std::function<void ()> callback;      /*!< Function called when a timer expires. */
+
+	/*!
+	 * Reference to a pending timer, used to cancel it.
+	 *
+	 * Stays safe to use after the timer has fired or been cancelled.
+	 */
+	class timer_id
+	{
+	public:
+		/*!
+		 * Construct an id that refers to no timer.
+		 */
+		timer_id() : _index(invalid), _generation(0) { }
+
+		/*!
+		 * Check if this id was returned by add.
+		 *
+		 * \return true unless default constructed.
+		 */
+		bool valid() const { return invalid != _index; }
+
+		bool operator==(timer_id const& other) const { return (_index == other._index) && (_generation == other._generation); }
+		bool operator!=(timer_id const& other) const { return !(*this == other); }
+
+	private:
+		static const size_t invalid = static_cast<size_t>(-1);
+		size_t _index;
+		uint32_t _generation;
+
+		timer_id(size_t const& index, uint32_t const& generation) : _index(index), _generation(generation) { }
+
+		friend class timer_wheel;
+	};
+
+	/*!
+	 * Construct an empty timer wheel.
+	 *
+	 * \param start time treated as tick zero.
+	 */
+	timer_wheel(clock_type::time_point const& start = clock_type::now());
+
+	/*!
+	 * Cleanup the timer wheel, pending timers are dropped without firing.
+	 */
+	~timer_wheel();
+
+	/*!
+	 * Add a timer that fires once.
+	 *
+	 * Timers never fire early but may fire up to a millisecond late, or later
+	 * if expire is not called in time.
+	 *
+	 * \param milliseconds delay before the timer fires.
+	 * \param callable function to call when the timer fires.
+	 * \param now the current time.
+	 * \return id that can be used to cancel the timer.
+	 */
+	timer_id add(long const& milliseconds, callback const& callable, clock_type::time_point const& now = clock_type::now());
+
+	/*!
+	 * Add a timer that fires repeatedly until cancelled.
+	 *
+	 * Each firing is scheduled from the previous due time so the timer does
+	 * not drift, if the wheel falls behind missed firings are skipped rather
+	 * than run back to back.
+	 *
+	 * \param milliseconds interval between firings, at least one.
+	 * \param callable function to call each time the timer fires.
+	 * \param now the current time.
+	 * \return id that can be used to cancel the timer.
+	 */
+	timer_id add_repeating(long const& milliseconds, callback const& callable, clock_type::time_point const& now = clock_type::now());
+
+	/*!
+	 * Cancel a pending timer.
+	 *
+	 * May be called from within a timer callback, including for the timer
+	 * that is currently firing.
+	 *
+	 * \param id id returned when the timer was added.
+	 * \return true if the timer was pending, false if it already fired or was cancelled.
+	 */
+	bool cancel(timer_id const& id);
+
+	/*!
+	 * Get the number of pending timers.
+	 *
+	 * \return number of timers.
+	 */
+	size_t size() const;
+
+	/*!
+	 * Get how long until expire next needs calling.
+	 *
+	 * When the next timer is far off this may be earlier than its expiry, in
+	 * which case calling expire moves it closer without firing anything.
+	 *
+	 * \param now the current time.
+	 * \return milliseconds to wait, zero if overdue or -1 if there are no timers.
+	 */
+	long next_timeout(clock_type::time_point const& now = clock_type::now()) const;
+
+	/*!
+	 * Fire all the timers that are due.
+	 *
+	 * \param now the current time.
+	 * \return number of timers fired.
+	 */
+	size_t expire(clock_type::time_point const& now = clock_type::now());
+
+private:
+	static const size_t levels = 4;
+	static const size_t level_bits = 6;
+	static const size_t slots = 1 << level_bits;
+	static const size_t none = static_cast<size_t>(-1);
+	static const size_t firing = levels * slots;
+
+	struct entry
+	{
+		callback callable;
+		uint64_t expires;
+		uint64_t interval;
+		size_t previous;
+		size_t next;
+		size_t list;
+		uint32_t generation;
+		bool active;
+	};
+
+	clock_type::time_point _start;
+	uint64_t _now;
+	uint64_t _target;
+	size_t _running;
+	size_t _count;
+	uint64_t _occupied[levels];
+	std::vector<size_t> _heads;
+	std::deque<entry> _entries; // deque so adding from a callback never moves the running one
+	std::vector<size_t> _free;
+
+	timer_id schedule(long const& milliseconds, callback const& callable, bool const& repeat, clock_type::time_point const& now);
+	uint64_t elapsed_microseconds(clock_type::time_point const& now) const;
+	void place(size_t const& index);
+	void link(size_t const& index, size_t const& list);
+	void unlink(size_t const& index);
+	void release(size_t const& index);
+	void cascade(size_t const& level);
+	size_t fire(size_t const& slot);
+	void finish(size_t const& index);
+
+	// No copy - private and not implemented
+	timer_wheel(timer_wheel const&);
+	timer_wheel& operator=(timer_wheel const&);
+};
+
+}
+
+#endif /* ZMQPP_TIMER_WHEEL_HPP_ */
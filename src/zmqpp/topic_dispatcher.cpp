@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <cstring>
+
+#include "exception.hpp"
+#include "socket.hpp"
+#include "topic_dispatcher.hpp"
+
+namespace zmqpp
+{
+
+topic_dispatcher::topic_dispatcher(socket& socket)
+	: _socket(socket)
+	, _root()
+	, _subscriptions()
+	, _next_id(1)
+	, _topics(0)
+	, _depth(0)
+	, _deferred()
+{
+}
+
+topic_dispatcher::~topic_dispatcher()
+{
+}
+
+topic_dispatcher::subscription topic_dispatcher::subscribe(std::string const& topic, handler const& callback)
+{
+	subscription id = _next_id++;
+	_subscriptions[id] = topic;
+
+	if (_depth > 0)
+	{
+		change pending = { true, id, topic, callback };
+		_deferred.push_back(pending);
+		return id;
+	}
+
+	insert(topic, id, callback);
+	return id;
+}
+
+void topic_dispatcher::unsubscribe(subscription const& id)
+{
+	auto it = _subscriptions.find(id);
+	if (_subscriptions.end() == it)
+	{
+		return;
+	}
+
+	std::string topic = (*it).second;
+	_subscriptions.erase(it);
+
+	if (_depth > 0)
+	{
+		// Only marked here, the handler may be the one running so it is
+		// destroyed once the outermost dispatch has finished
+		node* target = find(topic);
+		if (nullptr != target)
+		{
+			for(size_t i = 0; i < target->handlers.size(); ++i)
+			{
+				if (id == target->handlers[i].id)
+				{
+					target->handlers[i].active = false;
+				}
+			}
+		}
+
+		change pending = { false, id, topic, nullptr };
+		_deferred.push_back(pending);
+		return;
+	}
+
+	remove(topic, id);
+}
+
+size_t topic_dispatcher::dispatch(message& message)
+{
+	if (0 == message.parts())
+	{
+		return 0;
+	}
+
+	char const* topic = static_cast<char const*>(message.raw_data(0));
+	size_t size = message.size(0);
+
+	size_t called = 0;
+	++_depth;
+
+	try
+	{
+		node* current = &_root;
+		size_t position = 0;
+		while(true)
+		{
+			for(size_t i = 0; i < current->handlers.size(); ++i)
+			{
+				if (current->handlers[i].active)
+				{
+					current->handlers[i].callback(message);
+					++called;
+				}
+			}
+
+			if (position == size)
+			{
+				break;
+			}
+
+			auto it = find_child(*current, topic[position]);
+			if ((current->children.end() == it) || ((*it)->edge[0] != topic[position]))
+			{
+				break;
+			}
+
+			node* child = (*it).get();
+			if ((size - position < child->edge.size())
+				|| (0 != std::memcmp(child->edge.data(), topic + position, child->edge.size())))
+			{
+				break;
+			}
+
+			position += child->edge.size();
+			current = child;
+		}
+	}
+	catch(...)
+	{
+		if (0 == --_depth)
+		{
+			apply_deferred();
+		}
+		throw;
+	}
+
+	if (0 == --_depth)
+	{
+		apply_deferred();
+	}
+
+	return called;
+}
+
+bool topic_dispatcher::receive(bool const& dont_block /* = false */)
+{
+	message message;
+	if (!_socket.receive(message, dont_block))
+	{
+		return false;
+	}
+
+	dispatch(message);
+	return true;
+}
+
+size_t topic_dispatcher::subscriptions() const
+{
+	return _subscriptions.size();
+}
+
+size_t topic_dispatcher::topics() const
+{
+	return _topics;
+}
+
+void topic_dispatcher::insert(std::string const& topic, subscription const& id, handler const& callback)
+{
+	node* current = &_root;
+	size_t position = 0;
+
+	while(position < topic.size())
+	{
+		auto it = find_child(*current, topic[position]);
+		if ((current->children.end() == it) || ((*it)->edge[0] != topic[position]))
+		{
+			std::unique_ptr<node> leaf(new node());
+			leaf->edge = topic.substr(position);
+
+			node* added = leaf.get();
+			current->children.insert(it, std::move(leaf));
+
+			current = added;
+			break;
+		}
+
+		node* child = (*it).get();
+		size_t common = 1;
+		while((common < child->edge.size()) && (position + common < topic.size())
+			&& (child->edge[common] == topic[position + common]))
+		{
+			++common;
+		}
+
+		// The topic ends or differs part way along the edge, split it there
+		if (common < child->edge.size())
+		{
+			std::unique_ptr<node> middle(new node());
+			middle->edge = child->edge.substr(0, common);
+			child->edge.erase(0, common);
+			middle->children.push_back(std::move(*it));
+
+			child = middle.get();
+			*it = std::move(middle);
+		}
+
+		position += common;
+		current = child;
+	}
+
+	if (current->handlers.empty())
+	{
+		_socket.subscribe(topic);
+		++_topics;
+	}
+
+	entry added = { id, callback, true };
+	current->handlers.push_back(added);
+}
+
+void topic_dispatcher::remove(std::string const& topic, subscription const& id)
+{
+	bool emptied = false;
+	if (remove(_root, topic, 0, id, emptied) && emptied)
+	{
+		_socket.unsubscribe(topic);
+		--_topics;
+	}
+}
+
+bool topic_dispatcher::remove(node& parent, std::string const& topic, size_t const& position, subscription const& id, bool& emptied)
+{
+	if (position == topic.size())
+	{
+		auto it = std::find_if(parent.handlers.begin(), parent.handlers.end(),
+				[&id](entry const& handler) { return id == handler.id; });
+		if (parent.handlers.end() == it)
+		{
+			return false;
+		}
+
+		parent.handlers.erase(it);
+		emptied = parent.handlers.empty();
+		return true;
+	}
+
+	auto it = find_child(parent, topic[position]);
+	if ((parent.children.end() == it) || (0 != topic.compare(position, (*it)->edge.size(), (*it)->edge)))
+	{
+		return false;
+	}
+
+	node* child = (*it).get();
+	if (!remove(*child, topic, position + child->edge.size(), id, emptied))
+	{
+		return false;
+	}
+
+	// Keep the tree compact, drop empty leaves and fold nodes that only join two edges
+	if (child->handlers.empty())
+	{
+		if (child->children.empty())
+		{
+			parent.children.erase(it);
+		}
+		else if (1 == child->children.size())
+		{
+			std::unique_ptr<node> grandchild(std::move(child->children.front()));
+			grandchild->edge.insert(0, child->edge);
+			*it = std::move(grandchild);
+		}
+	}
+
+	return true;
+}
+
+topic_dispatcher::node* topic_dispatcher::find(std::string const& topic)
+{
+	node* current = &_root;
+	size_t position = 0;
+
+	while(position < topic.size())
+	{
+		auto it = find_child(*current, topic[position]);
+		if ((current->children.end() == it) || (0 != topic.compare(position, (*it)->edge.size(), (*it)->edge)))
+		{
+			return nullptr;
+		}
+
+		position += (*it)->edge.size();
+		current = (*it).get();
+	}
+
+	return current;
+}
+
+void topic_dispatcher::apply_deferred()
+{
+	std::vector<change> pending;
+	std::swap(pending, _deferred);
+
+	for(size_t i = 0; i < pending.size(); ++i)
+	{
+		if (pending[i].add)
+		{
+			insert(pending[i].topic, pending[i].id, pending[i].callback);
+		}
+		else
+		{
+			remove(pending[i].topic, pending[i].id);
+		}
+	}
+}
+
+std::vector<std::unique_ptr<topic_dispatcher::node>>::iterator topic_dispatcher::find_child(node& parent, char const& first)
+{
+	return std::lower_bound(parent.children.begin(), parent.children.end(), first,
+			[](std::unique_ptr<node> const& child, char const& value) { return child->edge[0] < value; });
+}
+
+}
@@ -0,0 +1,160 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_TOPIC_DISPATCHER_HPP_
+#define ZMQPP_TOPIC_DISPATCHER_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Routes messages received on a subscribe socket to per topic handlers.
+ *
+ * Topics are held in a radix tree keyed on the topic bytes so finding every
+ * handler whose topic is a prefix of a message's first part costs time in
+ * proportion to the length of that part, not the number of subscriptions.
+ *
+ * The dispatcher also keeps the socket's subscriptions in step: the socket
+ * is subscribed to a topic when its first handler is added and unsubscribed
+ * when its last handler is removed.
+ *
+ * Handlers may subscribe and unsubscribe while being dispatched to, the
+ * changes are applied once the current message has been handled.
+ */
+class topic_dispatcher
+{
+public:
+	/*!
+	 * Function called with each message matching a topic.
+	 */
+	typedef std::function<void (message_t& message)> handler;
+
+	/*!
+	 * Identifies one handler for removal.
+	 */
+	typedef uint64_t subscription;
+
+	/*!
+	 * Create a dispatcher for a subscribe socket.
+	 *
+	 * \param socket the subscribe socket, which must outlive the dispatcher.
+	 */
+	topic_dispatcher(socket_t& socket);
+
+	/*!
+	 * Cleanup the dispatcher, the socket keeps its subscriptions.
+	 */
+	~topic_dispatcher();
+
+	/*!
+	 * Call a handler for every message whose first part starts with a topic.
+	 *
+	 * \param topic the topic prefix, the empty topic matches everything.
+	 * \param callback function to call.
+	 * \return the subscription to pass to unsubscribe.
+	 */
+	subscription subscribe(std::string const& topic, handler const& callback);
+
+	/*!
+	 * Remove a handler.
+	 *
+	 * Unknown or already removed subscriptions are ignored.
+	 *
+	 * \param id the subscription returned by subscribe.
+	 */
+	void unsubscribe(subscription const& id);
+
+	/*!
+	 * Call every handler whose topic prefixes the first part of a message.
+	 *
+	 * Handlers are called from the shortest topic to the longest.
+	 *
+	 * \param message the message to dispatch.
+	 * \return the number of handlers called.
+	 */
+	size_t dispatch(message_t& message);
+
+	/*!
+	 * Receive one message from the socket and dispatch it.
+	 *
+	 * \param dont_block return rather than wait if no message is waiting.
+	 * \return true if a message was received.
+	 */
+	bool receive(bool const& dont_block = false);
+
+	/*!
+	 * Get the number of handlers.
+	 *
+	 * \return handler count.
+	 */
+	size_t subscriptions() const;
+
+	/*!
+	 * Get the number of distinct topics with handlers.
+	 *
+	 * \return topic count.
+	 */
+	size_t topics() const;
+
+private:
+	struct entry
+	{
+		subscription id;
+		handler callback;
+		bool active; // cleared by an unsubscribe during dispatch, the callback may still be running
+	};
+
+	struct node
+	{
+		std::string edge;                          // bytes between the parent and this node
+		std::vector<std::unique_ptr<node>> children; // ordered by the first byte of their edge
+		std::vector<entry> handlers;
+	};
+
+	struct change
+	{
+		bool add;
+		subscription id;
+		std::string topic;
+		handler callback;
+	};
+
+	socket_t& _socket;
+	node _root;
+	std::unordered_map<subscription, std::string> _subscriptions;
+	subscription _next_id;
+	size_t _topics;
+	size_t _depth; // nested dispatch calls, changes wait until the outermost returns
+	std::vector<change> _deferred;
+
+	void insert(std::string const& topic, subscription const& id, handler const& callback);
+	void remove(std::string const& topic, subscription const& id);
+	bool remove(node& parent, std::string const& topic, size_t const& position, subscription const& id, bool& emptied);
+	node* find(std::string const& topic);
+	void apply_deferred();
+
+	static std::vector<std::unique_ptr<node>>::iterator find_child(node& parent, char const& first);
+
+	// No copy - private and not implemented
+	topic_dispatcher(topic_dispatcher const&);
+	topic_dispatcher& operator=(topic_dispatcher const&);
+};
+
+}
+
+#endif /* ZMQPP_TOPIC_DISPATCHER_HPP_ */
@@ -0,0 +1,111 @@
+#include <cstring>
+
+#include "batcher.hpp"
+#include "exception.hpp"
+#include "inet.hpp"
+#include "socket.hpp"
+#include "unbatcher.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+uint32_t read_length(char const*& position, char const* end)
+{
+	if (static_cast<size_t>(end - position) < sizeof(uint32_t))
+	{
+		throw exception("malformed batch");
+	}
+
+	uint32_t network;
+	std::memcpy(&network, position, sizeof(network));
+	position += sizeof(network);
+
+	return ntohl(network);
+}
+
+}
+
+unbatcher::unbatcher(socket& socket)
+	: _socket(socket)
+	, _unpacked()
+{
+}
+
+unbatcher::~unbatcher()
+{
+}
+
+bool unbatcher::receive(message& message, bool const& dont_block /* = false */)
+{
+	if (_unpacked.empty())
+	{
+		message_t received;
+		if (!_socket.receive(received, dont_block))
+		{
+			return false;
+		}
+
+		std::string const& marker = batcher::marker;
+		if ((2 != received.parts()) || (marker.size() != received.size(0)) ||
+				(0 != std::memcmp(marker.data(), received.raw_data(0), marker.size())))
+		{
+			message = std::move(received);
+			return true;
+		}
+
+		unpack(received);
+	}
+
+	message = std::move(_unpacked.front());
+	_unpacked.pop_front();
+
+	return true;
+}
+
+size_t unbatcher::pending() const
+{
+	return _unpacked.size();
+}
+
+void unbatcher::unpack(message& batch)
+{
+	char const* position = static_cast<char const*>(batch.raw_data(1));
+	char const* end = position + batch.size(1);
+
+	std::deque<message_t> unpacked;
+	while(position != end)
+	{
+		uint32_t parts = read_length(position, end);
+		if (0 == parts)
+		{
+			throw exception("malformed batch");
+		}
+
+		message_t message;
+		for(uint32_t i = 0; i < parts; ++i)
+		{
+			uint32_t size = read_length(position, end);
+			if (static_cast<size_t>(end - position) < size)
+			{
+				throw exception("malformed batch");
+			}
+
+			message.add(position, size);
+			position += size;
+		}
+
+		unpacked.push_back(std::move(message));
+	}
+
+	if (unpacked.empty())
+	{
+		throw exception("malformed batch");
+	}
+
+	_unpacked.swap(unpacked);
+}
+
+}
@@ -0,0 +1,81 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_UNBATCHER_HPP_
+#define ZMQPP_UNBATCHER_HPP_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "compatibility.hpp"
+#include "message.hpp"
+
+namespace zmqpp
+{
+
+class socket;
+typedef socket socket_t;
+typedef message message_t;
+
+/*!
+ * Receives messages sent through a batcher, one original message at a time.
+ *
+ * A batch is unpacked as soon as it is received and the messages in it are
+ * handed back by following calls to receive without touching the socket.
+ * As a poller only knows about the socket, a caller woken by one should keep
+ * receiving without blocking until receive returns false, or check pending,
+ * before polling again.
+ *
+ * Messages without the batch marker are returned as they are.
+ */
+class unbatcher
+{
+public:
+	/*!
+	 * Create an unbatcher for a socket.
+	 *
+	 * \param socket the socket to receive on, which must outlive the unbatcher.
+	 */
+	unbatcher(socket_t& socket);
+
+	/*!
+	 * Cleanup the unbatcher, unpacked messages not yet received are dropped.
+	 */
+	~unbatcher();
+
+	/*!
+	 * Get the next message, unpacking a batch if needed.
+	 *
+	 * Unlike a socket receive the message does not need to be empty, it is
+	 * replaced. If a batch does not decode an exception is thrown, nothing
+	 * from it is kept and the message is left untouched.
+	 *
+	 * \param message the message to fill.
+	 * \param dont_block true to return false instead of waiting for the socket.
+	 * \return true if a message was received.
+	 */
+	bool receive(message_t& message, bool const& dont_block = false);
+
+	/*!
+	 * Get the number of unpacked messages waiting to be received.
+	 *
+	 * \return waiting message count.
+	 */
+	size_t pending() const;
+
+private:
+	socket_t& _socket;
+	std::deque<message_t> _unpacked;
+
+	void unpack(message_t& batch);
+
+	// No copy - private and not implemented
+	unbatcher(unbatcher const&);
+	unbatcher& operator=(unbatcher const&);
+};
+
+}
+
+#endif /* ZMQPP_UNBATCHER_HPP_ */
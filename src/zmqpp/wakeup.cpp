@@ -0,0 +1,119 @@
+#include "compatibility.hpp"
+
+#include <cerrno>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef ZMQPP_HAVE_EVENTFD
+#include <sys/eventfd.h>
+#endif
+
+#include "exception.hpp"
+#include "wakeup.hpp"
+
+namespace zmqpp
+{
+
+namespace
+{
+
+#ifndef ZMQPP_HAVE_EVENTFD
+void configure(int const& descriptor)
+{
+	int status = fcntl(descriptor, F_GETFL);
+	if ((status < 0) || (0 != fcntl(descriptor, F_SETFL, status | O_NONBLOCK)) || (0 != fcntl(descriptor, F_SETFD, FD_CLOEXEC)))
+	{
+		throw zmq_internal_exception();
+	}
+}
+#endif
+
+}
+
+wakeup::wakeup()
+	: _read(-1)
+	, _write(-1)
+{
+#ifdef ZMQPP_HAVE_EVENTFD
+	_read = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_read < 0)
+	{
+		throw zmq_internal_exception();
+	}
+	_write = _read;
+#else
+	int descriptors[2];
+	if (0 != pipe(descriptors))
+	{
+		throw zmq_internal_exception();
+	}
+
+	_read = descriptors[0];
+	_write = descriptors[1];
+
+	try
+	{
+		configure(_read);
+		configure(_write);
+	}
+	catch(...)
+	{
+		close(_read);
+		close(_write);
+		throw;
+	}
+#endif
+}
+
+wakeup::~wakeup()
+{
+	close(_read);
+	if (_write != _read)
+	{
+		close(_write);
+	}
+}
+
+void wakeup::signal()
+{
+	// A full pipe or counter is already readable, so failing to add to it is fine
+#ifdef ZMQPP_HAVE_EVENTFD
+	uint64_t count = 1;
+	while((write(_write, &count, sizeof(count)) < 0) && (EINTR == errno)) { }
+#else
+	char byte = 0;
+	while((write(_write, &byte, 1) < 0) && (EINTR == errno)) { }
+#endif
+}
+
+bool wakeup::drain()
+{
+	bool drained = false;
+
+#ifdef ZMQPP_HAVE_EVENTFD
+	uint64_t count = 0;
+	ssize_t result = 0;
+	while(((result = read(_read, &count, sizeof(count))) > 0) || ((result < 0) && (EINTR == errno)))
+	{
+		drained = drained || (result > 0);
+	}
+#else
+	char buffer[64];
+	ssize_t result = 0;
+	while(((result = read(_read, buffer, sizeof(buffer))) > 0) || ((result < 0) && (EINTR == errno)))
+	{
+		drained = drained || (result > 0);
+	}
+#endif
+
+	return drained;
+}
+
+int wakeup::file_descriptor() const
+{
+	return _read;
+}
+
+}
@@ -0,0 +1,66 @@
+/**
+ * \file
+ */
+
+#ifndef ZMQPP_WAKEUP_HPP_
+#define ZMQPP_WAKEUP_HPP_
+
+#include "compatibility.hpp"
+
+namespace zmqpp
+{
+
+/*!
+ * Descriptor used to wake a thread blocked in poll from another thread.
+ *
+ * An eventfd where available, otherwise a pipe. Either way both ends are
+ * non-blocking and close on exec, so signalling never blocks and the
+ * descriptors do not leak into child processes.
+ *
+ * The descriptor stays readable from the first signal until it is drained,
+ * however many signals came in between.
+ */
+class wakeup
+{
+public:
+	/*!
+	 * Create the descriptors.
+	 */
+	wakeup();
+
+	/*!
+	 * Close the descriptors.
+	 */
+	~wakeup();
+
+	/*!
+	 * Make the descriptor readable, safe to call from any thread.
+	 */
+	void signal();
+
+	/*!
+	 * Clear every signal so far.
+	 *
+	 * \return true if there was anything to clear.
+	 */
+	bool drain();
+
+	/*!
+	 * Get the descriptor to poll for input.
+	 *
+	 * \return file descriptor suitable for poller::add.
+	 */
+	int file_descriptor() const;
+
+private:
+	int _read;
+	int _write;
+
+	// No copy - private and not implemented
+	wakeup(wakeup const&);
+	wakeup& operator=(wakeup const&);
+};
+
+}
+
+#endif /* ZMQPP_WAKEUP_HPP_ */
@@ -51,11 +51,31 @@
 #include <zmq.h>
 
 #include "compatibility.hpp"
+#include "batcher.hpp"
+#include "broker.hpp"
+#include "channel.hpp"
 #include "context.hpp"
+#include "epoll_poller.hpp"
 #include "exception.hpp"
+#include "hash_ring.hpp"
+#include "hash_router.hpp"
+#include "last_value_cache.hpp"
 #include "message.hpp"
+#include "pipeline.hpp"
 #include "poller.hpp"
+#include "proxy.hpp"
+#include "reactor.hpp"
+#include "reactor_pool.hpp"
+#include "rpc_client.hpp"
+#include "send_queue.hpp"
+#include "sequenced_publisher.hpp"
+#include "sequenced_subscriber.hpp"
+#include "shm_channel.hpp"
 #include "socket.hpp"
+#include "subscription_manager.hpp"
+#include "timer_wheel.hpp"
+#include "topic_dispatcher.hpp"
+#include "unbatcher.hpp"
 
 /*!
  * \brief C++ wrapper around zmq
@@ -100,11 +120,34 @@ void version(uint8_t& major, uint8_t& minor, uint8_t& revision);
  */
 void zmq_version(uint8_t& major, uint8_t& minor, uint8_t& patch);
 
+typedef batcher     batcher_t;   /*!< \brief batcher type */
+typedef broker      broker_t;    /*!< \brief broker type */
+typedef channel     channel_t;   /*!< \brief channel type */
 typedef context     context_t;   /*!< \brief context type */
 typedef std::string endpoint_t;  /*!< \brief endpoint type */
+typedef hash_ring   hash_ring_t; /*!< \brief hash ring type */
+typedef hash_router hash_router_t; /*!< \brief hash router type */
+typedef last_value_cache last_value_cache_t; /*!< \brief last value cache type */
 typedef message     message_t;   /*!< \brief message type */
+typedef pipeline    pipeline_t;  /*!< \brief pipeline type */
 typedef poller      poller_t;    /*!< \brief poller type */
+typedef proxy       proxy_t;     /*!< \brief proxy type */
+typedef reactor     reactor_t;   /*!< \brief reactor type */
+typedef reactor_pool reactor_pool_t; /*!< \brief reactor pool type */
+typedef rpc_client  rpc_client_t; /*!< \brief rpc client type */
+typedef send_queue  send_queue_t; /*!< \brief send queue type */
+typedef sequenced_publisher sequenced_publisher_t; /*!< \brief sequenced publisher type */
+typedef sequenced_subscriber sequenced_subscriber_t; /*!< \brief sequenced subscriber type */
+typedef shm_channel shm_channel_t; /*!< \brief shared memory channel type */
 typedef socket      socket_t;    /*!< \brief socket type */
+typedef subscription_manager subscription_manager_t; /*!< \brief subscription manager type */
+typedef timer_wheel timer_wheel_t; /*!< \brief timer wheel type */
+typedef topic_dispatcher topic_dispatcher_t; /*!< \brief topic dispatcher type */
+typedef unbatcher   unbatcher_t; /*!< \brief unbatcher type */
+
+#ifdef ZMQPP_HAVE_EPOLL
+typedef epoll_poller epoll_poller_t; /*!< \brief epoll poller type */
+#endif
 
 }
 